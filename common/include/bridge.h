@@ -0,0 +1,218 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   bridge.h
+ *  \brief  ARM-BBR shared memory bridge to an external planner process function prototypes
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#pragma once
+
+#include "ev3dev-arm-ctypes.h"
+#include <stdint.h>
+
+/** @addtogroup common */
+/*@{*/
+
+/** @defgroup bridge Planner Bridge
+ *
+ * The Planner Bridge connects the robot program to an external planner process (e.g., path planning or vision
+ * post-processing) through a POSIX shared memory object, so that heavy computation runs outside the event loop.
+ *
+ * Robot side (brg_xxx): the robot stages its state each event loop tick using brg_set_sensor(), brg_set_tacho() and
+ * brg_set_state(), then brg_publish() copies it into the shared state snapshot under a sequence lock, and increments
+ * the robot heartbeat. Commands from the planner (target velocities, behavior overrides) are taken from a lock-free
+ * single producer, single consumer mailbox using brg_receive(). None of the robot routines wait for the planner.
+ *
+ * Planner side (brg_client_xxx): the planner reads consistent state snapshots using brg_client_read_state(),
+ * sends commands using brg_client_send() (which fails instead of waiting if the mailbox is full), and calls
+ * brg_client_heartbeat() regularly.
+ *
+ * Each side watches the other's heartbeat: brg_peer_alive() (robot) and brg_client_robot_alive() (planner) return FALSE
+ * if the heartbeat has not changed within the stale time, e.g., so that the robot drops planner overrides
+ * and falls back to its own behaviors. source/examples/planner is an example planner.
+ *
+ *     e.g.: brg_open(NULL, 500);                        (robot, planner stale after 500 ms)
+ *           ...
+ *           brg_set_sensor(0, touch);                   (each event loop tick)
+ *           brg_set_tacho(0, position, speed);
+ *           brg_publish(loop_systick);
+ *           while (brg_receive(&cmd))
+ *               handle(&cmd);
+ */
+/*@{*/
+
+#define BRG_DEFAULT_NAME     "/bbr-bridge"				///< Default shared memory object name
+#define BRG_MAX_SENSORS      8							///< Sensor values per snapshot
+#define BRG_MAX_TACHOS       4							///< Tacho motors per snapshot
+#define BRG_CMD_ARGS         4							///< Arguments per command
+#define BRG_CMD_SLOTS        16							///< Command mailbox size (power of 2)
+#define BRG_MAGIC            0x47525242					///< "BBRG" (little-endian)
+#define BRG_VERSION          1
+
+/* Command Types */
+#define BRG_CMD_NONE         0
+#define BRG_CMD_VELOCITY     1							///< arg[0]: left, arg[1]: right target speed (tacho counts/s)
+#define BRG_CMD_BEHAVIOR     2							///< arg[0]: behavior, arg[1]: TRUE to force it, FALSE to release it
+#define BRG_CMD_STOP         3							///< Stop the robot program
+#define BRG_CMD_USER         16							///< First program specific command type
+
+/** Robot state snapshot */
+typedef struct {
+	uint32_t systick;					///< Systick of the snapshot (robot clock)
+	uint32_t robot_state;				///< Program specific state
+	uint32_t num_sensors;				///< Valid sensor values
+	uint32_t num_tachos;				///< Valid tacho positions and speeds
+	int32_t sensor[BRG_MAX_SENSORS];	///< Sensor values
+	int32_t tacho_pos[BRG_MAX_TACHOS];	///< Tacho positions (counts)
+	int32_t tacho_speed[BRG_MAX_TACHOS];	///< Tacho speeds (counts/s)
+} BRG_STATE;
+
+/** Command */
+typedef struct {
+	uint32_t type;						///< BRG_CMD_XXX
+	uint32_t seqno;						///< Command number (set by brg_client_send())
+	int32_t arg[BRG_CMD_ARGS];			///< Arguments
+} BRG_CMD;
+
+/** Shared memory region */
+typedef struct {
+	uint32_t magic;						///< BRG_MAGIC, written last by brg_open()
+	uint32_t version;					///< BRG_VERSION
+	uint32_t size;						///< sizeof(BRG_REGION)
+	uint32_t robot_heartbeat;			///< Incremented by brg_publish()
+	uint32_t planner_heartbeat;			///< Incremented by brg_client_heartbeat()
+	uint32_t state_seq;					///< Sequence lock (odd while the snapshot is being written)
+	BRG_STATE state;					///< State snapshot (robot to planner)
+	uint32_t cmd_head;					///< Commands sent (written by the planner)
+	uint32_t cmd_tail;					///< Commands received (written by the robot)
+	BRG_CMD cmd[BRG_CMD_SLOTS];			///< Command mailbox (planner to robot)
+} BRG_REGION;
+
+/** Create the bridge (robot side)
+ *
+ * Any existing bridge with the same name is reinitialized.
+ *
+ * @param name Shared memory object name (NULL for BRG_DEFAULT_NAME).
+ * @param stale_ms Planner heartbeat timeout (ms).
+ * @return Flag - the bridge was created.
+ *
+ */
+bool brg_open(const char *name, U32 stale_ms);
+
+/** Remove the bridge (robot side)
+ *
+ * @param None
+ * @return None
+ *
+ */
+void brg_close(void);
+
+/** Stage a sensor value for the next snapshot
+ *
+ * @param index Sensor index [0..BRG_MAX_SENSORS-1].
+ * @param value Sensor value.
+ * @return None
+ *
+ */
+void brg_set_sensor(U32 index, S32 value);
+
+/** Stage a tacho motor position and speed for the next snapshot
+ *
+ * @param index Tacho index [0..BRG_MAX_TACHOS-1].
+ * @param position Position (counts).
+ * @param speed Speed (counts/s).
+ * @return None
+ *
+ */
+void brg_set_tacho(U32 index, S32 position, S32 speed);
+
+/** Stage the robot state for the next snapshot
+ *
+ * @param state Program specific state.
+ * @return None
+ *
+ */
+void brg_set_state(U32 state);
+
+/** Publish the staged state and increment the robot heartbeat
+ *
+ * @param systick Systick of the snapshot.
+ * @return None
+ *
+ */
+void brg_publish(U32 systick);
+
+/** Take the next command from the mailbox
+ *
+ * @param[out] cmd Buffer for the command.
+ * @return Flag - a command was received.
+ *
+ */
+bool brg_receive(BRG_CMD *cmd);
+
+/** Check if the planner heartbeat has changed within the stale time
+ *
+ * @param None
+ * @return Flag - the planner is alive.
+ *
+ */
+bool brg_peer_alive(void);
+
+/** Connect to the bridge (planner side)
+ *
+ * @param name Shared memory object name (NULL for BRG_DEFAULT_NAME).
+ * @return Flag - connected (FALSE if the robot program has not created the bridge).
+ *
+ */
+bool brg_client_open(const char *name);
+
+/** Disconnect from the bridge (planner side)
+ *
+ * @param None
+ * @return None
+ *
+ */
+void brg_client_close(void);
+
+/** Read the latest state snapshot
+ *
+ * Retries a few times if the robot is publishing, but never waits for the robot.
+ *
+ * @param[out] state Buffer for the snapshot.
+ * @return Flag - the snapshot is consistent.
+ *
+ */
+bool brg_client_read_state(BRG_STATE *state);
+
+/** Send a command
+ *
+ * @param type Command type (BRG_CMD_XXX).
+ * @param args BRG_CMD_ARGS arguments, or NULL for none.
+ * @return Flag - the command was queued (FALSE if the mailbox is full).
+ *
+ */
+bool brg_client_send(U32 type, const S32 *args);
+
+/** Increment the planner heartbeat
+ *
+ * @param None
+ * @return None
+ *
+ */
+void brg_client_heartbeat(void);
+
+/** Check if the robot heartbeat has changed within the stale time
+ *
+ * @param stale_ms Robot heartbeat timeout (ms).
+ * @return Flag - the robot is alive.
+ *
+ */
+bool brg_client_robot_alive(U32 stale_ms);
+
+/*@}*/
+/*@}*/
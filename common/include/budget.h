@@ -0,0 +1,150 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   budget.h
+ *  \brief  ARM-BBR per-tick budget dispatcher function prototypes
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#pragma once
+
+#include "ev3dev-arm-ctypes.h"
+
+/** @addtogroup common */
+/*@{*/
+
+/** @defgroup budget Per-tick Budget Dispatcher
+ *
+ * The Budget Dispatcher keeps the event loop within its tick when some work takes longer than usual.
+ *
+ * Each task (a coroutine call, behavior or routine called from the event loop) is registered with a class:
+ * - BDGT_CRITICAL tasks always run (e.g., actuator controllers).
+ * - BDGT_NORMAL tasks run if the remaining time in the tick covers their cost plus the cost of the
+ *   critical tasks which have not run yet in this tick.
+ * - BDGT_BEST_EFFORT tasks run if the remaining time also covers the normal tasks which have not run yet
+ *   (e.g., display updates, telemetry).
+ * A task which does not fit is deferred to the next tick (a miss). A task with a max_defer limit is run anyway
+ * once it has been deferred for max_defer consecutive ticks, so that it is never starved.
+ *
+ * The cost of each task is learned from its measured execution times: a running average plus twice the
+ * average deviation, so that tasks with variable execution times (e.g., sysfs reads) are estimated conservatively.
+ *
+ *     e.g.: bdgt_begin_tick(loop_systick, EVENTLOOP_TICKCOUNT);
+ *           if (bdgt_admit(task)) {
+ *               ...
+ *               bdgt_done(task);
+ *           }
+ *           ...
+ *           bdgt_end_tick();
+ *
+ * The Budget Dispatcher is not thread-safe; call it from the event loop.
+ */
+/*@{*/
+
+#define BDGT_CRITICAL     0				///< Always runs
+#define BDGT_NORMAL       1				///< Runs if it fits, after reserving time for critical tasks
+#define BDGT_BEST_EFFORT  2				///< Runs if it fits, after reserving time for critical and normal tasks
+#define BDGT_NUM_CLASSES  3
+
+#define BDGT_MAX_TASKS   16				///< Maximum number of tasks
+
+/** Per-class statistics */
+typedef struct {
+	U32 runs;							///< Tasks run
+	U32 deferred;						///< Tasks deferred to the next tick (misses)
+	U32 forced;							///< Tasks run after max_defer consecutive deferrals
+	U32 late;							///< Tasks started after the end of the tick
+	U32 cost;							///< Sum of the current cost estimates (ticks)
+} BDGT_STATS;
+
+/** Register a task
+ *
+ * @param task_class Task class (BDGT_XXX).
+ * @param initial_cost Initial cost estimate (ticks), used until the task has been measured.
+ * @param max_defer Maximum consecutive deferrals before the task is run anyway (0: no limit).
+ * @return Task number, or -1 if the task could not be registered.
+ *
+ */
+S32 bdgt_register(U32 task_class, U32 initial_cost, U32 max_defer);
+
+/** Start a tick
+ *
+ * @param tick_start Systick at the start of the tick.
+ * @param budget Tick duration (ticks).
+ * @return None
+ *
+ */
+void bdgt_begin_tick(U32 tick_start, U32 budget);
+
+/** Check if a task should run now
+ *
+ * @param task Task number.
+ * @return Flag - run the task now (and call bdgt_done() after it), or defer it to the next tick.
+ *
+ */
+bool bdgt_admit(U32 task);
+
+/** Record the completion of an admitted task
+ *
+ * @param task Task number.
+ * @return None
+ *
+ */
+void bdgt_done(U32 task);
+
+/** End a tick
+ *
+ * @param None
+ * @return Flag - the tick overran its budget.
+ *
+ */
+bool bdgt_end_tick(void);
+
+/** Get the time remaining in the current tick
+ *
+ * @param None
+ * @return Remaining ticks (negative if the tick has overrun).
+ *
+ */
+S32 bdgt_remaining(void);
+
+/** Get the current cost estimate of a task
+ *
+ * @param task Task number.
+ * @return Cost estimate (ticks).
+ *
+ */
+U32 bdgt_get_cost(U32 task);
+
+/** Get the statistics for a task class
+ *
+ * @param task_class Task class (BDGT_XXX).
+ * @param[out] stats Buffer for the statistics.
+ * @return Flag - the statistics were returned.
+ *
+ */
+bool bdgt_get_stats(U32 task_class, BDGT_STATS *stats);
+
+/** Get the tick statistics
+ *
+ * @param[out] ticks Buffer for the number of ticks (may be NULL).
+ * @param[out] overruns Buffer for the number of ticks which overran their budget (may be NULL).
+ * @return None
+ *
+ */
+void bdgt_get_tick_stats(U32 *ticks, U32 *overruns);
+
+/** Write the per-class statistics to stderr
+ *
+ * @param None
+ * @return None
+ *
+ */
+void bdgt_report(void);
+
+/*@}*/
+/*@}*/
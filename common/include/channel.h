@@ -0,0 +1,137 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   channel.h
+ *  \brief  ARM-BBR bounded coroutine channel function prototypes
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#pragma once
+
+#include "ev3dev-arm-ctypes.h"
+
+/** @addtogroup common */
+/*@{*/
+
+/** @defgroup channel Coroutine Channels
+ *
+ * A Channel is a fixed-capacity ring of fixed-size slots for passing data between coroutines,
+ * e.g., a sensor coroutine streaming batches of readings to a behavior.
+ *
+ * Slots are used in place: the sender reserves the next free slot, fills it and commits it;
+ * the receiver gets the oldest committed slot, uses it and releases it. The capacity is a power of two,
+ * so the free-running head and tail counters are wrapped with a mask.
+ *
+ *     e.g.: if ((slot = chan_reserve(ch)) != NULL) {       (sender)
+ *               ...fill slot...
+ *               chan_commit(ch);
+ *           }
+ *           if ((slot = chan_peek(ch)) != NULL) {          (receiver)
+ *               ...use slot...
+ *               chan_release(ch);
+ *           }
+ *
+ * Assembly coroutines use CHAN_INIT, CHAN_SEND, CHAN_COMMIT, CHAN_RECV and CHAN_RELEASE (arm-coroutine.h),
+ * which wait (yield) while the channel is full or empty. CHAN_INIT defines a CHAN structure, so the
+ * routines below can be used on it as well (e.g., from C).
+ *
+ * Channels are not thread-safe; the sender and the receiver must run on the same thread
+ * (use the pipeline triple buffers between threads).
+ */
+/*@{*/
+
+/** Channel (the layout must match the CHAN_XXX offsets in arm-coroutine.h) */
+typedef struct {
+	U8 *slots;							///< capacity slots of slot_size bytes
+	U32 slot_size;						///< Slot size (bytes)
+	U32 mask;							///< capacity - 1
+	U32 head;							///< Slots committed by the sender (free-running)
+	U32 tail;							///< Slots released by the receiver (free-running)
+	U32 allocated;						///< Flag - slots were allocated by chan_init()
+} CHAN;
+
+/** Initialize a channel
+ *
+ * @param ch Channel.
+ * @param slots Slot array (capacity * slot_size bytes), or NULL to allocate it.
+ * @param slot_size Slot size (bytes).
+ * @param capacity Number of slots (power of two).
+ * @return Flag - the channel was initialized.
+ *
+ */
+bool chan_init(CHAN *ch, void *slots, U32 slot_size, U32 capacity);
+
+/** Free the slot array if it was allocated by chan_init()
+ *
+ * @param ch Channel.
+ * @return None
+ *
+ */
+void chan_free(CHAN *ch);
+
+/** Reserve the next free slot (sender)
+ *
+ * @param ch Channel.
+ * @return Slot address, or NULL if the channel is full.
+ *
+ * The slot is not visible to the receiver until chan_commit().
+ */
+void *chan_reserve(CHAN *ch);
+
+/** Commit the reserved slot (sender)
+ *
+ * @param ch Channel.
+ * @return None
+ *
+ */
+void chan_commit(CHAN *ch);
+
+/** Get the oldest committed slot (receiver)
+ *
+ * @param ch Channel.
+ * @return Slot address, or NULL if the channel is empty.
+ *
+ * The slot is not reused by the sender until chan_release().
+ */
+void *chan_peek(CHAN *ch);
+
+/** Release the oldest committed slot (receiver)
+ *
+ * @param ch Channel.
+ * @return None
+ *
+ */
+void chan_release(CHAN *ch);
+
+/** Get the number of committed slots
+ *
+ * @param ch Channel.
+ * @return Number of slots waiting for the receiver.
+ *
+ */
+U32 chan_count(CHAN *ch);
+
+/** Copy data into the next free slot and commit it
+ *
+ * @param ch Channel.
+ * @param data Data (slot_size bytes).
+ * @return Flag - the data was sent (FALSE if the channel is full).
+ *
+ */
+bool chan_send(CHAN *ch, const void *data);
+
+/** Copy the oldest committed slot and release it
+ *
+ * @param ch Channel.
+ * @param[out] data Buffer for the data (slot_size bytes).
+ * @return Flag - data was received (FALSE if the channel is empty).
+ *
+ */
+bool chan_recv(CHAN *ch, void *data);
+
+/*@}*/
+/*@}*/
@@ -0,0 +1,151 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   colorlut.h
+ *  \brief  ARM-BBR lookup table color classifier function prototypes
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#pragma once
+
+#include "ev3dev-arm-ctypes.h"
+
+/** @addtogroup common */
+/*@{*/
+
+/** @defgroup colorlut Color Classifier
+ *
+ * The Color Classifier maps raw RGB readings (EV3 Color Sensor RGB-RAW mode) to color classes
+ * using a precomputed CLUT_LEVELS^3 lookup table, so that classifying a reading costs three multiplies
+ * and one table lookup instead of a distance calculation against each reference color.
+ *
+ * Calibration: samples of each reference color are added using clut_cal_add(), then clut_bake() computes the
+ * mean and spread of each class and fills the table. Each channel is quantized over the range seen during calibration
+ * (plus headroom), and each cell holds the class nearest to the cell center and a confidence (0-15) given by the margin
+ * between the nearest and the second nearest class. Cells far from every class (relative to the class spread) are CLUT_UNKNOWN.
+ *
+ * The table can also be baked on a PC from labelled traces using scripts/colorcal.py, saved to a file,
+ * and loaded using clut_load(). The tool also reports the classification accuracy against labelled test traces.
+ *
+ *     e.g.: clut_cal_init(&cal);
+ *           clut_cal_add(&cal, RED, r, g, b);            (for each calibration sample)
+ *           ...
+ *           clut_bake(&cal, &lut);
+ *           ...
+ *           color = clut_classify(&lut, r, g, b, 8);     (CLUT_UNKNOWN if the confidence is below 8)
+ */
+/*@{*/
+
+#define CLUT_BITS            4								///< Quantization bits per channel
+#define CLUT_LEVELS          (1 << CLUT_BITS)				///< Quantization levels per channel
+#define CLUT_CELLS           (CLUT_LEVELS * CLUT_LEVELS * CLUT_LEVELS)	///< Table size (bytes)
+#define CLUT_MAX_CLASSES     15								///< Classes 0 to CLUT_MAX_CLASSES - 1
+#define CLUT_UNKNOWN         0x0F							///< Class of readings far from every class
+#define CLUT_MAX_CONF        15								///< Maximum confidence
+#define CLUT_REJECT_K        3								///< Unknown beyond CLUT_REJECT_K class spreads...
+#define CLUT_REJECT_MIN      20								///< ...plus CLUT_REJECT_MIN raw counts
+#define CLUT_FILE_MAGIC      "CLUT"
+#define CLUT_FILE_VERSION    1
+
+#define CLUT_CLASS(cell)     ((cell) & 0x0F)				///< Class of a table cell
+#define CLUT_CONF(cell)      ((cell) >> 4)					///< Confidence of a table cell
+
+/** Lookup table */
+typedef struct {
+	U32 scale[3];						///< Quantization scale (Q16) for R, G, B
+	U32 range[3];						///< Quantized raw range for R, G, B
+	U32 num_classes;					///< Number of classes
+	U8 cells[CLUT_CELLS];				///< Class (bits 0-3) and confidence (bits 4-7), R major order
+} CLUT;
+
+/** Calibration samples */
+typedef struct {
+	U32 count[CLUT_MAX_CLASSES];
+	unsigned long long sum[CLUT_MAX_CLASSES][3];
+	unsigned long long sumsq[CLUT_MAX_CLASSES];
+	U32 max[3];							///< Maximum raw value of each channel
+	U32 num_classes;					///< Highest class + 1
+} CLUT_CAL;
+
+/** Clear the calibration samples
+ *
+ * @param cal Calibration samples.
+ * @return None
+ *
+ */
+void clut_cal_init(CLUT_CAL *cal);
+
+/** Add a calibration sample
+ *
+ * @param cal Calibration samples.
+ * @param color Class [0..CLUT_MAX_CLASSES-1].
+ * @param r, g, b Raw RGB reading (negative values are treated as 0).
+ * @return Flag - the sample was added.
+ *
+ */
+bool clut_cal_add(CLUT_CAL *cal, U32 color, S32 r, S32 g, S32 b);
+
+/** Bake the lookup table from the calibration samples
+ *
+ * @param cal Calibration samples (each class from 0 to the highest class needs at least one sample).
+ * @param[out] lut Lookup table.
+ * @return Flag - the table was baked.
+ *
+ */
+bool clut_bake(const CLUT_CAL *cal, CLUT *lut);
+
+/** Get the table cell of a reading
+ *
+ * @param lut Lookup table.
+ * @param r, g, b Raw RGB reading.
+ * @return Table cell (use CLUT_CLASS() and CLUT_CONF()).
+ *
+ */
+U8 clut_lookup(const CLUT *lut, S32 r, S32 g, S32 b);
+
+/** Classify a reading
+ *
+ * @param lut Lookup table.
+ * @param r, g, b Raw RGB reading.
+ * @param min_conf Minimum confidence [0..CLUT_MAX_CONF].
+ * @return Class, or CLUT_UNKNOWN.
+ *
+ */
+U32 clut_classify(const CLUT *lut, S32 r, S32 g, S32 b, U32 min_conf);
+
+/** Classify a batch of readings
+ *
+ * @param lut Lookup table.
+ * @param rgb Readings (count R, G, B triplets).
+ * @param count Number of readings.
+ * @param[out] colors Buffer for count classes (CLUT_UNKNOWN if the confidence is below min_conf).
+ * @param min_conf Minimum confidence [0..CLUT_MAX_CONF].
+ * @return Number of readings classified (not CLUT_UNKNOWN).
+ *
+ */
+U32 clut_classify_batch(const CLUT *lut, const S32 *rgb, U32 count, U8 *colors, U32 min_conf);
+
+/** Save a lookup table (in the scripts/colorcal.py file format)
+ *
+ * @param lut Lookup table.
+ * @param path File path.
+ * @return Flag - the table was saved.
+ *
+ */
+bool clut_save(const CLUT *lut, const char *path);
+
+/** Load a lookup table
+ *
+ * @param[out] lut Lookup table.
+ * @param path File path (saved using clut_save() or scripts/colorcal.py).
+ * @return Flag - the table was loaded.
+ *
+ */
+bool clut_load(CLUT *lut, const char *path);
+
+/*@}*/
+/*@}*/
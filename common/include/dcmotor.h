@@ -0,0 +1,202 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   dcmotor.h
+ *  \brief  ARM-BBR software-regulated DC motor and servo driver function prototypes
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#pragma once
+
+#include "ev3dev-arm-ctypes.h"
+
+/** @addtogroup common */
+/*@{*/
+
+/** @defgroup dcmotor DC Motor and Servo Driver
+ *
+ * DC motors (LEGO RCX and Power Functions motors, dc-motor class) and RC servos (servo-motor class) have no
+ * speed regulation or ramping in the kernel driver. The DC Motor Driver streams their output
+ * (duty_cycle_sp for DC motors in run-direct mode, position_sp for servos) every period, computed in software:
+ *
+ * - Open loop (dcm_set_duty()): the output is ramped towards the target duty cycle at the ramp up/down rates.
+ * - Closed loop (dcm_set_speed()): the speed target is ramped the same way, and the output is the feed-forward duty
+ *   cycle (target speed * 100 / max_speed) plus a PI correction from the speed measured by an external encoder
+ *   or rotation sensor (dcm_set_feedback()). Cheap motors then move repeatably as the battery and load change.
+ *
+ * The output attribute is kept open (see fastattr.h), and only written when the output changes.
+ *
+ * The driver can be run from the event loop using dcm_poll(), or on a background thread using dcm_start().
+ *
+ *     e.g.: dvcs_config_dc_type_for_port(..., &sn);
+ *           id = dcm_add_dc(sn, 0);
+ *           dcm_set_ramp(id, 500, 200);                                   (0 to 100% in 500 ms, 100% to 0 in 200 ms)
+ *           dcm_set_feedback(id, angle_sn, 0, 900, DCM_FB_SENSOR);         (HT_NXT_ANGLE, 900 counts/s at 100%)
+ *           dcm_start();
+ *           ...
+ *           dcm_set_speed(id, 450);
+ *           ...
+ *           dcm_halt(id);
+ *           dcm_stop();
+ *           dcm_release();
+ */
+/*@{*/
+
+#define DCM_MAX_MOTORS          4			///< Maximum number of driven motors
+#define DCM_DEFAULT_PERIOD_US   10000		///< Default output streaming period
+#define DCM_MIN_PERIOD_US       2000		///< Shortest output streaming period
+#define DCM_DUTY_MAX            100			///< Output range [-DCM_DUTY_MAX..DCM_DUTY_MAX]
+#define DCM_SPEED_SHIFT         2			///< Speed measurement filter (1 / 2^DCM_SPEED_SHIFT per sample)
+#define DCM_DEFAULT_KP          1311		///< Default proportional gain (Q16 duty % per count/s, 0.02)
+#define DCM_DEFAULT_KI          32768		///< Default integral gain (Q16 duty % per count of lag, 0.5)
+
+/* Motor flags */
+#define DCM_INVERT           0x01			///< Reverse the output polarity
+
+/* Feedback flags */
+#define DCM_FB_SENSOR        0x00			///< The feedback is a sensor value (e.g., HT_NXT_ANGLE accumulated angle)
+#define DCM_FB_TACHO         0x01			///< The feedback is the position of a tacho motor used as an encoder
+#define DCM_FB_INVERT        0x02			///< Reverse the feedback direction
+
+/** Add a DC motor (the run-direct command is written with the first output)
+ *
+ * @param sn DC motor sequence number.
+ * @param flags Motor flags (DCM_XXX).
+ * @return Driver ID, or -1 if the motor could not be added.
+ *
+ */
+S32 dcm_add_dc(U8 sn, U32 flags);
+
+/** Add a servo motor (the run command is written with the first output)
+ *
+ * The output is position_sp, i.e. the position of a standard servo or the speed of a continuous rotation servo.
+ *
+ * @param sn Servo motor sequence number.
+ * @param flags Motor flags (DCM_XXX).
+ * @return Driver ID, or -1 if the motor could not be added.
+ *
+ */
+S32 dcm_add_servo(U8 sn, U32 flags);
+
+/** Set the output streaming period (call before dcm_start())
+ *
+ * @param period_us Period [DCM_MIN_PERIOD_US..1000000].
+ * @return Flag - the period was set.
+ *
+ */
+bool dcm_set_period(U32 period_us);
+
+/** Set the software ramp rates
+ *
+ * @param id Driver ID.
+ * @param ramp_up_ms Time from 0 to full output (0: no ramp).
+ * @param ramp_down_ms Time from full output to 0 (0: no ramp).
+ * @return None
+ *
+ */
+void dcm_set_ramp(S32 id, U32 ramp_up_ms, U32 ramp_down_ms);
+
+/** Use an external encoder or rotation sensor for closed-loop speed regulation
+ *
+ * @param id Driver ID.
+ * @param sn Sensor (DCM_FB_SENSOR) or tacho motor (DCM_FB_TACHO) sequence number.
+ * @param value_inx Sensor value index (DCM_FB_SENSOR).
+ * @param max_speed Speed at full output (counts/s), for the feed-forward and the speed ramp.
+ * @param flags Feedback flags (DCM_FB_XXX).
+ * @return Flag - the feedback was set up.
+ *
+ */
+bool dcm_set_feedback(S32 id, U8 sn, U8 value_inx, U32 max_speed, U32 flags);
+
+/** Set the speed regulation gains
+ *
+ * @param id Driver ID.
+ * @param kp Proportional gain (Q16 duty % per count/s of speed error).
+ * @param ki Integral gain (Q16 duty % per count of position lag).
+ * @return None
+ *
+ */
+void dcm_set_gains(S32 id, U32 kp, U32 ki);
+
+/** Set the target duty cycle (open loop)
+ *
+ * @param id Driver ID.
+ * @param duty Duty cycle [-DCM_DUTY_MAX..DCM_DUTY_MAX].
+ * @return None
+ *
+ */
+void dcm_set_duty(S32 id, S32 duty);
+
+/** Set the target speed (closed loop, needs dcm_set_feedback())
+ *
+ * @param id Driver ID.
+ * @param speed Speed (counts/s).
+ * @return Flag - the target was set.
+ *
+ */
+bool dcm_set_speed(S32 id, S32 speed);
+
+/** Stop a motor immediately (no ramp)
+ *
+ * @param id Driver ID.
+ * @return None
+ *
+ */
+void dcm_halt(S32 id);
+
+/** Get the current output of a motor
+ *
+ * @param id Driver ID.
+ * @return Output [-DCM_DUTY_MAX..DCM_DUTY_MAX].
+ *
+ */
+S32 dcm_get_duty(S32 id);
+
+/** Get the measured speed and position of a motor
+ *
+ * @param id Driver ID.
+ * @param[out] speed Buffer for the speed (counts/s), or NULL.
+ * @param[out] position Buffer for the feedback position (counts), or NULL.
+ * @return Flag - the motor has feedback.
+ *
+ */
+bool dcm_get_speed(S32 id, S32 *speed, S32 *position);
+
+/** Update the motors which are due
+ *
+ * @param None
+ * @return Systick when the next update is due.
+ *
+ */
+U32 dcm_poll(void);
+
+/** Run the driver on a background thread
+ *
+ * @param None
+ * @return Flag - the thread was started.
+ *
+ */
+bool dcm_start(void);
+
+/** Stop the background thread (the motors keep their last output)
+ *
+ * @param None
+ * @return None
+ *
+ */
+void dcm_stop(void);
+
+/** Stop all motors and remove them from the driver (call after dcm_stop())
+ *
+ * @param None
+ * @return None
+ *
+ */
+void dcm_release(void);
+
+/*@}*/
+/*@}*/
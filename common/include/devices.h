@@ -39,6 +39,29 @@
 /*@{*/
 
 
+/** Discover sensors and tacho motors in parallel
+ *
+ * Calls ev3_sensor_init() and ev3_tacho_init() repeatedly (on separate threads) until
+ * the given number of devices of each class is present. The retry interval is short,
+ * so that devices which are still being enumerated by the kernel are picked up quickly.
+ *
+ * @param num_sensors Minimum number of sensors.
+ * @param num_tachos Minimum number of tacho motors.
+ * @param timeout_ms Give up after this duration (0: wait indefinitely).
+ * @return Flag - both device counts are satisfied.
+ *
+ */
+bool dvcs_discover(U32 num_sensors, U32 num_tachos, U32 timeout_ms);
+
+/** Get the mux channel port mode for a sensor connected to a sensor multiplexer
+ *
+ * @param mux_type_inx Sensor multiplexer type (MS_EV3_SMUX or HT_NXT_SMUX). [From ev3_sensor.h]
+ * @param type_inx Sensor type connected to the mux channel. [From ev3_sensor.h]
+ * @return Mux channel port mode (e.g., MS_EV3_SMUX_UART), PORT_MODE__NONE_ if not a supported mux. [From ev3_port.h]
+ *
+ */
+INX_T dvcs_mux_channel_mode_inx(INX_T mux_type_inx, INX_T type_inx);
+
 /** Search for the sequence number for a specific sensor type by plug-in attributes
  *
  * @param type_inx Sensor type. [From ev3_sensor.h]
@@ -63,6 +86,32 @@ bool dvcs_search_sensor_type_for_port(INX_T type_inx, U8 port, U8 extport, U8 *s
  */
 bool dvcs_search_tacho_type_for_port(INX_T type_inx, U8 port, U8 extport, U8 *sn );
 
+/** Search for the sequence number for a specific DC motor type by plug-in attributes
+ *
+ * Only valid after the port has been configured using dvcs_config_dc_type_for_port()
+ *
+ * @param type_inx DC motor type. [From ev3_dc.h]
+ * @param port EV3 port.
+ * @param extport Extended port (used by Motor Multiplexers).
+ * @param[out] sn Buffer for the sequence number.
+ * @return Flag - the DC motor is found.
+ *
+ */
+bool dvcs_search_dc_type_for_port(INX_T type_inx, U8 port, U8 extport, U8 *sn );
+
+/** Search for the sequence number for a specific servo motor type by plug-in attributes
+ *
+ * Only valid after the servo controller has been configured using dvcs_config_servo_type_for_port()
+ *
+ * @param type_inx Servo motor type. [From ev3_servo.h]
+ * @param port EV3 port of the servo controller.
+ * @param extport Servo channel of the controller.
+ * @param[out] sn Buffer for the sequence number.
+ * @return Flag - the servo motor is found.
+ *
+ */
+bool dvcs_search_servo_type_for_port(INX_T type_inx, U8 port, U8 extport, U8 *sn );
+
 /*@}*/
 
 /** @defgroup device-manualconfig Device Manual Configuration
@@ -139,21 +188,23 @@ bool dvcs_config_tacho_type_for_port(INX_T type_inx, U8 port, U8 extport, U8 *sn
 bool dvcs_reset_port_for_tacho(U8 sn );
 #endif
 
-#if 0
-// Not tested (no hardware)
-/** Configure the specific servo motor type fpr a given port and find the sequence number
+/** Configure the servo controller for a given port and find the sequence number of a servo motor
+ *
+ * The port is configured for the Mindsensors 8-channel servo controller (MS_8CH_SERVO),
+ * which registers one servo motor per channel.
  *
  * @param type_inx Servo motor type.  [From ev3_servo.h]
- * @param port EV3 port.
- * @param extport Extended port (used by Motor Multiplexers).
+ * @param port EV3 port of the servo controller.
+ * @param extport Servo channel of the controller.
  * @param[out] sn Buffer for the sequence number.
  * @return Flag - the servo motor is found.
  *
  * Note: Servo motors are third party motors (i.e., EV3 and NXT motors are not servo motors)
+ * Not tested (no hardware)
  */
 bool dvcs_config_servo_type_for_port(INX_T type_inx, U8 port, U8 extport, U8 *sn );
 
-/** Reset the port mode to auto for the given servo
+/** Reset the port mode of the servo controller to auto for the given servo
  *
  * @param sn sequence number.
  * @return Flag - the port is reset to auto
@@ -161,8 +212,6 @@ bool dvcs_config_servo_type_for_port(INX_T type_inx, U8 port, U8 extport, U8 *sn
  */
 bool dvcs_reset_port_for_servo(U8 sn );
 
-#endif
-
 /*@}*/
 
 /*@}*/
@@ -0,0 +1,112 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   fastattr.h
+ *  \brief  ARM-BBR persistent sysfs attribute access function prototypes
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#pragma once
+
+#include "ev3dev-arm-ctypes.h"
+
+/** @addtogroup common */
+/*@{*/
+
+/** @defgroup fastattr Fast Attribute Access
+ *
+ * The ev3dev-c get_xxx()/set_xxx() routines open, access and close the sysfs attribute file on every call.
+ * The Fast Attribute routines keep the attribute file open and use a single pread()/pwrite() per access
+ * with integer conversion done in place, for attributes accessed in the control loop
+ * (e.g., sensor value0 and tacho motor duty_cycle_sp).
+ *
+ * The device sequence numbers are the ev3dev-c sequence numbers (the sysfs device number).
+ */
+/*@{*/
+
+#define FATTR_SENSOR_PATH  "/sys/class/lego-sensor/sensor"	///< Sensor attribute path prefix
+#define FATTR_TACHO_PATH   "/sys/class/tacho-motor/motor"	///< Tacho motor attribute path prefix
+#define FATTR_DC_PATH      "/sys/class/dc-motor/motor"		///< DC motor attribute path prefix
+#define FATTR_SERVO_PATH   "/sys/class/servo-motor/motor"	///< Servo motor attribute path prefix
+
+/** Open a sensor value attribute for reading
+ *
+ * @param sn Sensor sequence number.
+ * @param inx Value index (value0, value1, ...).
+ * @return File descriptor, or -1 on error.
+ *
+ */
+S32 fattr_open_sensor_value(U8 sn, U8 inx);
+
+/** Open a tacho motor attribute
+ *
+ * @param sn Tacho motor sequence number.
+ * @param attr Attribute name (e.g., "duty_cycle_sp").
+ * @param writable Flag - open for writing.
+ * @return File descriptor, or -1 on error.
+ *
+ */
+S32 fattr_open_tacho(U8 sn, const char *attr, bool writable);
+
+/** Open a device attribute
+ *
+ * @param path_prefix Device class path prefix (e.g., FATTR_TACHO_PATH).
+ * @param sn Device sequence number.
+ * @param attr Attribute name (e.g., "duty_cycle_sp").
+ * @param writable Flag - open for writing.
+ * @return File descriptor, or -1 on error.
+ *
+ */
+S32 fattr_open(const char *path_prefix, U8 sn, const char *attr, bool writable);
+
+/** Read an integer attribute
+ *
+ * @param fd File descriptor.
+ * @param[out] value Buffer for the value.
+ * @return Flag - the value was read.
+ *
+ */
+bool fattr_read_int(S32 fd, S32 *value);
+
+/** Write an integer attribute
+ *
+ * @param fd File descriptor.
+ * @param value Value.
+ * @return Flag - the value was written.
+ *
+ */
+bool fattr_write_int(S32 fd, S32 value);
+
+/** Read a string attribute
+ *
+ * @param fd File descriptor.
+ * @param[out] buf Buffer for the string (NUL terminated, trailing newline removed).
+ * @param size Buffer size.
+ * @return Flag - the value was read.
+ *
+ */
+bool fattr_read_str(S32 fd, char *buf, U32 size);
+
+/** Write a string attribute
+ *
+ * @param fd File descriptor.
+ * @param str String (e.g., "stop").
+ * @return Flag - the value was written.
+ *
+ */
+bool fattr_write_str(S32 fd, const char *str);
+
+/** Close an attribute
+ *
+ * @param fd File descriptor.
+ * @return None
+ *
+ */
+void fattr_close(S32 fd);
+
+/*@}*/
+/*@}*/
@@ -0,0 +1,196 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   heading.h
+ *  \brief  ARM-BBR gyro and odometry heading estimator function prototypes
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#pragma once
+
+#include "ev3dev-arm-ctypes.h"
+
+/** @addtogroup common */
+/*@{*/
+
+/** @defgroup heading Heading Estimator
+ *
+ * The Heading Estimator tracks the robot heading by integrating the LEGO_EV3_GYRO rate (GYRO-RATE mode)
+ * every HDG_PERIOD_US, and by wheel odometry from the tacho positions of a differential drive.
+ *
+ * The gyro bias is measured at startup using hdg_calibrate() (the robot must be stationary), and is then tracked
+ * whenever the robot is stationary (gyro rate below HDG_STILL_MDPS and wheels not moving for HDG_STILL_US);
+ * the gyro is not integrated while the robot is stationary, so the heading does not drift while waiting.
+ *
+ * The gyro and odometry headings are fused with a fixed-point complementary filter: the gyro heading changes are
+ * applied directly, and the fused heading is pulled towards the odometry heading by odo_weight / 65536 of the
+ * difference at each odometry sample, which removes the slow gyro drift while ignoring short wheel slips.
+ * Either source can be used alone.
+ *
+ * Headings are in millidegrees, counter-clockwise positive (use HDG_GYRO_INVERT if the gyro is mounted upside down).
+ *
+ * hdg_turn_start() starts a turn-by-angle: the estimator checks the heading at every sample, and with HDG_TURN_STOP
+ * stops the wheel motors itself as soon as the remaining angle is within the tolerance (allowing for the motors to stop
+ * within HDG_TURN_LEAD_US at the current rate), instead of waiting for the next event loop tick.
+ *
+ * The estimator can be run from the event loop using hdg_poll(), or on a background thread using hdg_start().
+ *
+ *     e.g.: hdg_set_gyro(gyro_sn, 0);
+ *           hdg_set_odometry(left_sn, right_sn, 56, 120, 360);   (56 mm wheels, 120 mm track)
+ *           hdg_calibrate(1000);
+ *           hdg_start();
+ *           ...start turning left...
+ *           hdg_turn_start(90000, 1000, HDG_TURN_STOP);
+ *           ...
+ *           if (hdg_turn_done()) ...                             (e.g., from a CORO_WAIT check routine)
+ */
+/*@{*/
+
+#define HDG_PERIOD_US          2000			///< Gyro sampling period
+#define HDG_ODO_DIVIDER           5			///< Odometry is sampled every HDG_ODO_DIVIDER gyro samples
+#define HDG_ODO_WEIGHT           16			///< Default odometry weight (Q16, per odometry sample)
+#define HDG_STILL_MDPS         2000			///< Maximum gyro rate of a stationary robot (millidegrees/s)
+#define HDG_STILL_US         500000			///< Stationary time before the bias is tracked
+#define HDG_BIAS_SHIFT            8			///< Bias tracking filter (1 / 2^HDG_BIAS_SHIFT per sample)
+#define HDG_CAL_MAX_SPREAD        3			///< Maximum gyro rate spread during calibration (degrees/s)
+#define HDG_TURN_LEAD_US      20000			///< Motor stopping latency allowed for by HDG_TURN_STOP
+
+/* Gyro flags */
+#define HDG_GYRO_INVERT        0x01			///< The gyro is mounted upside down
+
+/* Turn flags */
+#define HDG_TURN_STOP          0x01			///< Stop the wheel motors when the turn is done
+
+/** Use a gyro sensor (sets the GYRO-RATE mode)
+ *
+ * @param sn Gyro sensor sequence number.
+ * @param flags Gyro flags (HDG_XXX).
+ * @return Flag - the gyro was set up.
+ *
+ */
+bool hdg_set_gyro(U8 sn, U32 flags);
+
+/** Use differential drive wheel odometry
+ *
+ * @param left_sn, right_sn Wheel tacho motor sequence numbers.
+ * @param wheel_mm Wheel diameter (mm).
+ * @param track_mm Distance between the wheels (mm).
+ * @param count_per_rot Tacho counts per wheel rotation.
+ * @return Flag - the odometry was set up.
+ *
+ */
+bool hdg_set_odometry(U8 left_sn, U8 right_sn, U32 wheel_mm, U32 track_mm, U32 count_per_rot);
+
+/** Set the odometry weight of the complementary filter
+ *
+ * @param weight_q16 Weight (Q16, 0 ignores the odometry when there is a gyro).
+ * @return None
+ *
+ */
+void hdg_set_odometry_weight(U32 weight_q16);
+
+/** Measure the gyro bias (the robot must be stationary; call before hdg_start())
+ *
+ * @param duration_ms Measurement duration (ms).
+ * @return Flag - the bias was measured (FALSE if the robot moved).
+ *
+ */
+bool hdg_calibrate(U32 duration_ms);
+
+/** Set the current heading
+ *
+ * @param heading Heading (millidegrees).
+ * @return None
+ *
+ */
+void hdg_reset(S32 heading);
+
+/** Sample the gyro and odometry when due
+ *
+ * @param None
+ * @return Systick when the next sample is due.
+ *
+ */
+U32 hdg_poll(void);
+
+/** Start the background sampling thread
+ *
+ * @param None
+ * @return Flag - the thread was started.
+ *
+ */
+bool hdg_start(void);
+
+/** Stop the background sampling thread
+ *
+ * @param None
+ * @return None
+ *
+ */
+void hdg_stop(void);
+
+/** Get the fused heading
+ *
+ * @param None
+ * @return Heading (millidegrees).
+ *
+ */
+S32 hdg_get_heading(void);
+
+/** Get the turning rate
+ *
+ * @param None
+ * @return Rate (millidegrees/s, counter-clockwise positive).
+ *
+ */
+S32 hdg_get_rate(void);
+
+/** Get the gyro bias
+ *
+ * @param None
+ * @return Bias (millidegrees/s).
+ *
+ */
+S32 hdg_get_bias(void);
+
+/** Get the gyro and odometry headings (before fusion)
+ *
+ * @param[out] gyro Buffer for the gyro heading (millidegrees), or NULL.
+ * @param[out] odometry Buffer for the odometry heading (millidegrees), or NULL.
+ * @return None
+ *
+ */
+void hdg_get_sources(S32 *gyro, S32 *odometry);
+
+/** Start a turn by angle (the caller starts the motors)
+ *
+ * @param angle Angle (millidegrees, counter-clockwise positive).
+ * @param tolerance Tolerance (millidegrees).
+ * @param flags Turn flags (HDG_TURN_XXX).
+ * @return None
+ *
+ */
+void hdg_turn_start(S32 angle, U32 tolerance, U32 flags);
+
+/** Check if the turn is done
+ *
+ * @param None
+ * @return Flag - the turn is done (also TRUE if no turn was started).
+ *
+ */
+bool hdg_turn_done(void);
+
+/** Get the remaining angle of the turn
+ *
+ * @param None
+ * @return Remaining angle (millidegrees, counter-clockwise positive).
+ *
+ */
+S32 hdg_turn_remaining(void);
+
+/*@}*/
+/*@}*/
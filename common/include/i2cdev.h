@@ -0,0 +1,134 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   i2cdev.h
+ *  \brief  ARM-BBR direct /dev/i2c sensor access function prototypes
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#pragma once
+
+#include "ev3dev-arm-ctypes.h"
+#include "devices.h"
+
+/** @addtogroup common */
+/*@{*/
+
+/** @defgroup i2cdev Direct I2C Sensor Access
+ *
+ * The Direct I2C library reads NXT I2C sensors through /dev/i2c-N instead of the lego-sensor sysfs class,
+ * avoiding the kernel polling timer and the text formatting of sysfs values.
+ *
+ * The input port must first be switched to the "other-i2c" mode using i2cd_claim_port(), so that the
+ * lego-sensor driver releases the sensor. Each sensor type has a descriptor (I2C address, ID strings and
+ * data registers), and register reads are combined write/read transactions (I2C_RDWR), so that a burst of
+ * registers is read in a single transfer.
+ *
+ * Adapters without raw I2C support (e.g., the i2c-stub test module) are accessed using SMBus I2C block
+ * transfers instead. If the I2CD_MOCK_ENV environment variable is set to a directory, devices are mocked
+ * using register image files named i2c-<bus>-<address>.bin (address in hex) in that directory.
+ *
+ *     e.g.: i2cd_claim_port(INPUT_2, EXT_PORT__NONE_);
+ *           dev = i2cd_open(I2CD_EV3_INPUT_BUS(2), HT_NXT_COMPASS);
+ *           i2cd_read_data(dev, buf);           // buf[0] * 2 + buf[1] = heading (deg)
+ */
+/*@{*/
+
+#define I2CD_MAX_DEVICES       8				///< Maximum number of open devices
+#define I2CD_MAX_TRANSFER     32				///< Maximum register burst length (SMBus block limit)
+#define I2CD_ID_LEN            8				///< Length of the vendor and product ID registers
+#define I2CD_VENDOR_ID_REG  0x08				///< Vendor ID register (NXT I2C sensor convention)
+#define I2CD_PRODUCT_ID_REG 0x10				///< Product ID register (NXT I2C sensor convention)
+#define I2CD_MOCK_ENV       "BBR_I2C_MOCK"		///< Environment variable for the mock bus directory
+
+#define I2CD_EV3_INPUT_BUS(n)  ((n) + 2)		///< I2C bus number for EV3 input port n (1..4)
+
+/** I2C sensor descriptor */
+typedef struct {
+	INX_T type_inx;								///< Sensor type [From ev3_sensor.h]
+	U8 address;									///< 7-bit I2C address
+	U8 data_reg;								///< First data register
+	U8 data_len;								///< Number of data registers
+	const char *vendor_id;						///< Expected vendor ID (NULL: not checked)
+	const char *product_id;						///< Expected product ID (NULL: not checked)
+} I2CD_DESC;
+
+/** Get the descriptor for a sensor type
+ *
+ * @param type_inx Sensor type. [From ev3_sensor.h]
+ * @return Descriptor, or NULL if the sensor type is not supported.
+ *
+ */
+const I2CD_DESC *i2cd_find_desc(INX_T type_inx);
+
+/** Switch an input port to the "other-i2c" mode for direct access
+ *
+ * @param port EV3 port.
+ * @param extport Extended port.
+ * @return Flag - the port mode was set.
+ *
+ */
+bool i2cd_claim_port(U8 port, U8 extport);
+
+/** Open a sensor on an I2C bus
+ *
+ * @param bus I2C bus number (see I2CD_EV3_INPUT_BUS()).
+ * @param type_inx Sensor type. [From ev3_sensor.h]
+ * @return Device handle, or -1 if the device could not be opened.
+ *
+ */
+S32 i2cd_open(U32 bus, INX_T type_inx);
+
+/** Check the vendor and product ID registers against the descriptor
+ *
+ * @param dev Device handle.
+ * @return Flag - the device matches its descriptor.
+ *
+ */
+bool i2cd_identify(S32 dev);
+
+/** Read a burst of registers
+ *
+ * @param dev Device handle.
+ * @param reg First register.
+ * @param[out] buf Buffer for the register values.
+ * @param len Number of registers [1..I2CD_MAX_TRANSFER].
+ * @return Flag - the registers were read.
+ *
+ */
+bool i2cd_read(S32 dev, U8 reg, U8 *buf, U32 len);
+
+/** Write a burst of registers
+ *
+ * @param dev Device handle.
+ * @param reg First register.
+ * @param buf Register values.
+ * @param len Number of registers [1..I2CD_MAX_TRANSFER].
+ * @return Flag - the registers were written.
+ *
+ */
+bool i2cd_write(S32 dev, U8 reg, const U8 *buf, U32 len);
+
+/** Read the data registers given by the descriptor
+ *
+ * @param dev Device handle.
+ * @param[out] buf Buffer for the data registers (descriptor data_len bytes).
+ * @return Flag - the registers were read.
+ *
+ */
+bool i2cd_read_data(S32 dev, U8 *buf);
+
+/** Close a device
+ *
+ * @param dev Device handle.
+ * @return None
+ *
+ */
+void i2cd_close(S32 dev);
+
+/*@}*/
+/*@}*/
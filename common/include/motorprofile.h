@@ -0,0 +1,132 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   motorprofile.h
+ *  \brief  ARM-BBR named motor configuration profile function prototypes
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#pragma once
+
+#include "ev3dev-arm-ctypes.h"
+
+/** @addtogroup common */
+/*@{*/
+
+/** @defgroup motorprofile Motor Configuration Profiles
+ *
+ * A Motor Profile is a named bundle of tacho motor settings (ramp up/down time, stop action, speed and position setpoints),
+ * validated and registered at init. Each profile only sets the attributes selected in its fields mask.
+ *
+ * The settings last written to each motor are cached, so motor_apply_profile() only writes the attributes which differ.
+ * Behaviors with different dynamics (e.g., a gentle cruise versus a hard escape) can then each apply their own profile
+ * for the cost of one or two sysfs writes.
+ *
+ *     e.g.: static const MOTOR_PROFILE cruise = { "cruise", MOTOR_PROF_RAMP_UP | MOTOR_PROF_RAMP_DOWN, 300, 300, 0, 0, 0 };
+ *           cruise_id = motor_register_profile(&cruise);
+ *           ...
+ *           motor_apply_profile(sn, cruise_id);
+ *
+ * Attributes written directly (e.g., set_tacho_speed_sp()) are not seen by the cache; call motor_invalidate() after
+ * such writes, or after a tacho reset command, so that the next motor_apply_profile() writes them again.
+ *
+ * Motor Profiles are not thread-safe; apply them from the event loop.
+ */
+/*@{*/
+
+#define MOTOR_MAX_PROFILES     16			///< Maximum number of profiles
+#define MOTOR_MAX_RAMP_MS      10000		///< Maximum ramp up/down time (ms)
+#define MOTOR_MAX_SPEED_SP     1560			///< Maximum speed setpoint magnitude (tacho counts/s, EV3 Medium Motor)
+
+/* Profile attribute flags */
+#define MOTOR_PROF_RAMP_UP      0x01		///< ramp_up_sp
+#define MOTOR_PROF_RAMP_DOWN    0x02		///< ramp_down_sp
+#define MOTOR_PROF_STOP_ACTION  0x04		///< stop_action
+#define MOTOR_PROF_SPEED        0x08		///< speed_sp
+#define MOTOR_PROF_POSITION     0x10		///< position_sp
+#define MOTOR_PROF_ALL          0x1F
+
+/** Motor profile (all fields are words, so that profiles can be defined in Assembly Language) */
+typedef struct {
+	const char *name;					///< Profile name (unique)
+	U32 fields;							///< Attributes set by the profile (MOTOR_PROF_XXX)
+	S32 ramp_up_sp;						///< Ramp up time (ms)
+	S32 ramp_down_sp;					///< Ramp down time (ms)
+	U32 stop_action;					///< Stop action (TACHO_COAST, TACHO_BRAKE, TACHO_HOLD)
+	S32 speed_sp;						///< Speed setpoint (tacho counts/s)
+	S32 position_sp;					///< Position setpoint (tacho counts)
+} MOTOR_PROFILE;
+
+/** Profile application statistics */
+typedef struct {
+	U32 applied;						///< Profile applications
+	U32 writes;							///< Attributes written
+	U32 skipped;						///< Attributes skipped because the motor already had the value
+	U32 failed;							///< Attribute writes which failed
+} MOTOR_PROFILE_STATS;
+
+/** Register a profile
+ *
+ * @param profile Profile settings (copied).
+ * @return Profile ID, or -1 if the profile is invalid, its name is already registered or the table is full.
+ *
+ */
+S32 motor_register_profile(const MOTOR_PROFILE *profile);
+
+/** Find a profile by name
+ *
+ * @param name Profile name.
+ * @return Profile ID, or -1 if not found.
+ *
+ */
+S32 motor_find_profile(const char *name);
+
+/** Apply a profile to a motor, writing only the attributes which differ from the cached settings
+ *
+ * @param sn Tacho motor sequence number.
+ * @param id Profile ID.
+ * @return Flag - all the profile attributes were written (or already set).
+ *
+ */
+bool motor_apply_profile(U8 sn, S32 id);
+
+/** Apply a profile to a vector of motors
+ *
+ * @param sns Vector of tacho motor sequence numbers, terminated by DESC_LIMIT (as used by multi_set_tacho_xxx()).
+ * @param id Profile ID.
+ * @return Flag - the profile was applied to all the motors.
+ *
+ */
+bool motor_apply_profile_vec(const U8 *sns, S32 id);
+
+/** Forget the cached settings of a motor
+ *
+ * @param sn Tacho motor sequence number.
+ * @param fields Attributes to forget (MOTOR_PROF_XXX).
+ * @return None
+ *
+ */
+void motor_invalidate(U8 sn, U32 fields);
+
+/** Get the ID of the profile last applied to a motor
+ *
+ * @param sn Tacho motor sequence number.
+ * @return Profile ID, or -1 if none.
+ *
+ */
+S32 motor_current_profile(U8 sn);
+
+/** Get the profile application statistics
+ *
+ * @param[out] stats Buffer for the statistics.
+ * @return None
+ *
+ */
+void motor_get_profile_stats(MOTOR_PROFILE_STATS *stats);
+
+/*@}*/
+/*@}*/
@@ -0,0 +1,98 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   numfmt.h
+ *  \brief  ARM-BBR integer formatting function prototypes
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#pragma once
+
+#include "ev3dev-arm-ctypes.h"
+
+/** @addtogroup common */
+/*@{*/
+
+/** @defgroup numfmt Integer Formatting
+ *
+ * The Integer Formatting library converts integers to text without the stdio formatting engine,
+ * for the prog_display_xxx() routines and other frequent display or logging updates.
+ * The text is written into a caller buffer (at least NFMT_BUF_SIZE bytes), NUL terminated,
+ * and the length (excluding the NUL) is returned.
+ *
+ * nfmt_udec() is implemented in ARM Assembly (numfmt-dec.S): the digit count is found by comparing
+ * against a table of powers of ten, then the digits are written from the end using a reciprocal multiply
+ * (x / 10 = (x * 0xCCCCCCCD) >> 35) instead of a division, which the ARM926EJ-S does not have.
+ * nfmt_udec_ref() is the C reference implementation that the assembly routine must match exactly.
+ * Hexadecimal and binary digits are looked up a nibble at a time.
+ *
+ *     e.g.: len = nfmt_dec(buf, (U32) -12345, 8, NFMT_SIGNED);      ("  -12345", 8)
+ *           len = nfmt_hex(buf, 0xA5, 2, NFMT_PREFIX);               ("0xA5", 4)
+ */
+/*@{*/
+
+#define NFMT_BUF_SIZE        36			///< Buffer size for any formatted value ("0b" + 32 bits + NUL)
+#define NFMT_MAX_WIDTH       (NFMT_BUF_SIZE - 1)	///< Maximum field width
+
+/* Format flags */
+#define NFMT_SIGNED        0x01			///< nfmt_dec(): the value is an S32
+#define NFMT_PLUS          0x02			///< nfmt_dec(): show a '+' sign for positive values (with NFMT_SIGNED)
+#define NFMT_PREFIX        0x04			///< nfmt_hex()/nfmt_bin(): "0x" or "0b" prefix
+
+/** Format an unsigned decimal value
+ *
+ * @param[out] buf Buffer (at least 11 bytes).
+ * @param value Value.
+ * @return Length.
+ *
+ */
+U32 nfmt_udec(char *buf, U32 value);
+
+/** C reference implementation of nfmt_udec()
+ *
+ * @param[out] buf Buffer (at least 11 bytes).
+ * @param value Value.
+ * @return Length.
+ *
+ */
+U32 nfmt_udec_ref(char *buf, U32 value);
+
+/** Format a decimal value, right aligned in a field
+ *
+ * @param[out] buf Buffer (at least NFMT_BUF_SIZE bytes).
+ * @param value Value (an S32 with NFMT_SIGNED).
+ * @param width Minimum field width, padded with spaces on the left (0: no padding, at most NFMT_MAX_WIDTH).
+ * @param flags Format flags (NFMT_SIGNED, NFMT_PLUS).
+ * @return Length.
+ *
+ */
+U32 nfmt_dec(char *buf, U32 value, U32 width, U32 flags);
+
+/** Format a hexadecimal value (uppercase, zero padded)
+ *
+ * @param[out] buf Buffer (at least NFMT_BUF_SIZE bytes).
+ * @param value Value.
+ * @param digits Number of digits [1..8] (0: 8 digits).
+ * @param flags Format flags (NFMT_PREFIX).
+ * @return Length.
+ *
+ */
+U32 nfmt_hex(char *buf, U32 value, U32 digits, U32 flags);
+
+/** Format a binary value (zero padded)
+ *
+ * @param[out] buf Buffer (at least NFMT_BUF_SIZE bytes).
+ * @param value Value.
+ * @param bits Number of bits, rounded up to a multiple of 4 [4..32] (0: 32 bits).
+ * @param flags Format flags (NFMT_PREFIX).
+ * @return Length.
+ *
+ */
+U32 nfmt_bin(char *buf, U32 value, U32 bits, U32 flags);
+
+/*@}*/
+/*@}*/
@@ -0,0 +1,162 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   occgrid.h
+ *  \brief  ARM-BBR fixed-point occupancy grid function prototypes
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#pragma once
+
+#include "ev3dev-arm-ctypes.h"
+
+/** @addtogroup common */
+/*@{*/
+
+/** @defgroup occgrid Occupancy Grid
+ *
+ * The Occupancy Grid is a map of the area around the robot built from range sensor readings
+ * (e.g., LEGO_EV3_US, LEGO_EV3_IR or LEGO_NXT_US) taken at a known robot pose.
+ *
+ * Each cell holds a saturating signed 8-bit log-odds value: positive cells are probably occupied, negative cells
+ * are probably free, and 0 is unknown. Cells are stored in OGRID_TILE x OGRID_TILE tiles of 64 bytes, so that
+ * neighbouring cells in both directions are usually in the same cache lines.
+ *
+ * Each reading is cast as a ray from the robot cell using integer Bresenham line stepping: the cells along the ray
+ * are made more likely free, and the cell at the measured range (if below the sensor's maximum range) more likely occupied.
+ * Rays are limited to OGRID_MAX_RAY_CELLS cells, so each update runs in bounded time. All the arithmetic is integer
+ * (angles are in binary degrees, OGRID_ANGLES per turn, with a Q14 sine table).
+ *
+ * ogrid_freest_direction() casts rays in a number of directions around the robot, and returns the direction
+ * with the most free (or unknown) space before an occupied cell, e.g., for an escape behavior.
+ *
+ * Coordinates are in mm, with the origin at the center of the grid, X along heading 0 and Y along heading OGRID_ANGLES / 4.
+ *
+ *     e.g.: ogrid_init(&grid, 64, 64, 50);               (3.2 m x 3.2 m, 50 mm cells)
+ *           ...
+ *           ogrid_update(&grid, &pose, 0, range_mm, 2550); (sensor facing forward)
+ *           ...
+ *           heading = ogrid_freest_direction(&grid, &pose, 16, 1000, &clearance);
+ *           ...
+ *           ogrid_dump(&grid, &pose, "/tmp/grid.pgm");
+ */
+/*@{*/
+
+#define OGRID_TILE_BITS       3							///< Tile size (log2)
+#define OGRID_TILE            (1 << OGRID_TILE_BITS)	///< Tile size (cells)
+#define OGRID_ANGLES          256						///< Binary degrees per turn
+#define OGRID_MAX_RAY_CELLS   128						///< Maximum cells stepped per ray
+#define OGRID_LOGODDS_MAX     100						///< Cell saturation limit
+#define OGRID_FREE_DELTA      (-4)						///< Log-odds update for cells along a ray
+#define OGRID_OCC_DELTA       12						///< Log-odds update for the cell at the measured range
+#define OGRID_OCC_THRESHOLD   20						///< Cells above this value block ogrid_freest_direction()
+
+/** Robot pose */
+typedef struct {
+	S32 x;								///< X position (mm)
+	S32 y;								///< Y position (mm)
+	S32 heading;						///< Heading (binary degrees)
+} OGRID_POSE;
+
+/** Occupancy grid */
+typedef struct {
+	S8 *cells;							///< Tiled log-odds cells
+	U32 width;							///< Width (cells, multiple of OGRID_TILE)
+	U32 height;							///< Height (cells, multiple of OGRID_TILE)
+	U32 tiles_x;						///< Tiles per row
+	U32 cell_mm;						///< Cell size (mm)
+	U32 updates;						///< Number of readings
+} OGRID;
+
+/** Initialize an occupancy grid (all cells unknown)
+ *
+ * @param grid Grid.
+ * @param width Width (cells, rounded up to a multiple of OGRID_TILE).
+ * @param height Height (cells, rounded up to a multiple of OGRID_TILE).
+ * @param cell_mm Cell size (mm).
+ * @return Flag - the grid was allocated.
+ *
+ */
+bool ogrid_init(OGRID *grid, U32 width, U32 height, U32 cell_mm);
+
+/** Free an occupancy grid
+ *
+ * @param grid Grid.
+ * @return None
+ *
+ */
+void ogrid_free(OGRID *grid);
+
+/** Reset all cells to unknown
+ *
+ * @param grid Grid.
+ * @return None
+ *
+ */
+void ogrid_clear(OGRID *grid);
+
+/** Update the grid with a range reading
+ *
+ * @param grid Grid.
+ * @param pose Robot pose.
+ * @param bearing Sensor direction relative to the robot heading (binary degrees).
+ * @param range_mm Measured range (mm).
+ * @param max_range_mm Sensor maximum range (mm); readings at or beyond it only clear cells.
+ * @return Number of cells updated.
+ *
+ */
+U32 ogrid_update(OGRID *grid, const OGRID_POSE *pose, S32 bearing, S32 range_mm, S32 max_range_mm);
+
+/** Get a cell
+ *
+ * @param grid Grid.
+ * @param x, y Position (mm).
+ * @return Log-odds value (0 outside the grid).
+ *
+ */
+S32 ogrid_get(const OGRID *grid, S32 x, S32 y);
+
+/** Find the direction with the most free space around the robot
+ *
+ * Free cells count twice as much as unknown cells.
+ *
+ * @param grid Grid.
+ * @param pose Robot pose.
+ * @param num_dirs Number of directions, evenly spaced starting at the robot heading.
+ * @param max_range_mm Distance checked in each direction (mm).
+ * @param[out] clearance_mm Distance to the nearest occupied cell (or the grid edge) in that direction, or NULL.
+ * @return Direction relative to the robot heading (binary degrees).
+ *
+ */
+S32 ogrid_freest_direction(const OGRID *grid, const OGRID_POSE *pose, U32 num_dirs, S32 max_range_mm,
+						   S32 *clearance_mm);
+
+/** Get the Q14 cosine and sine of an angle
+ *
+ * @param angle Angle (binary degrees).
+ * @param[out] cos_q14 Buffer for the cosine (16384 = 1.0).
+ * @param[out] sin_q14 Buffer for the sine (16384 = 1.0).
+ * @return None
+ *
+ */
+void ogrid_cos_sin(S32 angle, S32 *cos_q14, S32 *sin_q14);
+
+/** Dump the grid as a binary PGM image (free cells white, occupied cells black, unknown cells grey)
+ *
+ * The first image row is the top (maximum Y) row of the grid; the robot cell (if pose is not NULL) is marked dark grey.
+ * The cell size and the number of readings are written as PGM comments.
+ *
+ * @param grid Grid.
+ * @param pose Robot pose, or NULL.
+ * @param path File path.
+ * @return Flag - the image was written.
+ *
+ */
+bool ogrid_dump(const OGRID *grid, const OGRID_POSE *pose, const char *path);
+
+/*@}*/
+/*@}*/
@@ -0,0 +1,173 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   params.h
+ *  \brief  ARM-BBR live-tunable parameter store function prototypes
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#pragma once
+
+#include "ev3dev-arm-ctypes.h"
+
+/** @addtogroup common */
+/*@{*/
+
+/** @defgroup params Parameter Store
+ *
+ * The Parameter Store keeps tuning parameters in a memory mapped file (e.g., PRM_DEFAULT_PATH in tmpfs),
+ * so that they can be changed while the robot is running using scripts/bbrparam.py, without a rebuild or a restart.
+ *
+ * The parameters are defined by a PRM_DEF table (name, type, default, min, max), terminated by a NULL name.
+ * The table is made of 32-bit words, so it can also be defined in Assembly using the PARAM_XXX macros (arm-params.h).
+ * Each parameter value is a 32-bit word in the prm_values array, which is read with plain loads (no system calls):
+ * the PRM_<name> offset generated by the PARAM macro is the offset of the parameter in prm_values.
+ *
+ * The file starts with a header (PRM_HDR_XXX word offsets) holding a schema hash of the definition table.
+ * prm_open() keeps the values in an existing file with the same schema hash (e.g., values tuned during a previous run),
+ * and otherwise (re)creates the file with the default values. If the file cannot be mapped, the parameters are kept
+ * in private memory with the default values, so that the robot still runs.
+ *
+ * Updates are protected by a sequence lock (one writer at a time): the writer makes the sequence odd, writes the value,
+ * increments the generation and makes the sequence even again. Single word reads are always consistent; prm_snapshot()
+ * retries until it has a copy of all values from the same generation, and prm_changed() tells when to reload values
+ * cached in registers.
+ *
+ *     e.g.: prm_open(PRM_DEFAULT_PATH, defs);
+ *           ...
+ *           speed = prm_values[SPEED];                 (SPEED is the index of "speed" in defs)
+ *           ...
+ *           if (prm_changed(&gen))
+ *               reload();
+ */
+/*@{*/
+
+#define PRM_DEFAULT_PATH     "/dev/shm/bbr.params"		///< Default parameter file (tmpfs, lost on reboot)
+#define PRM_MAX_PARAMS       64							///< Maximum number of parameters
+#define PRM_NAME_SIZE        24							///< Name size in the file (including the terminating NUL)
+#define PRM_FILE_MAGIC       0x50524242					///< "BBRP" (little-endian)
+#define PRM_FILE_VERSION     1
+
+/* File header word offsets */
+#define PRM_HDR_MAGIC        0
+#define PRM_HDR_VERSION      1
+#define PRM_HDR_SCHEMA       2							///< FNV-1a hash of the definition table
+#define PRM_HDR_COUNT        3							///< Number of parameters
+#define PRM_HDR_SEQ          4							///< Sequence lock (odd while a value is being written)
+#define PRM_HDR_GENERATION   5							///< Incremented by each update
+#define PRM_HDR_WORDS        8							///< Header size (words); the values follow the header
+
+/* Parameter Types */
+#define PRM_S32              0
+#define PRM_U32              1
+#define PRM_BOOL             2
+
+/** Parameter definition (all words, see the PARAM macro in arm-params.h) */
+typedef struct {
+	const char *name;					///< Name (up to PRM_NAME_SIZE - 1 characters), NULL terminates the table
+	U32 type;							///< PRM_S32, PRM_U32 or PRM_BOOL
+	S32 def;							///< Default value
+	S32 min;							///< Minimum value
+	S32 max;							///< Maximum value
+} PRM_DEF;
+
+/** Parameter entry in the file, after the values (so that tools do not need the definition table) */
+typedef struct {
+	char name[PRM_NAME_SIZE];
+	U32 type;
+	S32 def;
+	S32 min;
+	S32 max;
+} PRM_ENTRY;
+
+/** Current parameter values (NULL before prm_open()) */
+extern volatile S32 *prm_values;
+
+/** Open the parameter store
+ *
+ * @param path File path (NULL for PRM_DEFAULT_PATH).
+ * @param defs Definition table, terminated by a NULL name (must remain valid until prm_close()).
+ * @return Parameter values (also in prm_values), or NULL if the definition table is invalid.
+ *
+ */
+volatile S32 *prm_open(const char *path, const PRM_DEF *defs);
+
+/** Close the parameter store (the file is kept for the next run)
+ *
+ * @param None
+ * @return None
+ *
+ */
+void prm_close(void);
+
+/** Check if the parameter values are in a shared file (otherwise they cannot be tuned)
+ *
+ * @param None
+ * @return Flag - the values are shared.
+ *
+ */
+bool prm_is_shared(void);
+
+/** Get the number of parameters
+ *
+ * @param None
+ * @return Number of parameters.
+ *
+ */
+U32 prm_count(void);
+
+/** Find a parameter
+ *
+ * @param name Parameter name.
+ * @return Parameter index, or -1 if not found.
+ *
+ */
+S32 prm_find(const char *name);
+
+/** Get a parameter value
+ *
+ * @param index Parameter index.
+ * @return Value (0 if the index is invalid).
+ *
+ */
+S32 prm_get(U32 index);
+
+/** Set a parameter value
+ *
+ * @param index Parameter index.
+ * @param value Value [min..max].
+ * @return Flag - the value was set.
+ *
+ */
+bool prm_set(U32 index, S32 value);
+
+/** Get the update generation
+ *
+ * @param None
+ * @return Generation (incremented by each update).
+ *
+ */
+U32 prm_generation(void);
+
+/** Check if the parameters were updated
+ *
+ * @param last_gen Generation last seen (updated).
+ * @return Flag - the generation differs from last_gen.
+ *
+ */
+bool prm_changed(U32 *last_gen);
+
+/** Copy all parameter values consistently
+ *
+ * @param[out] values Buffer for prm_count() values.
+ * @return Generation of the values.
+ *
+ */
+U32 prm_snapshot(S32 *values);
+
+/*@}*/
+/*@}*/
@@ -0,0 +1,194 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   pipeline.h
+ *  \brief  ARM-BBR sense/decide/act pipeline function prototypes
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#pragma once
+
+#include "ev3dev-arm-ctypes.h"
+
+/** @addtogroup common */
+/*@{*/
+
+/** @defgroup pipeline Sense/Decide/Act Pipeline
+ *
+ * The Pipeline runs the input controller, behavior dispatcher and actuator controller of an event loop
+ * on three threads (stages), so that blocking sysfs I/O in one stage does not delay the others.
+ *
+ * The stages exchange state through lock-free triple buffers:
+ *   sense  --(world state)-->  decide  --(commands)-->  act
+ *
+ * Each stage routine is called periodically with pointers to the latest input and to its own output buffer:
+ *   void stage(const void *in, void *out);    (AAPCS: R0 = in, R1 = out)
+ * The sense stage has no input (in == NULL) and the act stage has no output (out == NULL).
+ * The output buffer belongs to the stage and keeps its contents between calls; it is published after each call.
+ * The decide and act stages are only called once their input has been published.
+ *
+ * Coroutines are called from the stage which matches their role (e.g., CORO_CALL sensor_xxx in the sense stage,
+ * CALL_BEHAVIOR in the decide stage, CORO_CALL actuator_xxx in the act stage). Each coroutine must only be called
+ * from one stage, and stages must only share data through the in/out buffers.
+ *
+ * Each published buffer carries a sequence number and the systick of the sense stage call it derives from,
+ * so that the input age and the sense-to-act latency are measured for each stage.
+ */
+/*@{*/
+
+#define PPLN_STAGE_SENSE   0			///< Sensing (input controller) stage
+#define PPLN_STAGE_DECIDE  1			///< Behavior / arbiter stage
+#define PPLN_STAGE_ACT     2			///< Actuation (actuator controller) stage
+#define PPLN_NUM_STAGES    3
+
+#define PPLN_TB_SLOTS      3			///< Triple buffer slots
+
+/** Stage routine */
+typedef void (*PPLN_STAGE_FUNC)(const void *in, void *out);
+
+/** Lock-free single producer, single consumer triple buffer
+ *
+ * The writer owns the back slot and the reader owns the front slot. Publishing swaps the back slot with the
+ * middle slot and marks it fresh; reading swaps the front slot with the middle slot if it is fresh.
+ * Neither side ever waits, and the reader always gets the most recently published data.
+ */
+typedef struct {
+	U8 *data;							///< PPLN_TB_SLOTS slots of size bytes
+	U32 size;							///< Slot size (bytes)
+	U32 seq[PPLN_TB_SLOTS];				///< Sequence number of each slot (0: never written)
+	U32 origin[PPLN_TB_SLOTS];			///< Origin systick of each slot
+	U32 middle;							///< Middle slot index | PPLN_TB_FRESH (atomic)
+	U8 back;							///< Writer slot
+	U8 front;							///< Reader slot
+	U32 write_seq;						///< Last published sequence number (writer)
+	U32 overwritten;					///< Publishes which replaced unread data (writer)
+} PPLN_TRIPLEBUF;
+
+/** Stage statistics (times in ticks) */
+typedef struct {
+	U32 runs;							///< Number of stage routine calls
+	U32 overruns;						///< Number of calls which overran the stage period
+	U32 skipped;						///< Input updates overwritten before this stage read them
+	U32 exec_min;						///< Stage routine execution time
+	U32 exec_max;
+	U32 exec_avg;
+	U32 age_min;						///< Age of new input (since its sense stage call) when this stage starts
+	U32 age_max;
+	U32 age_avg;
+	U32 latency_min;					///< Sense-to-act latency (act stage only): end of act call - sense origin
+	U32 latency_max;
+	U32 latency_avg;
+} PPLN_STATS;
+
+/** Initialize a triple buffer
+ *
+ * @param tb Triple buffer.
+ * @param size Slot size (bytes).
+ * @return Flag - the buffer was allocated.
+ *
+ */
+bool ppln_tb_init(PPLN_TRIPLEBUF *tb, U32 size);
+
+/** Publish data (writer)
+ *
+ * @param tb Triple buffer.
+ * @param data Data (size bytes), copied into the back slot.
+ * @param origin Origin systick of the data.
+ * @return Sequence number of the published data.
+ *
+ */
+U32 ppln_tb_publish(PPLN_TRIPLEBUF *tb, const void *data, U32 origin);
+
+/** Get the most recently published data (reader)
+ *
+ * @param tb Triple buffer.
+ * @param[out] seq Buffer for the sequence number (0: nothing published yet).
+ * @param[out] origin Buffer for the origin systick (may be NULL).
+ * @return Pointer to the data, valid until the next ppln_tb_read() call.
+ *
+ */
+const void *ppln_tb_read(PPLN_TRIPLEBUF *tb, U32 *seq, U32 *origin);
+
+/** Free a triple buffer
+ *
+ * @param tb Triple buffer.
+ * @return None
+ *
+ */
+void ppln_tb_free(PPLN_TRIPLEBUF *tb);
+
+/** Initialize the pipeline buffers
+ *
+ * @param world_size Size of the world state published by the sense stage (bytes).
+ * @param command_size Size of the commands published by the decide stage (bytes).
+ * @return Flag - the buffers were allocated.
+ *
+ */
+bool ppln_init(U32 world_size, U32 command_size);
+
+/** Configure a stage
+ *
+ * @param stage Stage (PPLN_STAGE_XXX).
+ * @param func Stage routine.
+ * @param period_us Stage routine call period.
+ * @param priority SCHED_FIFO priority (1..99), 0 inherits the scheduling of the caller.
+ * @return Flag - the stage was configured.
+ *
+ */
+bool ppln_set_stage(U32 stage, PPLN_STAGE_FUNC func, U32 period_us, U32 priority);
+
+/** Start the stage threads
+ *
+ * @param None
+ * @return Flag - all stages were started.
+ *
+ */
+bool ppln_start(void);
+
+/** Stop the stage threads (waits for the current stage routine calls to complete)
+ *
+ * @param None
+ * @return None
+ *
+ */
+void ppln_stop(void);
+
+/** Check if the pipeline is running
+ *
+ * @param None
+ * @return Flag - the pipeline is running.
+ *
+ */
+bool ppln_is_running(void);
+
+/** Get the statistics for a stage
+ *
+ * @param stage Stage (PPLN_STAGE_XXX).
+ * @param[out] stats Buffer for the statistics.
+ * @return Flag - the statistics were returned.
+ *
+ */
+bool ppln_get_stats(U32 stage, PPLN_STATS *stats);
+
+/** Write the per-stage statistics to stderr
+ *
+ * @param None
+ * @return None
+ *
+ */
+void ppln_report(void);
+
+/** Free the pipeline buffers (after ppln_stop())
+ *
+ * @param None
+ * @return None
+ *
+ */
+void ppln_exit(void);
+
+/*@}*/
+/*@}*/
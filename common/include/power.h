@@ -0,0 +1,174 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   power.h
+ *  \brief  ARM-BBR battery monitor and energy accounting function prototypes
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#pragma once
+
+#include "ev3dev-arm-ctypes.h"
+
+/** @addtogroup common */
+/*@{*/
+
+/** @defgroup power Battery Monitor
+ *
+ * The Battery Monitor samples the EV3 power_supply voltage and current every PWR_PERIOD_US,
+ * and keeps exponentially smoothed values (with a time constant of about 2^PWR_SMOOTH_SHIFT samples).
+ *
+ * Motor Compensation: unregulated motor outputs (e.g., duty_cycle_sp in run-direct mode) slow down as the battery sags.
+ * pwr_compensate() scales an output by the nominal voltage over the smoothed voltage, so that the motor gets
+ * the same average voltage as with a nominal battery. Regulated tacho speed setpoints (speed_sp) are already
+ * compensated by the motor driver, until the motor runs out of headroom.
+ *
+ * Energy Accounting: the energy drawn from the battery (voltage * current) in each sample period is charged to
+ * the active behavior (set using pwr_set_behavior()), and split among the actuators in proportion to the
+ * magnitude of their current duty cycle. Energy drawn while no actuator is running is charged to the idle account.
+ * The EV3 only measures the total battery current, so the actuator split is an estimate.
+ *
+ * The monitor can be run from the event loop using pwr_poll(), or on a background thread using pwr_start().
+ *
+ *     e.g.: pwr_init(PWR_NOMINAL_MV);
+ *           escape = pwr_add_behavior("escape");
+ *           pwr_add_actuator("left", sn_left);
+ *           pwr_start();
+ *           ...
+ *           pwr_set_behavior(escape);                     (when the behavior is executed)
+ *           set_tacho_duty_cycle_sp(sn, pwr_compensate(duty, 100));
+ *           ...
+ *           pwr_stop();
+ *           pwr_report();
+ */
+/*@{*/
+
+#define PWR_BATTERY_PATH    "/sys/class/power_supply/lego-ev3-battery/"	///< EV3 battery attribute path
+#define PWR_MAX_ACCOUNTS    16				///< Maximum number of behavior and actuator accounts
+#define PWR_PERIOD_US       100000			///< Sampling period
+#define PWR_SMOOTH_SHIFT    3				///< Smoothing factor (1/8 of each new sample)
+#define PWR_NOMINAL_MV      7500			///< Nominal voltage (EV3 rechargeable battery)
+#define PWR_MAX_GAIN_PCT    150				///< Maximum compensation gain (%)
+#define PWR_IDLE_ACCOUNT    0				///< Account charged while no actuator is running
+
+/** Account type */
+enum {
+	PWR_ACCT_IDLE,
+	PWR_ACCT_BEHAVIOR,
+	PWR_ACCT_ACTUATOR
+};
+
+/** Initialize the battery monitor
+ *
+ * @param nominal_mv Nominal voltage for motor compensation (mV).
+ * @return Flag - the battery attributes were opened.
+ *
+ */
+bool pwr_init(U32 nominal_mv);
+
+/** Add a behavior energy account
+ *
+ * @param name Behavior name (not copied).
+ * @return Account ID, or -1 if the table is full.
+ *
+ */
+S32 pwr_add_behavior(const char *name);
+
+/** Add an actuator energy account
+ *
+ * @param name Actuator name (not copied).
+ * @param sn Tacho motor sequence number.
+ * @return Account ID, or -1 if the table is full or the duty_cycle attribute could not be opened.
+ *
+ */
+S32 pwr_add_actuator(const char *name, U8 sn);
+
+/** Set the behavior charged for the energy used from now on
+ *
+ * @param id Behavior account ID, or -1 for none.
+ * @return None
+ *
+ */
+void pwr_set_behavior(S32 id);
+
+/** Sample the battery if due
+ *
+ * @param None
+ * @return Systick of the next sample.
+ *
+ */
+U32 pwr_poll(void);
+
+/** Run the battery monitor on a background thread
+ *
+ * @param None
+ * @return Flag - the thread was started.
+ *
+ */
+bool pwr_start(void);
+
+/** Stop the background thread
+ *
+ * @param None
+ * @return None
+ *
+ */
+void pwr_stop(void);
+
+/** Get the smoothed battery voltage
+ *
+ * @param None
+ * @return Voltage (mV), or 0 if not sampled yet.
+ *
+ */
+U32 pwr_get_voltage(void);
+
+/** Get the smoothed battery current
+ *
+ * @param None
+ * @return Current (mA), or 0 if not sampled yet.
+ *
+ */
+U32 pwr_get_current(void);
+
+/** Compensate a motor output for the battery voltage
+ *
+ * @param value Output at the nominal voltage (e.g., duty cycle %).
+ * @param limit Maximum output magnitude.
+ * @return value * nominal / smoothed voltage (gain limited to PWR_MAX_GAIN_PCT), clamped to +/-limit.
+ *
+ */
+S32 pwr_compensate(S32 value, S32 limit);
+
+/** Get the energy charged to an account
+ *
+ * Only consistent once the background thread is stopped.
+ *
+ * @param id Account ID (PWR_IDLE_ACCOUNT for the idle account).
+ * @return Energy (mJ).
+ *
+ */
+U32 pwr_get_energy(S32 id);
+
+/** Get the total energy drawn from the battery
+ *
+ * @param None
+ * @return Energy (mJ).
+ *
+ */
+U32 pwr_get_total_energy(void);
+
+/** Write the battery state and the energy of each account to stderr
+ *
+ * @param None
+ * @return None
+ *
+ */
+void pwr_report(void);
+
+/*@}*/
+/*@}*/
@@ -0,0 +1,102 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   prng.h
+ *  \brief  ARM-BBR deterministic pseudo random number generator function prototypes
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#pragma once
+
+#include "ev3dev-arm-ctypes.h"
+
+/** @addtogroup common */
+/*@{*/
+
+/** @defgroup prng Pseudo Random Number Generator
+ *
+ * The PRNG library provides a fast, reproducible xorshift32 generator for use by behaviors.
+ * The generator state lives in the library, so a given seed always produces the same
+ * sequence of decisions. The seed is logged at startup so that a run can be replayed.
+ *
+ * prng_next() and prng_range() are implemented in ARM Assembly (prng-xorshift.S).
+ * prng_next_ref() and prng_range_ref() are the C reference implementations
+ * that the assembly routines must match exactly.
+ */
+/*@{*/
+
+#define PRNG_SEED_ENV  "ARM_BBR_SEED"		///< Environment variable used to override the startup seed
+#define PRNG_ZERO_SEED 0x2545F491			///< Substitute for a zero seed (xorshift state must be non-zero)
+
+/** Initialize the PRNG at program startup
+ *
+ * @param None
+ * @return Seed used
+ *
+ * The seed is taken from the PRNG_SEED_ENV environment variable (decimal or 0x-prefixed hex)
+ * if it is defined, otherwise it is derived from the process ID and the real time clock.
+ * The seed is written to stderr so that the run can be replayed.
+ */
+U32 prng_init(void);
+
+/** Seed the PRNG explicitly
+ *
+ * @param seed: Seed value (0 is replaced by PRNG_ZERO_SEED)
+ * @return None
+ */
+void prng_seed(U32 seed);
+
+/** Get the seed used by the last prng_seed() or prng_init() call
+ *
+ * @param None
+ * @return Seed value
+ */
+U32 prng_get_seed(void);
+
+/** Get the next 32-bit pseudo random value
+ *
+ * @param None
+ * @return Pseudo random value
+ */
+U32 prng_next(void);
+
+/** Get a pseudo random value in the range [0, bound)
+ *
+ * @param bound: Exclusive upper bound (0 returns 0)
+ * @return Pseudo random value less than bound
+ *
+ * The range reduction uses a 32x32->64 bit multiply instead of a modulo operation.
+ */
+U32 prng_range(U32 bound);
+
+/** Choose an index using a table of weights
+ *
+ * @param weights: Array of weights (0 means never chosen)
+ * @param count: Number of entries in weights
+ * @return Index of the chosen entry, or count if all weights are zero
+ *
+ * e.g., weights of { 0, 2, 1, 1, 0 } indexed by MOVE_XXX enums pick MOVE_FORWARD half of the time.
+ */
+U32 prng_choose_weighted(const U8 *weights, U32 count);
+
+/** C reference implementation of prng_next()
+ *
+ * @param state: Pointer to xorshift32 state (updated)
+ * @return Pseudo random value
+ */
+U32 prng_next_ref(U32 *state);
+
+/** C reference implementation of prng_range()
+ *
+ * @param state: Pointer to xorshift32 state (updated)
+ * @param bound: Exclusive upper bound (0 returns 0)
+ * @return Pseudo random value less than bound
+ */
+U32 prng_range_ref(U32 *state, U32 bound);
+
+/*@}*/
+/*@}*/
@@ -52,6 +52,47 @@
  */
 void prog_init(void);                /* Program Initialization Routine */
 
+/**
+ * Initialize ARM-BBR subsystems for fast start (alternative to prog_init())
+ * Clears LCD screen, then sets the console font and generates the startup tone
+ * on a helper thread so that device discovery can proceed in the meantime.
+ * Status messages displayed before the font is set may use the system font.
+ *    @param None
+ *    @return None
+ */
+void prog_init_fast(void);           /* Program Fast Start Initialization Routine */
+
+/**
+ * Real-time execution mode capabilities (returned by prog_init_rt())
+ */
+#define RT_CAP_SCHED_FIFO	0x01		///< SCHED_FIFO scheduling policy granted
+#define RT_CAP_MLOCKALL		0x02		///< Current and future pages locked in memory
+#define RT_CAP_PREFAULT		0x04		///< Stack and heap prefaulted
+#define RT_CAP_CPUFREQ		0x08		///< CPU frequency pinned using the performance governor
+
+#define RT_PRIORITY_DEFAULT	50			///< Default SCHED_FIFO priority (1..99)
+#define RT_PREFAULT_STACK	(64 * 1024)		///< Stack prefault size (bytes)
+#define RT_PREFAULT_HEAP	(256 * 1024)	///< Heap prefault size (bytes)
+
+/**
+ * Enable Real-time execution mode (optional)
+ * Call after prog_init(). The settings are restored by prog_exit() (or prog_exit_rt()).
+ * Each capability is attempted independently; capabilities which require
+ * root privileges (or CAP_SYS_NICE / CAP_IPC_LOCK) are skipped if not permitted.
+ * The granted capabilities are also reported on stderr.
+ *    @param priority: SCHED_FIFO priority (1..99), 0 selects RT_PRIORITY_DEFAULT
+ *    @return Bitmask of RT_CAP_XXX capabilities granted
+ */
+U32 prog_init_rt(U32 priority);		/* Program Real-time Mode Initialization Routine */
+
+/**
+ * Restore the settings changed by prog_init_rt() (scheduling policy, memory locking,
+ * malloc tuning and CPU frequency governor), for programs which do not use prog_init()
+ *    @param None
+ *    @return None
+ */
+void prog_exit_rt(void);			/* Program Real-time Mode Exit Routine */
+
 /**
  * Exit ARM-BBR subsystems
  * Generate exit tone
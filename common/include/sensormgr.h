@@ -0,0 +1,119 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   sensormgr.h
+ *  \brief  ARM-BBR mode-aware sensor manager function prototypes
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#pragma once
+
+#include "ev3dev-arm-ctypes.h"
+#include "devices.h"
+
+/** @addtogroup common */
+/*@{*/
+
+/** @defgroup sensormgr Mode-aware Sensor Manager
+ *
+ * EV3 UART sensors take tens of milliseconds to switch modes, and the values read
+ * while a switch is in progress belong to the previous mode.
+ *
+ * The Sensor Manager caches the current mode of each sensor, so that redundant mode writes are suppressed
+ * (snsr_set_mode() can be used as a drop-in replacement for set_sensor_mode_inx()).
+ *
+ * Several consumers can share one sensor in different modes using snsr_request().
+ * Each request specifies the maximum age of its value. snsr_poll() (called once per event loop)
+ * reads all the requests for the current mode in one batch, and only switches modes when
+ * another mode's value is about to exceed its maximum age, so that the number of mode switches
+ * is the minimum needed to satisfy all requests.
+ * Values are only accepted once the mode switch has settled, and are returned with their systick.
+ *
+ * The Sensor Manager is not thread-safe; call it from the event loop.
+ */
+/*@{*/
+
+#define SNSR_MAX_REQUESTS      8				///< Maximum number of requests
+#define SNSR_MAX_VALUES        4				///< Maximum number of values per request
+#define SNSR_SETTLE_US   (30 * 1000)			///< Default mode switch settle time
+#define SNSR_MODE_UNKNOWN     -1				///< Sensor mode not cached yet
+
+/** Set the sensor mode, unless it is already the current mode
+ *
+ * @param sn Sensor sequence number.
+ * @param mode_inx Sensor mode. [From ev3_sensor.h]
+ * @return Flag - the sensor is in the requested mode.
+ *
+ */
+bool snsr_set_mode(U8 sn, INX_T mode_inx);
+
+/** Get the cached sensor mode
+ *
+ * @param sn Sensor sequence number.
+ * @return Sensor mode, or SNSR_MODE_UNKNOWN.
+ *
+ */
+S32 snsr_get_mode(U8 sn);
+
+/** Forget the cached mode (e.g., after the sensor is reconnected)
+ *
+ * @param sn Sensor sequence number.
+ * @return None
+ *
+ */
+void snsr_invalidate(U8 sn);
+
+/** Set the mode switch settle time for a sensor
+ *
+ * @param sn Sensor sequence number.
+ * @param settle_us Settle time after a mode switch.
+ * @return None
+ *
+ */
+void snsr_set_settle(U8 sn, U32 settle_us);
+
+/** Register a request for sensor values in a given mode
+ *
+ * @param sn Sensor sequence number.
+ * @param mode_inx Sensor mode. [From ev3_sensor.h]
+ * @param max_age_us Maximum age of the value before the sensor must be switched to this mode.
+ * @param num_values Number of values to read [1..SNSR_MAX_VALUES].
+ * @return Request number, or -1 if the request could not be added.
+ *
+ */
+S32 snsr_request(U8 sn, INX_T mode_inx, U32 max_age_us, U32 num_values);
+
+/** Read requested values and switch sensor modes when needed
+ *
+ * @param None
+ * @return Number of requests updated.
+ *
+ */
+U32 snsr_poll(void);
+
+/** Get the latest value for a request
+ *
+ * @param request Request number.
+ * @param inx Value index.
+ * @param[out] value Buffer for the value.
+ * @param[out] systick Buffer for the systick of the reading (may be NULL).
+ * @return Flag - a valid value is available.
+ *
+ */
+bool snsr_get_value(U32 request, U32 inx, S32 *value, U32 *systick);
+
+/** Get the sensor manager statistics
+ *
+ * @param[out] switches Buffer for the number of mode switches (may be NULL).
+ * @param[out] suppressed Buffer for the number of redundant mode writes suppressed (may be NULL).
+ * @return None
+ *
+ */
+void snsr_get_stats(U32 *switches, U32 *suppressed);
+
+/*@}*/
+/*@}*/
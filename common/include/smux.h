@@ -0,0 +1,133 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   smux.h
+ *  \brief  ARM-BBR sensor multiplexer polling scheduler function prototypes
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#pragma once
+
+#include "ev3dev-arm-ctypes.h"
+#include "devices.h"
+
+/** @addtogroup common */
+/*@{*/
+
+/** @defgroup smux Sensor Multiplexer Scheduler
+ *
+ * The Sensor Multiplexer Scheduler reads several sensors connected to
+ * MS_EV3_SMUX or HT_NXT_SMUX channels at a target rate for each channel.
+ *
+ * Each channel is configured without blocking: the mux channel port mode is set
+ * (see dvcs_mux_channel_mode_inx()), and the channel is only read after its settle time
+ * has elapsed, both after configuration and after each sensor mode change.
+ * Due channels are read in round-robin order, so that a slow channel cannot starve the others.
+ *
+ * The scheduler can be run from the event loop using smux_poll(), or on a background thread using smux_start().
+ * Values are published with the systick of the reading, and can be retrieved at any time using smux_get_value().
+ *
+ *     e.g.: ch = smux_add_channel(MS_EV3_SMUX, INPUT_1, extport, LEGO_EV3_COLOR, LEGO_EV3_COLOR_COL_REFLECT, 50, 1, 0);
+ *           smux_start();
+ *           ...
+ *           if (smux_get_value(ch, 0, &value, &systick)) ...
+ */
+/*@{*/
+
+#define SMUX_MAX_CHANNELS          8			///< Maximum number of mux channels
+#define SMUX_MAX_VALUES            4			///< Maximum number of values read per channel
+#define SMUX_MODE_DEFAULT         -1			///< Keep the sensor's default mode
+
+#define SMUX_SETTLE_ANALOG_US   (500 * 1000)	///< Default settle time for analog channels
+#define SMUX_SETTLE_UART_US    (1500 * 1000)	///< Default settle time for UART channels (sensor handshake)
+#define SMUX_SETTLE_I2C_US      (500 * 1000)	///< Default settle time for I2C channels
+#define SMUX_SETTLE_MODE_US      (50 * 1000)	///< Settle time after a sensor mode change
+
+/** Channel state */
+enum {
+	SMUX_CH_UNUSED,
+	SMUX_CH_CONFIGURING,			///< Waiting for the mux channel port mode to settle
+	SMUX_CH_SETTLING,				///< Waiting for the sensor mode to settle
+	SMUX_CH_ACTIVE,					///< Being read
+	SMUX_CH_FAILED					///< Sensor not found on the mux channel
+};
+
+/** Add a mux channel to the scheduler
+ *
+ * @param mux_type_inx Sensor multiplexer type (MS_EV3_SMUX or HT_NXT_SMUX). [From ev3_sensor.h]
+ * @param port EV3 port the mux is connected to.
+ * @param extport Extended port of the mux channel.
+ * @param type_inx Sensor type connected to the mux channel. [From ev3_sensor.h]
+ * @param mode_inx Sensor mode, or SMUX_MODE_DEFAULT. [From ev3_sensor.h]
+ * @param rate_hz Target read rate for the channel.
+ * @param num_values Number of values to read [1..SMUX_MAX_VALUES].
+ * @param settle_us Settle time after configuration (0 selects the default for the channel mode).
+ * @return Channel number, or -1 if the channel could not be added.
+ *
+ */
+S32 smux_add_channel(INX_T mux_type_inx, U8 port, U8 extport, INX_T type_inx, S32 mode_inx,
+					 U32 rate_hz, U32 num_values, U32 settle_us);
+
+/** Change the sensor mode of a mux channel
+ *
+ * Values read before the mode change are no longer valid once this returns.
+ *
+ * @param channel Channel number.
+ * @param mode_inx Sensor mode. [From ev3_sensor.h]
+ * @return Flag - the channel exists.
+ *
+ */
+bool smux_set_mode(U32 channel, S32 mode_inx);
+
+/** Run one scheduler pass
+ *
+ * Completes pending channel configuration, then reads due channels in round-robin order
+ * until all due channels are read or the time budget is used up.
+ *
+ * @param budget_us Time budget for reads (0: no limit).
+ * @return Systick when the next channel is due.
+ *
+ */
+U32 smux_poll(U32 budget_us);
+
+/** Start the scheduler on a background thread
+ *
+ * @return Flag - the thread was started.
+ *
+ */
+bool smux_start(void);
+
+/** Stop the background scheduler thread
+ *
+ * @return None
+ *
+ */
+void smux_stop(void);
+
+/** Get the latest value read from a mux channel
+ *
+ * @param channel Channel number.
+ * @param inx Value index.
+ * @param[out] value Buffer for the value.
+ * @param[out] systick Buffer for the systick of the reading (may be NULL).
+ * @return Flag - a valid value is available.
+ *
+ */
+bool smux_get_value(U32 channel, U32 inx, S32 *value, U32 *systick);
+
+/** Get the state and statistics of a mux channel
+ *
+ * @param channel Channel number.
+ * @param[out] reads Buffer for the number of readings (may be NULL).
+ * @param[out] late Buffer for the number of readings which were later than one period (may be NULL).
+ * @return Channel state (SMUX_CH_XXX).
+ *
+ */
+U8 smux_get_stats(U32 channel, U32 *reads, U32 *late);
+
+/*@}*/
+/*@}*/
@@ -0,0 +1,183 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   stackcoro.h
+ *  \brief  ARM-BBR stackful coroutine function prototypes
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#pragma once
+
+#include "ev3dev-arm-ctypes.h"
+
+/** @addtogroup common */
+/*@{*/
+
+/** @defgroup stackcoro Stackful Coroutines
+ *
+ * Stackful Coroutines are an alternative to the label-resume coroutines in arm-coroutine.h.
+ * Each coroutine runs on its own preallocated stack, and switching between the caller and the coroutine
+ * saves and restores R4-R11, SP and LR with a single STMIA/LDMIA pair (stackcoro-switch.S).
+ *
+ * Since the callee-saved registers and the stack are preserved across a yield, a coroutine can keep its
+ * local variables in R4-R11 (or on its stack), may call subroutines which yield, and does not need CORO_LOCAL
+ * variables in the data section. Several instances of the same coroutine routine can run at the same time.
+ *
+ * Each stack is mmap()ed with an inaccessible guard page below it, so that a stack overflow causes
+ * a SIGSEGV instead of silently corrupting memory. The stack is painted with SCORO_STACK_PAINT when it is
+ * created, and scoro_stack_used() reports the high-water mark, so that stack sizes can be tuned.
+ *
+ *     e.g.: co = scoro_create(sensor_routine, NULL, SCORO_DEFAULT_STACK);
+ *           loop:
+ *               scoro_resume(co);                  (from the event loop)
+ *
+ *           void sensor_routine(void *arg) {
+ *               for (;;) {
+ *                   ...
+ *                   scoro_yield();
+ *                   scoro_wait(cont_eval_function);
+ *               }
+ *           }
+ *
+ * The status values returned by scoro_resume() are the same as those returned by CORO_CALL.
+ * Stackful Coroutines are not thread-safe; all of them must be resumed from the same thread.
+ */
+/*@{*/
+
+#define SCORO_DEFAULT_STACK  4096			///< Default stack size (bytes)
+#define SCORO_MIN_STACK      1024			///< Minimum stack size (bytes), rounded up to the page size
+#define SCORO_STACK_PAINT    0x5CA1AB1E		///< Unused stack pattern (high-water measurement)
+
+#define SCORO_READY  0						///< Status: not started (CO_READY)
+#define SCORO_WAIT   1						///< Status: waiting in scoro_wait() (CO_WAIT)
+#define SCORO_YIELD  2						///< Status: suspended in scoro_yield() (CO_YIELD)
+#define SCORO_END    3						///< Status: coroutine routine returned (CO_END)
+
+#define SCORO_CONTEXT_REGS  10				///< R4-R11, SP, LR
+
+/** Coroutine routine */
+typedef void (*SCORO_FUNC)(void *arg);
+
+/** Stackful coroutine */
+typedef struct SCORO {
+	U32 context[SCORO_CONTEXT_REGS];		///< Coroutine context (must be the first field, see stackcoro-switch.S)
+	U32 caller[SCORO_CONTEXT_REGS];			///< Resumer context
+	struct SCORO *resumer;					///< Coroutine (or NULL for the main program) which resumed this one
+	SCORO_FUNC func;
+	void *arg;
+	U8 *mapping;							///< Guard page and stack
+	U32 mapping_size;
+	U8 *stack;								///< Lowest usable stack address
+	U32 stack_size;							///< Usable stack size (bytes)
+	U32 status;								///< SCORO_XXX
+	U32 switches;							///< Number of resumes
+} SCORO;
+
+/** Create a coroutine
+ *
+ * @param func Coroutine routine, called with arg on the first scoro_resume().
+ * @param arg Coroutine routine argument.
+ * @param stack_size Stack size (bytes), rounded up to the page size.
+ * @return Coroutine, or NULL if the stack could not be allocated.
+ *
+ */
+SCORO *scoro_create(SCORO_FUNC func, void *arg, U32 stack_size);
+
+/** Run a coroutine until it yields, waits or ends
+ *
+ * @param co Coroutine.
+ * @return Status - SCORO_YIELD, SCORO_WAIT or SCORO_END (a coroutine which has ended is not resumed).
+ *
+ */
+U32 scoro_resume(SCORO *co);
+
+/** Suspend the current coroutine and return to its resumer
+ *
+ * @param None
+ * @return None
+ *
+ * Note: R4-R11 and the stack are preserved until the coroutine is resumed.
+ */
+void scoro_yield(void);
+
+/** Suspend the current coroutine until a condition is true
+ *
+ * @param cont_eval_function Continue evaluation function (returns TRUE to continue, or FALSE to wait).
+ * @return None
+ *
+ * The condition is evaluated before suspending, and again on each resume.
+ */
+void scoro_wait(bool (*cont_eval_function)(void));
+
+/** Restart a coroutine from the beginning of its routine
+ *
+ * @param co Coroutine (must not be the current coroutine).
+ * @return Flag - the coroutine was restarted.
+ *
+ */
+bool scoro_restart(SCORO *co);
+
+/** Check that a coroutine has not ended
+ *
+ * @param co Coroutine.
+ * @return Flag - the coroutine is alive.
+ *
+ */
+bool scoro_alive(SCORO *co);
+
+/** Get the current coroutine
+ *
+ * @param None
+ * @return Coroutine, or NULL if called from the main program.
+ *
+ */
+SCORO *scoro_current(void);
+
+/** Get the stack high-water mark of a coroutine
+ *
+ * @param co Coroutine.
+ * @return Maximum stack usage so far (bytes).
+ *
+ */
+U32 scoro_stack_used(SCORO *co);
+
+/** Free a coroutine and its stack
+ *
+ * @param co Coroutine (must not be the current coroutine).
+ * @return None
+ *
+ */
+void scoro_destroy(SCORO *co);
+
+/** Switch contexts (stackcoro-switch.S)
+ *
+ * @param save Buffer for the current R4-R11, SP and LR.
+ * @param load Context to switch to.
+ * @param status Value returned in R0 from the scoro_switch() call which saved the load context.
+ * @return Value passed by the scoro_switch() call which switches back to this context.
+ *
+ * Note: This routine is not intended for public use
+ */
+U32 scoro_switch(U32 *save, const U32 *load, U32 status);
+
+/** End the current coroutine (called by the coroutine entry trampoline when the routine returns)
+ *
+ * @param co Coroutine.
+ * @return Does not return
+ *
+ * Note: This routine is not intended for public use
+ */
+void scoro_finish(SCORO *co);
+
+/** Coroutine entry trampoline (stackcoro-switch.S)
+ *
+ * Note: This routine is not intended for public use
+ */
+void scoro_trampoline(void);
+
+/*@}*/
+/*@}*/
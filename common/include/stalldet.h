@@ -0,0 +1,141 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   stalldet.h
+ *  \brief  ARM-BBR motor stall and end-stop detector function prototypes
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#pragma once
+
+#include "ev3dev-arm-ctypes.h"
+
+/** @addtogroup common */
+/*@{*/
+
+/** @defgroup stalldet Motor Stall Detector
+ *
+ * The Stall Detector samples the position of tacho motors every few milliseconds (and optionally the tacho
+ * "stalled" state flag), so that a motor driven against a mechanical end-stop or an obstacle is detected
+ * well within one event loop tick, instead of by comparing positions across ticks.
+ *
+ * A motor is stalled when it moves less than its minimum speed for the whole debounce time:
+ * each sample is compared with an anchor position, and the anchor is moved to the current sample whenever the
+ * motor has moved further than min_speed * elapsed time (plus one count of slack for the encoder resolution).
+ * Averaging over the debounce time makes the check independent of the sampling rate, even when the motor
+ * moves less than one count per sample. Low speeds during the grace time after stall_arm() (the motor
+ * ramping up) are ignored.
+ *
+ * The detector must be armed with stall_arm() after each motor start; the stall event is then raised once and
+ * stays raised until the motor is armed again. With STALL_STOP_MOTOR, the detector also stops the motor
+ * as soon as it stalls, so the motor does not keep pushing against the stop until the actuator handles the event.
+ *
+ * The detector can be run from the event loop using stall_poll(), or on a background thread using stall_start().
+ *
+ *     e.g.: id = stall_add_motor(sn, 30, 30000, 20000, STALL_STOP_MOTOR);
+ *           stall_start();
+ *           ...start the motor...
+ *           stall_arm(id);
+ *           ...
+ *           if (stall_detected(id)) ...                   (e.g., from a CORO_WAIT check routine)
+ */
+/*@{*/
+
+#define STALL_MAX_MOTORS        4			///< Maximum number of monitored motors
+#define STALL_PERIOD_US      2000			///< Sampling period of each armed motor
+#define STALL_SLACK_COUNTS      1			///< Position change ignored (encoder resolution)
+
+/* Detector flags */
+#define STALL_USE_STATE      0x01			///< Also raise the event when the tacho state includes "stalled"
+#define STALL_STOP_MOTOR     0x02			///< Stop the motor when the stall is detected
+
+/** Add a tacho motor to the detector
+ *
+ * @param sn Tacho motor sequence number.
+ * @param min_speed Minimum speed of a moving motor (tacho counts/s).
+ * @param debounce_us Time below the minimum speed before the stall event is raised.
+ * @param grace_us Time after stall_arm() during which low speeds are ignored.
+ * @param flags Detector flags (STALL_XXX).
+ * @return Detector ID, or -1 if the motor could not be added.
+ *
+ */
+S32 stall_add_motor(U8 sn, U32 min_speed, U32 debounce_us, U32 grace_us, U32 flags);
+
+/** Arm the detector for a motor (call after starting the motor)
+ *
+ * Clears the stall event.
+ *
+ * @param id Detector ID.
+ * @return None
+ *
+ */
+void stall_arm(S32 id);
+
+/** Disarm the detector for a motor
+ *
+ * The stall event (if raised) is kept.
+ *
+ * @param id Detector ID.
+ * @return None
+ *
+ */
+void stall_disarm(S32 id);
+
+/** Check the stall event of a motor
+ *
+ * @param id Detector ID.
+ * @return Flag - the motor stalled since it was last armed.
+ *
+ */
+bool stall_detected(S32 id);
+
+/** Get the motor position when the stall was detected
+ *
+ * @param id Detector ID.
+ * @param[out] position Buffer for the position (tacho counts).
+ * @param[out] latency Buffer for the time between arming and the detection (us), or NULL.
+ * @return Flag - the motor stalled since it was last armed.
+ *
+ */
+bool stall_get_position(S32 id, S32 *position, U32 *latency);
+
+/** Sample the armed motors which are due
+ *
+ * @param None
+ * @return Systick of the next sample.
+ *
+ */
+U32 stall_poll(void);
+
+/** Run the detector on a background thread
+ *
+ * @param None
+ * @return Flag - the thread was started.
+ *
+ */
+bool stall_start(void);
+
+/** Stop the background thread
+ *
+ * @param None
+ * @return None
+ *
+ */
+void stall_stop(void);
+
+/** Get the detector statistics of a motor
+ *
+ * @param id Detector ID.
+ * @param[out] samples Number of samples.
+ * @param[out] events Number of stall events.
+ * @return Flag - the statistics were retrieved.
+ *
+ */
+bool stall_get_stats(S32 id, U32 *samples, U32 *events);
+
+/*@}*/
+/*@}*/
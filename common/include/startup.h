@@ -0,0 +1,58 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   startup.h
+ *  \brief  ARM-BBR startup phase tracer function prototypes
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#pragma once
+
+#include "ev3dev-arm-ctypes.h"
+
+/** @addtogroup common */
+/*@{*/
+
+/** @defgroup startup Startup Phase Tracer
+ *
+ * The Startup library timestamps the end of each initialization phase
+ * so that the time from program launch to the first event loop tick can be broken down.
+ *
+ * Call stup_mark() after each phase (the library marks its own phases in prog_init() etc.),
+ * and stup_report() once the first event loop tick starts.
+ * Marking is cheap and always enabled; the report is only written when
+ * the STUP_REPORT_ENV environment variable is set to a file name, or "-" for stderr.
+ *
+ * Times are measured from process creation, so the first phase includes program loading
+ * (at the kernel's clock tick resolution, usually 10 ms). Phases marked by helper threads
+ * are listed with their own durations.
+ */
+/*@{*/
+
+#define STUP_MAX_PHASES     32					///< Maximum number of phases recorded
+#define STUP_REPORT_ENV     "BBR_STARTUP_REPORT"	///< Environment variable for the report destination
+
+/** Record the end of a startup phase
+ *
+ * Safe to call from multiple threads.
+ *
+ * @param phase: Phase name (must remain valid until stup_report(), e.g., a string literal)
+ * @return None
+ */
+void stup_mark(const char *phase);
+
+/** Write the startup phase breakdown report
+ *
+ * Records a final "first tick" mark, then writes the report to the destination given by STUP_REPORT_ENV.
+ *
+ * @param None
+ * @return Time from process creation to the first tick (us)
+ */
+U32 stup_report(void);
+
+/*@}*/
+/*@}*/
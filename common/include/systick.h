@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <unistd.h>
 #include "ev3dev-arm-ctypes.h"
 
 /** @addtogroup common */
@@ -23,7 +24,8 @@
 /** @defgroup systick System Tick
  *
  * The System Tick library generates a monotically increasing value to act as system tick.
- * Each tick is 1 microsecond.
+ * Each tick is 1 microsecond. The tick count wraps around at 2^32 (about 71.6 minutes), so deadlines
+ * must be compared using tick_is_due() (or the difference of two ticks), not directly.
  *
  */
 /*@{*/
@@ -46,6 +48,50 @@ void tick_init(void);
  */
 U32 tick_systick(void);
 
+/** Check if a deadline has been reached
+ *
+ * @param now Current systick.
+ * @param when Deadline systick (less than 2^31 ticks away from now).
+ * @return Flag - the deadline has been reached.
+ *
+ */
+static inline bool tick_is_due(U32 now, U32 when) {
+	return ((S32) (now - when) >= 0);
+}
+
+/** Check if a periodic deadline has been reached, or is out of range
+ *
+ * A deadline more than one period ahead of now is treated as due, so that the caller samples now and
+ * reschedules from now. Since the tick count wraps cleanly, this only happens for a deadline which was
+ * never set (zero-initialised) before the first sample.
+ *
+ * @param now Current systick.
+ * @param when Deadline systick.
+ * @param period Scheduling period (ticks).
+ * @return Flag - the deadline has been reached or is out of range.
+ *
+ */
+static inline bool tick_is_due_within(U32 now, U32 when, U32 period) {
+	return tick_is_due(now, when) || ((when - now) > period);
+}
+
+/** Sleep until a deadline, for at most max_us
+ *
+ * Returns immediately if the deadline has been reached. The sleep is bounded so that background threads
+ * check their running flag (and any deadline change) at least every max_us.
+ *
+ * @param when Deadline systick.
+ * @param max_us Maximum sleep time (us).
+ * @return None
+ *
+ */
+static inline void tick_sleep_until(U32 when, U32 max_us) {
+	U32 now = tick_systick();
+
+	if (!tick_is_due(now, when))
+		usleep(((when - now) < max_us) ? (when - now) : max_us);
+}
+
 /*@}*/
 /*@}*/
 
@@ -0,0 +1,109 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   telemetry.h
+ *  \brief  ARM-BBR UDP telemetry exporter function prototypes
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#pragma once
+
+#include "ev3dev-arm-ctypes.h"
+#include <stdint.h>
+
+/** @addtogroup common */
+/*@{*/
+
+/** @defgroup telemetry UDP Telemetry
+ *
+ * The Telemetry library streams per-tick robot state to a host over UDP.
+ *
+ * Each event loop tick, the program stores up to TLM_MAX_FIELDS signed 32-bit values
+ * using tlm_set() and then calls tlm_commit() (or passes an array to tlm_submit()).
+ * Frames are queued in a lock-free ring buffer and sent by a background thread,
+ * TLM_FRAMES_PER_DATAGRAM frames per datagram, several datagrams per sendmmsg() call.
+ *
+ * The control loop never blocks: if the ring buffer is full or the socket cannot
+ * accept more data, frames are dropped and counted.
+ *
+ * Datagram format (little endian):
+ *
+ *     TLM_HEADER, followed by num_frames * (U32 frame seqno, U32 systick, S32 fields[num_fields])
+ *
+ * scripts/tlm-receiver.py is the host-side receiver and plotting tool.
+ */
+/*@{*/
+
+#define TLM_MAX_FIELDS           16			///< Maximum number of fields per frame
+#define TLM_FRAMES_PER_DATAGRAM   8			///< Frames batched into each datagram
+#define TLM_DATAGRAMS_PER_SEND    4			///< Datagrams sent per sendmmsg() call
+#define TLM_RING_SIZE            64			///< Frame ring buffer size (power of 2)
+
+#define TLM_DEFAULT_PORT       5555			///< Default UDP port
+#define TLM_HOST_ENV           "BBR_TELEMETRY_HOST"	///< Environment variable for the default host
+#define TLM_DEFAULT_HOST       "127.0.0.1"	///< Default host if TLM_HOST_ENV is not defined
+
+#define TLM_MAGIC            0x4D4C		///< "LM" (little endian)
+#define TLM_VERSION               1
+
+/** Telemetry datagram header (12 bytes) */
+typedef struct __attribute__((packed)) {
+	uint16_t magic;				///< TLM_MAGIC
+	uint8_t  version;			///< TLM_VERSION
+	uint8_t  num_fields;		///< Fields per frame
+	uint16_t num_frames;		///< Frames in this datagram
+	uint16_t datagram_seqno;	///< Datagram sequence number (wraps)
+	uint32_t dropped;			///< Total frames dropped so far
+} TLM_HEADER;
+
+/** Initialize telemetry and start the sender thread
+ *
+ * @param host: Destination IPv4 address string (NULL uses TLM_HOST_ENV or TLM_DEFAULT_HOST)
+ * @param port: Destination UDP port (0 uses TLM_DEFAULT_PORT)
+ * @param num_fields: Number of fields per frame [1..TLM_MAX_FIELDS]
+ * @return TRUE if telemetry is active
+ */
+bool tlm_init(const char *host, U32 port, U32 num_fields);
+
+/** Store a field value for the current frame
+ *
+ * @param index: Field index [0..num_fields-1]
+ * @param value: Field value
+ * @return None
+ */
+void tlm_set(U32 index, S32 value);
+
+/** Queue the current frame (set using tlm_set()) for sending
+ *
+ * @param None
+ * @return TRUE if queued, FALSE if dropped (or telemetry is inactive)
+ */
+bool tlm_commit(void);
+
+/** Queue a frame for sending
+ *
+ * @param values: Array of num_fields values
+ * @return TRUE if queued, FALSE if dropped (or telemetry is inactive)
+ */
+bool tlm_submit(const S32 *values);
+
+/** Get the number of frames dropped
+ *
+ * @param None
+ * @return Dropped frame count
+ */
+U32 tlm_dropped(void);
+
+/** Flush queued frames and stop the sender thread
+ *
+ * @param None
+ * @return None
+ */
+void tlm_exit(void);
+
+/*@}*/
+/*@}*/
@@ -0,0 +1,86 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   iotrace-dump.c
+ *  \brief  ARM-BBR sysfs I/O trace dump utility
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ *
+ *  Usage: iotrace-dump <trace file>
+ *
+ *  Prints one line per trace record:  <time (us)> <type> <path> <payload>
+ */
+
+#include "iotrace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *type_name(uint8_t type)
+{
+	switch (type) {
+	case IOTR_PATH:      return "PATH";
+	case IOTR_READ:      return "READ";
+	case IOTR_WRITE:     return "WRITE";
+	case IOTR_OPEN_FAIL: return "FAIL";
+	case IOTR_OPENDIR:   return "OPENDIR";
+	case IOTR_DIRENT:    return "DIRENT";
+	case IOTR_DIREND:    return "DIREND";
+	case IOTR_TICK:      return "TICK";
+	default:             return "?";
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	static char *paths[IOTRACE_MAX_PATHS];
+	static unsigned char payload[IOTRACE_MAX_DATA + 1];
+	IOTRACE_HEADER hdr;
+	IOTRACE_RECORD rec;
+	FILE *f;
+	unsigned long numrecs = 0;
+	uint32_t cpu_us;
+
+	if (argc != 2) {
+		fprintf(stderr, "usage: %s <trace file>\n", argv[0]);
+		return 1;
+	}
+	if ((f = fopen(argv[1], "rb")) == NULL || fread(&hdr, sizeof(hdr), 1, f) != 1
+		|| memcmp(hdr.magic, IOTRACE_MAGIC, 4) != 0) {
+		fprintf(stderr, "%s: not an iotrace file\n", argv[1]);
+		return 1;
+	}
+	printf("# version %u, started %lu.%09lu\n", hdr.version,
+		   (unsigned long) hdr.start_sec, (unsigned long) hdr.start_nsec);
+
+	while (fread(&rec, sizeof(rec), 1, f) == 1) {
+		if (rec.length > IOTRACE_MAX_DATA || fread(payload, 1, rec.length, f) != rec.length)
+			break;
+		payload[rec.length] = '\0';
+		numrecs++;
+
+		if (rec.type == IOTR_PATH) {
+			if (rec.path_id < IOTRACE_MAX_PATHS)
+				paths[rec.path_id] = strdup((char *) payload);
+			continue;
+		}
+		printf("%10lu %-7s ", (unsigned long) rec.time_us, type_name(rec.type));
+		if (rec.type == IOTR_TICK) {
+			memcpy(&cpu_us, payload, sizeof(cpu_us));
+			printf("cpu %lu us\n", (unsigned long) cpu_us);
+			continue;
+		}
+		printf("%s", (rec.path_id < IOTRACE_MAX_PATHS && paths[rec.path_id]) ? paths[rec.path_id] : "?");
+		if (rec.type == IOTR_OPEN_FAIL)
+			printf(" (%c) errno %u", rec.length ? payload[0] : '?', rec.flags);
+		else if (rec.length)
+			printf(" \"%.*s\"", (int) strcspn((char *) payload, "\n"), payload);
+		printf("\n");
+	}
+	printf("# %lu records\n", numrecs);
+	fclose(f);
+	return 0;
+}
@@ -0,0 +1,864 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   iotrace.c
+ *  \brief  ARM-BBR sysfs I/O record-and-replay shim (LD_PRELOAD)
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ *
+ *  ev3dev-c accesses device attributes using fopen() / fread() / fwrite() / fclose()
+ *  and enumerates devices using opendir() / readdir(). Streams opened on traced paths
+ *  are replaced by fopencookie() streams so that the data can be captured (record)
+ *  or supplied (replay) at the granularity of one open-close session.
+ */
+
+#define _GNU_SOURCE
+
+#include "iotrace.h"
+#include <dlfcn.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef enum {
+	MODE_PASSTHRU,
+	MODE_RECORD,
+	MODE_REPLAY
+} IOTRACE_MODE;
+
+#define PATH_HASH_SIZE   (2 * IOTRACE_MAX_PATHS)		// Must be power of 2
+#define RECBUF_SIZE      (64 * 1024)
+#define MAX_FAKE_DIRS    8
+#define MAX_REPORTED     10
+#define NSEC_PER_USEC    1000LL
+#define NSEC_PER_SEC     1000000000LL
+
+/* Real library routines */
+static FILE *(*real_fopen)(const char *, const char *);
+static FILE *(*real_fopen64)(const char *, const char *);
+static DIR *(*real_opendir)(const char *);
+static struct dirent *(*real_readdir)(DIR *);
+static struct dirent64 *(*real_readdir64)(DIR *);
+static int (*real_closedir)(DIR *);
+static int (*real_clock_gettime)(clockid_t, struct timespec *);
+static int (*real_usleep)(useconds_t);
+static int (*real_nanosleep)(const struct timespec *, struct timespec *);
+
+static pthread_mutex_t iotrace_lock = PTHREAD_MUTEX_INITIALIZER;
+static IOTRACE_MODE mode = MODE_PASSTHRU;
+static const char *trace_filename = IOTRACE_DEFAULT_FILE;
+static long long tick_threshold_ns = IOTRACE_DEFAULT_TICK_US * NSEC_PER_USEC;
+static double replay_speed = 0.0;
+
+static struct timespec mono_start;				// Real CLOCK_MONOTONIC at start
+static long long cpu_last_tick_ns;				// CLOCK_PROCESS_CPUTIME_ID at end of previous tick
+
+/* Path table */
+static char *paths[IOTRACE_MAX_PATHS];
+static int num_paths;
+static short path_hash[PATH_HASH_SIZE];			// path_id + 1, 0 is empty
+
+/* Record state */
+static int trace_fd = -1;
+static unsigned char recbuf[RECBUF_SIZE];
+static size_t recbuf_len;
+
+/* Record state for tracked directory streams */
+static DIR *rec_dirs[MAX_FAKE_DIRS];
+static int rec_dir_path[MAX_FAKE_DIRS];
+
+/* Replay state */
+typedef struct {
+	unsigned int *recs;			// Indices of records in session order
+	unsigned int count;
+	unsigned int next;
+} IOTRACE_QUEUE;
+
+typedef struct {
+	int path_id;
+	unsigned int cursor;		// Index of next record to examine
+	struct dirent ent;
+	struct dirent64 ent64;
+} IOTRACE_FAKEDIR;
+
+static IOTRACE_HEADER replay_header;
+static unsigned char *replay_data;
+static IOTRACE_RECORD **replay_recs;
+static unsigned int replay_numrecs;
+static IOTRACE_QUEUE read_queue[IOTRACE_MAX_PATHS];
+static IOTRACE_QUEUE write_queue[IOTRACE_MAX_PATHS];
+static IOTRACE_FAKEDIR *fake_dirs[MAX_FAKE_DIRS];
+static long long sleep_skipped_ns;
+
+/* Replay statistics */
+static unsigned long reads_served, writes_checked, write_mismatches, writes_unexpected;
+static unsigned long rec_ticks, play_ticks;
+static unsigned long long rec_tick_cpu_sum, play_tick_cpu_sum;
+static unsigned long rec_tick_cpu_max, play_tick_cpu_max;
+static int report_done;
+
+/* Session cookie for traced streams */
+typedef struct {
+	FILE *real;					// Underlying stream (record mode)
+	int path_id;
+	int writing;
+	uint32_t time_us;			// Session start
+	const unsigned char *data;	// Recorded data (replay mode)
+	size_t datalen;
+	size_t pos;
+	const IOTRACE_RECORD *expected;		// Recorded write (replay mode)
+	size_t len;
+	unsigned char buf[IOTRACE_MAX_DATA];
+} IOTRACE_SESSION;
+
+/* Internal Routines */
+
+static long long ts_to_ns(const struct timespec *ts)
+{
+	return (long long) ts->tv_sec * NSEC_PER_SEC + ts->tv_nsec;
+}
+
+static uint32_t elapsed_us(void)
+{
+	struct timespec now;
+
+	real_clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint32_t) ((ts_to_ns(&now) - ts_to_ns(&mono_start)) / NSEC_PER_USEC);
+}
+
+static unsigned int path_hashval(const char *path)
+{
+	unsigned int h = 5381;
+
+	while (*path)
+		h = (h * 33) ^ (unsigned char) *path++;
+	return h & (PATH_HASH_SIZE - 1);
+}
+
+static void record_flush(void)
+{
+	size_t done = 0;
+	ssize_t n;
+
+	while (done < recbuf_len) {
+		n = write(trace_fd, recbuf + done, recbuf_len - done);
+		if (n <= 0)
+			break;
+		done += n;
+	}
+	recbuf_len = 0;
+}
+
+static void record_emit(uint8_t type, int path_id, uint8_t flags, uint32_t time_us,
+						const void *payload, size_t length)
+{
+	IOTRACE_RECORD rec;
+
+	if (length > IOTRACE_MAX_DATA)
+		length = IOTRACE_MAX_DATA;
+	if (recbuf_len + sizeof(rec) + length > RECBUF_SIZE)
+		record_flush();
+
+	rec.time_us = time_us;
+	rec.path_id = (uint16_t) path_id;
+	rec.type = type;
+	rec.flags = flags;
+	rec.length = (uint16_t) length;
+	memcpy(recbuf + recbuf_len, &rec, sizeof(rec));
+	recbuf_len += sizeof(rec);
+	if (length) {
+		memcpy(recbuf + recbuf_len, payload, length);
+		recbuf_len += length;
+	}
+}
+
+/* Find path_id for path, adding it to the table (and trace) if create is set */
+static int path_lookup(const char *path, int create)
+{
+	unsigned int h = path_hashval(path);
+	int id;
+
+	while (path_hash[h]) {
+		id = path_hash[h] - 1;
+		if (strcmp(paths[id], path) == 0)
+			return id;
+		h = (h + 1) & (PATH_HASH_SIZE - 1);
+	}
+	if (!create || num_paths >= IOTRACE_MAX_PATHS)
+		return -1;
+
+	id = num_paths++;
+	paths[id] = strdup(path);
+	path_hash[h] = (short) (id + 1);
+	if (mode == MODE_RECORD)
+		record_emit(IOTR_PATH, id, 0, elapsed_us(), path, strlen(path));
+	return id;
+}
+
+static void report_tick_cpu(const char *label, unsigned long ticks,
+							unsigned long long sum, unsigned long max)
+{
+	fprintf(stderr, "iotrace:   %-8s ticks %6lu  cpu mean %6llu us  max %6lu us\n",
+			label, ticks, ticks ? sum / ticks : 0ULL, max);
+}
+
+static void replay_report(void)
+{
+	unsigned long missing = 0;
+	int i;
+
+	if (report_done)
+		return;
+	report_done = 1;
+
+	for (i = 0; i < num_paths; i++)
+		missing += write_queue[i].count - write_queue[i].next;
+
+	fprintf(stderr, "iotrace: replay of %s done\n", trace_filename);
+	fprintf(stderr, "iotrace:   reads served %lu, writes checked %lu\n", reads_served, writes_checked);
+	fprintf(stderr, "iotrace:   write divergence: %lu mismatched, %lu unexpected, %lu missing\n",
+			write_mismatches, writes_unexpected, missing);
+	report_tick_cpu("recorded", rec_ticks, rec_tick_cpu_sum, rec_tick_cpu_max);
+	report_tick_cpu("replay", play_ticks, play_tick_cpu_sum, play_tick_cpu_max);
+}
+
+static void replay_finish(void)
+{
+	replay_report();
+	pthread_mutex_unlock(&iotrace_lock);
+	exit(write_mismatches || writes_unexpected ? 2 : 0);
+}
+
+static void report_write_divergence(const char *what, int path_id, const unsigned char *data, size_t len)
+{
+	if (write_mismatches + writes_unexpected > MAX_REPORTED)
+		return;
+	fprintf(stderr, "iotrace: %s write to %s: \"%.*s\"\n", what, paths[path_id], (int) len, data);
+}
+
+static void queue_add(IOTRACE_QUEUE *q, unsigned int recno)
+{
+	if ((q->count & (q->count - 1)) == 0) {
+		// Grow at powers of 2
+		unsigned int *recs = realloc(q->recs, (q->count ? 2 * q->count : 4) * sizeof(*recs));
+		if (recs == NULL)
+			return;
+		q->recs = recs;
+	}
+	q->recs[q->count++] = recno;
+}
+
+static int replay_load(void)
+{
+	struct stat st;
+	size_t offset, maxrecs;
+	int fd = open(trace_filename, O_RDONLY);
+
+	if (fd < 0)
+		return -1;
+	if (fstat(fd, &st) < 0 || (size_t) st.st_size < sizeof(IOTRACE_HEADER)) {
+		close(fd);
+		return -1;
+	}
+	replay_data = malloc(st.st_size);
+	if (replay_data == NULL || read(fd, replay_data, st.st_size) != st.st_size) {
+		close(fd);
+		return -1;
+	}
+	close(fd);
+
+	memcpy(&replay_header, replay_data, sizeof(replay_header));
+	if (memcmp(replay_header.magic, IOTRACE_MAGIC, 4) != 0 || replay_header.version != IOTRACE_VERSION)
+		return -1;
+
+	maxrecs = st.st_size / sizeof(IOTRACE_RECORD);
+	replay_recs = malloc(maxrecs * sizeof(*replay_recs));
+	if (replay_recs == NULL)
+		return -1;
+
+	for (offset = sizeof(IOTRACE_HEADER); offset + sizeof(IOTRACE_RECORD) <= (size_t) st.st_size; ) {
+		IOTRACE_RECORD *rec = (IOTRACE_RECORD *) (replay_data + offset);
+		unsigned char *payload = replay_data + offset + sizeof(IOTRACE_RECORD);
+		unsigned int recno = replay_numrecs++;
+
+		if (rec->length > IOTRACE_MAX_DATA)
+			return -1;							// Corrupt trace, never recorded
+		if (offset + sizeof(IOTRACE_RECORD) + rec->length > (size_t) st.st_size)
+			break;								// Truncated trace
+		replay_recs[recno] = rec;
+		offset += sizeof(IOTRACE_RECORD) + rec->length;
+
+		if (rec->type == IOTR_PATH) {
+			char path[IOTRACE_MAX_DATA + 1];
+
+			memcpy(path, payload, rec->length);
+			path[rec->length] = '\0';
+			if (path_lookup(path, 1) != rec->path_id)
+				return -1;						// Path table out of sync
+			continue;
+		}
+		if (rec->path_id >= num_paths && rec->type != IOTR_TICK)
+			return -1;
+
+		switch (rec->type) {
+		case IOTR_READ:
+		case IOTR_OPENDIR:
+			queue_add(&read_queue[rec->path_id], recno);
+			break;
+		case IOTR_WRITE:
+			queue_add(&write_queue[rec->path_id], recno);
+			break;
+		case IOTR_OPEN_FAIL:
+			if (rec->length && payload[0] == 'w')
+				queue_add(&write_queue[rec->path_id], recno);
+			else
+				queue_add(&read_queue[rec->path_id], recno);
+			break;
+		case IOTR_TICK:
+			if (rec->length >= sizeof(uint32_t)) {
+				uint32_t cpu_us;
+
+				memcpy(&cpu_us, payload, sizeof(cpu_us));
+				rec_ticks++;
+				rec_tick_cpu_sum += cpu_us;
+				if (cpu_us > rec_tick_cpu_max)
+					rec_tick_cpu_max = cpu_us;
+			}
+			break;
+		default:
+			break;
+		}
+	}
+	return 0;
+}
+
+static const IOTRACE_RECORD *queue_next(IOTRACE_QUEUE *q)
+{
+	if (q->next >= q->count)
+		return NULL;
+	return replay_recs[q->recs[q->next++]];
+}
+
+static void account_tick(void)
+{
+	struct timespec now;
+	long long cpu_ns;
+	uint32_t cpu_us;
+
+	real_clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+	cpu_ns = ts_to_ns(&now);
+	cpu_us = (uint32_t) ((cpu_ns - cpu_last_tick_ns) / NSEC_PER_USEC);
+	cpu_last_tick_ns = cpu_ns;
+
+	pthread_mutex_lock(&iotrace_lock);
+	if (mode == MODE_RECORD) {
+		record_emit(IOTR_TICK, 0, 0, elapsed_us(), &cpu_us, sizeof(cpu_us));
+	} else {
+		play_ticks++;
+		play_tick_cpu_sum += cpu_us;
+		if (cpu_us > play_tick_cpu_max)
+			play_tick_cpu_max = cpu_us;
+	}
+	pthread_mutex_unlock(&iotrace_lock);
+}
+
+/* Common sleep handling, returns TRUE if the real sleep should be skipped */
+static int virtual_sleep(long long duration_ns, long long *real_ns)
+{
+	*real_ns = duration_ns;
+	if (mode == MODE_PASSTHRU)
+		return 0;
+
+	if (duration_ns >= tick_threshold_ns)
+		account_tick();
+	if (mode != MODE_REPLAY)
+		return 0;
+
+	if (replay_speed <= 0.0) {
+		__atomic_add_fetch(&sleep_skipped_ns, duration_ns, __ATOMIC_RELAXED);
+		return 1;
+	}
+	*real_ns = (long long) (duration_ns / replay_speed);
+	__atomic_add_fetch(&sleep_skipped_ns, duration_ns - *real_ns, __ATOMIC_RELAXED);
+	return 0;
+}
+
+/* Cookie I/O routines (record mode) */
+
+static ssize_t rec_cookie_read(void *cookie, char *buf, size_t size)
+{
+	IOTRACE_SESSION *s = cookie;
+	size_t n = fread(buf, 1, size, s->real);
+	size_t keep = (n < sizeof(s->buf) - s->len) ? n : sizeof(s->buf) - s->len;
+
+	memcpy(s->buf + s->len, buf, keep);
+	s->len += keep;
+	return n;
+}
+
+static ssize_t rec_cookie_write(void *cookie, const char *buf, size_t size)
+{
+	IOTRACE_SESSION *s = cookie;
+	size_t n = fwrite(buf, 1, size, s->real);
+	size_t keep = (n < sizeof(s->buf) - s->len) ? n : sizeof(s->buf) - s->len;
+
+	memcpy(s->buf + s->len, buf, keep);
+	s->len += keep;
+	return (n == 0 && size) ? -1 : (ssize_t) n;
+}
+
+static int rec_cookie_close(void *cookie)
+{
+	IOTRACE_SESSION *s = cookie;
+	int retval = fclose(s->real);
+
+	pthread_mutex_lock(&iotrace_lock);
+	record_emit(s->writing ? IOTR_WRITE : IOTR_READ, s->path_id, 0, s->time_us, s->buf, s->len);
+	pthread_mutex_unlock(&iotrace_lock);
+	free(s);
+	return retval;
+}
+
+/* Cookie I/O routines (replay mode) */
+
+static ssize_t play_cookie_read(void *cookie, char *buf, size_t size)
+{
+	IOTRACE_SESSION *s = cookie;
+	size_t n = s->datalen - s->pos;
+
+	if (n > size)
+		n = size;
+	memcpy(buf, s->data + s->pos, n);
+	s->pos += n;
+	return n;
+}
+
+static ssize_t play_cookie_write(void *cookie, const char *buf, size_t size)
+{
+	IOTRACE_SESSION *s = cookie;
+	size_t keep = (size < sizeof(s->buf) - s->len) ? size : sizeof(s->buf) - s->len;
+
+	memcpy(s->buf + s->len, buf, keep);
+	s->len += keep;
+	return size;
+}
+
+static int play_cookie_close(void *cookie)
+{
+	IOTRACE_SESSION *s = cookie;
+
+	if (s->writing) {
+		pthread_mutex_lock(&iotrace_lock);
+		writes_checked++;
+		if (s->expected == NULL) {
+			writes_unexpected++;
+			report_write_divergence("unexpected", s->path_id, s->buf, s->len);
+		} else if (s->expected->type != IOTR_WRITE || s->expected->length != s->len
+				   || memcmp((const unsigned char *) (s->expected + 1), s->buf, s->len) != 0) {
+			write_mismatches++;
+			report_write_divergence("mismatched", s->path_id, s->buf, s->len);
+		}
+		pthread_mutex_unlock(&iotrace_lock);
+	}
+	free(s);
+	return 0;
+}
+
+static FILE *traced_fopen(FILE *(*realfn)(const char *, const char *), const char *path, const char *fmode)
+{
+	static const cookie_io_functions_t rec_funcs = {
+		rec_cookie_read, rec_cookie_write, NULL, rec_cookie_close
+	};
+	static const cookie_io_functions_t play_funcs = {
+		play_cookie_read, play_cookie_write, NULL, play_cookie_close
+	};
+	IOTRACE_SESSION *s;
+	FILE *real;
+	int writing = (strchr(fmode, 'w') != NULL) || (strchr(fmode, 'a') != NULL);
+	int path_id;
+
+	if (mode == MODE_PASSTHRU || !iotrace_is_traced_path(path))
+		return realfn(path, fmode);
+
+	s = calloc(1, sizeof(*s));
+	if (s == NULL)
+		return realfn(path, fmode);
+	s->writing = writing;
+
+	if (mode == MODE_RECORD) {
+		s->time_us = elapsed_us();
+		real = realfn(path, fmode);
+		pthread_mutex_lock(&iotrace_lock);
+		s->path_id = path_lookup(path, 1);
+		if (real == NULL) {
+			int err = errno;
+			char m = writing ? 'w' : 'r';
+
+			if (s->path_id >= 0)
+				record_emit(IOTR_OPEN_FAIL, s->path_id, (uint8_t) err, s->time_us, &m, 1);
+			pthread_mutex_unlock(&iotrace_lock);
+			free(s);
+			errno = err;
+			return NULL;
+		}
+		pthread_mutex_unlock(&iotrace_lock);
+		if (s->path_id < 0) {
+			free(s);
+			return real;						// Path table full, not traced
+		}
+		setvbuf(real, NULL, _IONBF, 0);			// Outer stream does the buffering
+		s->real = real;
+		return fopencookie(s, fmode, rec_funcs);
+	}
+
+	// MODE_REPLAY
+	pthread_mutex_lock(&iotrace_lock);
+	path_id = path_lookup(path, 0);
+	if (path_id < 0) {
+		pthread_mutex_unlock(&iotrace_lock);
+		free(s);
+		errno = ENOENT;							// Never seen during recording
+		return NULL;
+	}
+	s->path_id = path_id;
+
+	if (writing) {
+		s->expected = queue_next(&write_queue[path_id]);
+		if (s->expected && s->expected->type == IOTR_OPEN_FAIL) {
+			errno = s->expected->flags;
+			pthread_mutex_unlock(&iotrace_lock);
+			free(s);
+			return NULL;
+		}
+	} else {
+		const IOTRACE_RECORD *rec = queue_next(&read_queue[path_id]);
+
+		if (rec == NULL && read_queue[path_id].count)
+			replay_finish();					// Trace exhausted
+		if (rec == NULL || rec->type == IOTR_OPEN_FAIL) {
+			errno = rec ? rec->flags : ENOENT;
+			pthread_mutex_unlock(&iotrace_lock);
+			free(s);
+			return NULL;
+		}
+		s->data = (const unsigned char *) (rec + 1);
+		s->datalen = rec->length;
+		reads_served++;
+	}
+	pthread_mutex_unlock(&iotrace_lock);
+	return fopencookie(s, fmode, play_funcs);
+}
+
+static IOTRACE_FAKEDIR *find_fake_dir(DIR *dirp)
+{
+	int i;
+
+	for (i = 0; i < MAX_FAKE_DIRS; i++)
+		if (fake_dirs[i] && (DIR *) fake_dirs[i] == dirp)
+			return fake_dirs[i];
+	return NULL;
+}
+
+/* Return next directory entry name for a fake directory stream, NULL at end */
+static const char *fake_readdir_name(IOTRACE_FAKEDIR *fd, size_t *len)
+{
+	while (fd->cursor < replay_numrecs) {
+		const IOTRACE_RECORD *rec = replay_recs[fd->cursor++];
+
+		if (rec->path_id != fd->path_id || rec->type == IOTR_PATH || rec->type == IOTR_TICK)
+			continue;
+		if (rec->type == IOTR_DIRENT) {
+			*len = rec->length;
+			return (const char *) (rec + 1);
+		}
+		if (rec->type == IOTR_DIREND || rec->type == IOTR_OPENDIR)
+			break;
+	}
+	fd->cursor = replay_numrecs;
+	return NULL;
+}
+
+static void record_dirent(DIR *dirp, const char *name)
+{
+	int i;
+
+	pthread_mutex_lock(&iotrace_lock);
+	for (i = 0; i < MAX_FAKE_DIRS; i++) {
+		if (rec_dirs[i] == dirp) {
+			if (name)
+				record_emit(IOTR_DIRENT, rec_dir_path[i], 0, elapsed_us(), name, strlen(name));
+			else
+				record_emit(IOTR_DIREND, rec_dir_path[i], 0, elapsed_us(), NULL, 0);
+			break;
+		}
+	}
+	pthread_mutex_unlock(&iotrace_lock);
+}
+
+__attribute__((constructor))
+static void iotrace_init(void)
+{
+	const char *env;
+
+	real_fopen = dlsym(RTLD_NEXT, "fopen");
+	real_fopen64 = dlsym(RTLD_NEXT, "fopen64");
+	real_opendir = dlsym(RTLD_NEXT, "opendir");
+	real_readdir = dlsym(RTLD_NEXT, "readdir");
+	real_readdir64 = dlsym(RTLD_NEXT, "readdir64");
+	real_closedir = dlsym(RTLD_NEXT, "closedir");
+	real_clock_gettime = dlsym(RTLD_NEXT, "clock_gettime");
+	real_usleep = dlsym(RTLD_NEXT, "usleep");
+	real_nanosleep = dlsym(RTLD_NEXT, "nanosleep");
+	if (real_fopen64 == NULL)
+		real_fopen64 = real_fopen;
+
+	real_clock_gettime(CLOCK_MONOTONIC, &mono_start);
+
+	if ((env = getenv(IOTRACE_ENV_FILE)) && *env)
+		trace_filename = env;
+	if ((env = getenv(IOTRACE_ENV_TICK_US)) && *env)
+		tick_threshold_ns = atol(env) * NSEC_PER_USEC;
+	if ((env = getenv(IOTRACE_ENV_SPEED)) && *env)
+		replay_speed = atof(env);
+
+	env = getenv(IOTRACE_ENV_MODE);
+	if (env && strcmp(env, "record") == 0) {
+		IOTRACE_HEADER hdr;
+		struct timespec now;
+
+		trace_fd = open(trace_filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (trace_fd < 0) {
+			fprintf(stderr, "iotrace: cannot create %s\n", trace_filename);
+			return;
+		}
+		real_clock_gettime(CLOCK_REALTIME, &now);
+		memcpy(hdr.magic, IOTRACE_MAGIC, 4);
+		hdr.version = IOTRACE_VERSION;
+		hdr.reserved = 0;
+		hdr.start_sec = (uint32_t) now.tv_sec;
+		hdr.start_nsec = (uint32_t) now.tv_nsec;
+		memcpy(recbuf, &hdr, sizeof(hdr));
+		recbuf_len = sizeof(hdr);
+		mode = MODE_RECORD;
+	} else if (env && strcmp(env, "replay") == 0) {
+		mode = MODE_REPLAY;						// path_lookup() must not emit records
+		if (replay_load() < 0) {
+			fprintf(stderr, "iotrace: cannot load %s\n", trace_filename);
+			exit(1);
+		}
+	}
+}
+
+__attribute__((destructor))
+static void iotrace_fini(void)
+{
+	pthread_mutex_lock(&iotrace_lock);
+	if (mode == MODE_RECORD) {
+		record_flush();
+		close(trace_fd);
+		trace_fd = -1;
+		mode = MODE_PASSTHRU;
+	} else if (mode == MODE_REPLAY) {
+		replay_report();
+	}
+	pthread_mutex_unlock(&iotrace_lock);
+}
+
+/* Interposed Routines */
+
+FILE *fopen(const char *path, const char *fmode)
+{
+	return traced_fopen(real_fopen, path, fmode);
+}
+
+FILE *fopen64(const char *path, const char *fmode)
+{
+	return traced_fopen(real_fopen64, path, fmode);
+}
+
+DIR *opendir(const char *path)
+{
+	DIR *dirp;
+	int i, path_id;
+
+	if (mode == MODE_PASSTHRU || !iotrace_is_traced_path(path))
+		return real_opendir(path);
+
+	if (mode == MODE_RECORD) {
+		uint32_t t = elapsed_us();
+		int err;
+
+		dirp = real_opendir(path);
+		err = errno;
+		pthread_mutex_lock(&iotrace_lock);
+		path_id = path_lookup(path, 1);
+		if (path_id >= 0) {
+			if (dirp == NULL) {
+				char m = 'd';
+				record_emit(IOTR_OPEN_FAIL, path_id, (uint8_t) err, t, &m, 1);
+			} else {
+				for (i = 0; i < MAX_FAKE_DIRS; i++) {
+					if (rec_dirs[i] == NULL) {
+						rec_dirs[i] = dirp;
+						rec_dir_path[i] = path_id;
+						record_emit(IOTR_OPENDIR, path_id, 0, t, NULL, 0);
+						break;
+					}
+				}
+			}
+		}
+		pthread_mutex_unlock(&iotrace_lock);
+		errno = err;
+		return dirp;
+	}
+
+	// MODE_REPLAY
+	pthread_mutex_lock(&iotrace_lock);
+	path_id = path_lookup(path, 0);
+	if (path_id >= 0) {
+		const IOTRACE_RECORD *rec = queue_next(&read_queue[path_id]);
+
+		if (rec && rec->type == IOTR_OPENDIR) {
+			for (i = 0; i < MAX_FAKE_DIRS; i++) {
+				if (fake_dirs[i] == NULL) {
+					fake_dirs[i] = calloc(1, sizeof(IOTRACE_FAKEDIR));
+					if (fake_dirs[i] == NULL)
+						break;
+					fake_dirs[i]->path_id = path_id;
+					fake_dirs[i]->cursor = (unsigned int) (read_queue[path_id].recs[read_queue[path_id].next - 1] + 1);
+					pthread_mutex_unlock(&iotrace_lock);
+					return (DIR *) fake_dirs[i];
+				}
+			}
+		}
+		errno = rec ? rec->flags : ENOENT;
+	} else {
+		errno = ENOENT;
+	}
+	pthread_mutex_unlock(&iotrace_lock);
+	return NULL;
+}
+
+struct dirent *readdir(DIR *dirp)
+{
+	IOTRACE_FAKEDIR *fd;
+	struct dirent *ent;
+	const char *name;
+	size_t len;
+
+	if (mode == MODE_REPLAY && (fd = find_fake_dir(dirp))) {
+		if ((name = fake_readdir_name(fd, &len)) == NULL)
+			return NULL;
+		if (len >= sizeof(fd->ent.d_name))
+			len = sizeof(fd->ent.d_name) - 1;
+		memcpy(fd->ent.d_name, name, len);
+		fd->ent.d_name[len] = '\0';
+		fd->ent.d_type = DT_UNKNOWN;
+		return &fd->ent;
+	}
+
+	ent = real_readdir(dirp);
+	if (mode == MODE_RECORD)
+		record_dirent(dirp, ent ? ent->d_name : NULL);
+	return ent;
+}
+
+struct dirent64 *readdir64(DIR *dirp)
+{
+	IOTRACE_FAKEDIR *fd;
+	struct dirent64 *ent;
+	const char *name;
+	size_t len;
+
+	if (mode == MODE_REPLAY && (fd = find_fake_dir(dirp))) {
+		if ((name = fake_readdir_name(fd, &len)) == NULL)
+			return NULL;
+		if (len >= sizeof(fd->ent64.d_name))
+			len = sizeof(fd->ent64.d_name) - 1;
+		memcpy(fd->ent64.d_name, name, len);
+		fd->ent64.d_name[len] = '\0';
+		fd->ent64.d_type = DT_UNKNOWN;
+		return &fd->ent64;
+	}
+
+	ent = real_readdir64(dirp);
+	if (mode == MODE_RECORD)
+		record_dirent(dirp, ent ? ent->d_name : NULL);
+	return ent;
+}
+
+int closedir(DIR *dirp)
+{
+	int i;
+
+	pthread_mutex_lock(&iotrace_lock);
+	for (i = 0; i < MAX_FAKE_DIRS; i++) {
+		if (mode == MODE_REPLAY && fake_dirs[i] && (DIR *) fake_dirs[i] == dirp) {
+			free(fake_dirs[i]);
+			fake_dirs[i] = NULL;
+			pthread_mutex_unlock(&iotrace_lock);
+			return 0;
+		}
+		if (rec_dirs[i] == dirp)
+			rec_dirs[i] = NULL;
+	}
+	pthread_mutex_unlock(&iotrace_lock);
+	return real_closedir(dirp);
+}
+
+int clock_gettime(clockid_t clk, struct timespec *tp)
+{
+	int retval = real_clock_gettime(clk, tp);
+	long long ns;
+
+	if (mode != MODE_REPLAY || retval != 0)
+		return retval;
+
+	if (clk == CLOCK_REALTIME) {
+		// Realtime continues from the start of the recording
+		real_clock_gettime(CLOCK_MONOTONIC, tp);
+		ns = (long long) replay_header.start_sec * NSEC_PER_SEC + replay_header.start_nsec
+			+ ts_to_ns(tp) - ts_to_ns(&mono_start);
+	} else if (clk == CLOCK_MONOTONIC) {
+		ns = ts_to_ns(tp);
+	} else {
+		return retval;
+	}
+	ns += __atomic_load_n(&sleep_skipped_ns, __ATOMIC_RELAXED);
+	tp->tv_sec = ns / NSEC_PER_SEC;
+	tp->tv_nsec = ns % NSEC_PER_SEC;
+	return retval;
+}
+
+int usleep(useconds_t usec)
+{
+	long long real_ns;
+
+	if (virtual_sleep((long long) usec * NSEC_PER_USEC, &real_ns))
+		return 0;
+	return real_usleep((useconds_t) (real_ns / NSEC_PER_USEC));
+}
+
+int nanosleep(const struct timespec *req, struct timespec *rem)
+{
+	struct timespec ts;
+	long long real_ns;
+
+	if (req == NULL)
+		return real_nanosleep(req, rem);
+	if (virtual_sleep(ts_to_ns(req), &real_ns))
+		return 0;
+	ts.tv_sec = real_ns / NSEC_PER_SEC;
+	ts.tv_nsec = real_ns % NSEC_PER_SEC;
+	return real_nanosleep(&ts, rem);
+}
@@ -0,0 +1,107 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   iotrace.h
+ *  \brief  ARM-BBR sysfs I/O record-and-replay trace format
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/** @addtogroup common */
+/*@{*/
+
+/** @defgroup iotrace Sysfs I/O Record and Replay
+ *
+ * The I/O trace shim (libbbr-iotrace.so) is loaded using LD_PRELOAD in front of an ARM-BBR program.
+ * It interposes the stdio and directory routines used by ev3dev-c to access the
+ * ev3dev sysfs device classes, and is controlled by environment variables:
+ *
+ *     BBR_IOTRACE_MODE    record | replay
+ *     BBR_IOTRACE_FILE    trace file name (default: iotrace.bin)
+ *     BBR_IOTRACE_SPEED   replay speed: 0 = accelerated (sleeps are skipped), 1 = recorded time (default: 0)
+ *     BBR_IOTRACE_TICK_US sleeps of at least this duration end an event loop tick (default: 20000)
+ *
+ * In record mode every attribute read (value + timestamp) and every attribute write
+ * is appended to the trace, together with the CPU time used by each event loop tick.
+ *
+ * In replay mode attribute reads are served from the trace in recorded order
+ * (per attribute), writes are compared against the recorded writes, and the clock seen
+ * by the program is virtualized. When the trace is exhausted a divergence and
+ * per-tick CPU time report is written to stderr and the program exits.
+ *
+ * All multi-byte fields are stored little endian (native byte order of the EV3 and x86 hosts).
+ * Fixed size types are used since the trace is also read by host-side tools.
+ */
+/*@{*/
+
+#define IOTRACE_MAGIC       "BBRT"			///< Trace file magic
+#define IOTRACE_VERSION     1				///< Trace file format version
+
+#define IOTRACE_MAX_PATHS   1024			///< Maximum number of distinct sysfs paths in a trace
+#define IOTRACE_MAX_DATA    4096			///< Maximum payload length of a record
+
+#define IOTRACE_ENV_MODE    "BBR_IOTRACE_MODE"
+#define IOTRACE_ENV_FILE    "BBR_IOTRACE_FILE"
+#define IOTRACE_ENV_SPEED   "BBR_IOTRACE_SPEED"
+#define IOTRACE_ENV_TICK_US "BBR_IOTRACE_TICK_US"
+
+#define IOTRACE_DEFAULT_FILE    "iotrace.bin"
+#define IOTRACE_DEFAULT_TICK_US 20000
+
+/** Trace record types */
+typedef enum {
+	IOTR_PATH = 1,		///< Defines path_id, payload is the path string (not null-terminated)
+	IOTR_READ,			///< Attribute read session, payload is the data read
+	IOTR_WRITE,			///< Attribute write session, payload is the data written
+	IOTR_OPEN_FAIL,		///< fopen() or opendir() failed, flags contains errno, payload is the mode ('r', 'w' or 'd')
+	IOTR_OPENDIR,		///< Start of directory listing, followed by IOTR_DIRENT records for the same path_id
+	IOTR_DIRENT,		///< Directory entry, payload is the entry name
+	IOTR_DIREND,		///< End of directory listing
+	IOTR_TICK			///< End of event loop tick, payload is U32 CPU time used (us)
+} IOTRACE_TYPE;
+
+/** Trace file header */
+typedef struct __attribute__((packed)) {
+	char     magic[4];		///< IOTRACE_MAGIC
+	uint16_t version;		///< IOTRACE_VERSION
+	uint16_t reserved;
+	uint32_t start_sec;		///< CLOCK_REALTIME at start of recording
+	uint32_t start_nsec;
+} IOTRACE_HEADER;
+
+/** Trace record header, followed by length bytes of payload */
+typedef struct __attribute__((packed)) {
+	uint32_t time_us;		///< Time since start of recording
+	uint16_t path_id;		///< Index into path table
+	uint8_t  type;			///< IOTRACE_TYPE
+	uint8_t  flags;			///< Type specific flags
+	uint16_t length;		///< Payload length
+} IOTRACE_RECORD;
+
+/** Check if a path is traced (ev3dev device classes only)
+ *
+ * @param path: file or directory path
+ * @return Non-zero if traced
+ */
+static inline int iotrace_is_traced_path(const char *path)
+{
+	static const char prefix[] = "/sys/class/";
+	unsigned int i;
+
+	if (path == 0)
+		return 0;
+	for (i = 0; i < sizeof(prefix) - 1; i++)
+		if (path[i] != prefix[i])
+			return 0;
+	return 1;
+}
+
+/*@}*/
+/*@}*/
@@ -0,0 +1,238 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   bridge.c
+ *  \brief  ARM-BBR shared memory bridge to an external planner process routines
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "ev3dev-arm-ctypes.h"
+#include <stdbool.h>
+#include "bridge.h"
+#include "systick.h"
+
+#define BRG_READ_TRIES       100					// Snapshot read retries before giving up
+#define BRG_TICKS_PER_MS     (TICKS_PER_SECOND / 1000)
+
+/** Heartbeat watch of the other side */
+typedef struct {
+	U32 last_count;									// Heartbeat count last seen
+	U32 last_change;								// Systick when it last changed
+	bool seen;										// The heartbeat has changed at least once
+} BRG_WATCH;
+
+/* Robot side */
+static BRG_REGION *brg_region;
+static char brg_name[64];
+static BRG_STATE brg_staged;						// Private, copied by brg_publish()
+static BRG_WATCH brg_planner;
+static U32 brg_stale_ticks;
+
+/* Planner side */
+static BRG_REGION *brg_client_region;
+static BRG_WATCH brg_robot;
+
+/* Internal Routines */
+
+static void _watch_init(BRG_WATCH *watch, U32 count) {
+	watch->last_count = count;
+	watch->last_change = 0;
+	watch->seen = false;
+}
+
+static bool _watch_alive(BRG_WATCH *watch, U32 count, U32 stale_ticks) {
+	U32 now = tick_systick();
+
+	if (count != watch->last_count) {
+		watch->last_count = count;
+		watch->last_change = now;
+		watch->seen = true;
+	}
+	return watch->seen && ((now - watch->last_change) < stale_ticks);
+}
+
+static BRG_REGION *_map(const char *name, int flags) {
+	void *mem;
+	int fd;
+
+	if ((fd = shm_open(name, flags, 0666)) < 0)
+		return NULL;
+	if ((flags & O_CREAT) && (0 != ftruncate(fd, sizeof(BRG_REGION)))) {
+		close(fd);
+		return NULL;
+	}
+	mem = mmap(NULL, sizeof(BRG_REGION), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);										// The mapping keeps the object open
+	return (mem == MAP_FAILED) ? NULL : mem;
+}
+
+/* Public Routines (Robot) */
+
+bool brg_open(const char *name, U32 stale_ms) {
+	brg_close();
+	strncpy(brg_name, name ? name : BRG_DEFAULT_NAME, sizeof(brg_name) - 1);
+	if (!(brg_region = _map(brg_name, O_RDWR | O_CREAT)))
+		return false;
+
+	__atomic_store_n(&brg_region->magic, 0, __ATOMIC_RELEASE);		// Planners ignore it until initialized
+	memset((void *) &brg_region->version, 0, sizeof(BRG_REGION) - sizeof(brg_region->magic));
+	memset(&brg_staged, 0, sizeof(brg_staged));
+	brg_region->version = BRG_VERSION;
+	brg_region->size = sizeof(BRG_REGION);
+	__atomic_store_n(&brg_region->magic, BRG_MAGIC, __ATOMIC_RELEASE);
+
+	_watch_init(&brg_planner, 0);
+	brg_stale_ticks = stale_ms * BRG_TICKS_PER_MS;
+	return true;
+}
+
+void brg_close(void) {
+	if (!brg_region)
+		return;
+	__atomic_store_n(&brg_region->magic, 0, __ATOMIC_RELEASE);
+	munmap(brg_region, sizeof(BRG_REGION));
+	shm_unlink(brg_name);							// Connected planners keep their mapping until they close
+	brg_region = NULL;
+}
+
+void brg_set_sensor(U32 index, S32 value) {
+	if (index >= BRG_MAX_SENSORS)
+		return;
+	brg_staged.sensor[index] = value;
+	if (index >= brg_staged.num_sensors)
+		brg_staged.num_sensors = index + 1;
+}
+
+void brg_set_tacho(U32 index, S32 position, S32 speed) {
+	if (index >= BRG_MAX_TACHOS)
+		return;
+	brg_staged.tacho_pos[index] = position;
+	brg_staged.tacho_speed[index] = speed;
+	if (index >= brg_staged.num_tachos)
+		brg_staged.num_tachos = index + 1;
+}
+
+void brg_set_state(U32 state) {
+	brg_staged.robot_state = state;
+}
+
+void brg_publish(U32 systick) {
+	U32 seq;
+
+	if (!brg_region)
+		return;
+	brg_staged.systick = systick;
+	seq = brg_region->state_seq;
+	__atomic_store_n(&brg_region->state_seq, seq + 1, __ATOMIC_RELAXED);		// Odd: snapshot being written
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	memcpy(&brg_region->state, &brg_staged, sizeof(brg_staged));
+	__atomic_store_n(&brg_region->state_seq, seq + 2, __ATOMIC_RELEASE);
+	__atomic_add_fetch(&brg_region->robot_heartbeat, 1, __ATOMIC_RELEASE);
+}
+
+bool brg_receive(BRG_CMD *cmd) {
+	U32 head, tail;
+
+	if (!brg_region)
+		return false;
+	tail = brg_region->cmd_tail;
+	head = __atomic_load_n(&brg_region->cmd_head, __ATOMIC_ACQUIRE);
+	if (head == tail)
+		return false;
+	if ((head - tail) > BRG_CMD_SLOTS) {			// Corrupted by the planner, drop the pending commands
+		__atomic_store_n(&brg_region->cmd_tail, head, __ATOMIC_RELEASE);
+		return false;
+	}
+	*cmd = brg_region->cmd[tail & (BRG_CMD_SLOTS - 1)];
+	__atomic_store_n(&brg_region->cmd_tail, tail + 1, __ATOMIC_RELEASE);		// Slot can be reused
+	return true;
+}
+
+bool brg_peer_alive(void) {
+	if (!brg_region)
+		return false;
+	return _watch_alive(&brg_planner, __atomic_load_n(&brg_region->planner_heartbeat, __ATOMIC_ACQUIRE),
+						brg_stale_ticks);
+}
+
+/* Public Routines (Planner) */
+
+bool brg_client_open(const char *name) {
+	brg_client_close();
+	if (!(brg_client_region = _map(name ? name : BRG_DEFAULT_NAME, O_RDWR)))
+		return false;
+	if ((__atomic_load_n(&brg_client_region->magic, __ATOMIC_ACQUIRE) != BRG_MAGIC)
+		|| (brg_client_region->version != BRG_VERSION) || (brg_client_region->size != sizeof(BRG_REGION))) {
+		brg_client_close();
+		return false;
+	}
+	_watch_init(&brg_robot, __atomic_load_n(&brg_client_region->robot_heartbeat, __ATOMIC_ACQUIRE));
+	return true;
+}
+
+void brg_client_close(void) {
+	if (!brg_client_region)
+		return;
+	munmap(brg_client_region, sizeof(BRG_REGION));
+	brg_client_region = NULL;
+}
+
+bool brg_client_read_state(BRG_STATE *state) {
+	U32 seq, tries;
+
+	if (!brg_client_region)
+		return false;
+	for (tries = 0; tries < BRG_READ_TRIES; tries++) {
+		seq = __atomic_load_n(&brg_client_region->state_seq, __ATOMIC_ACQUIRE);
+		if (!(seq & 1)) {
+			memcpy(state, &brg_client_region->state, sizeof(*state));
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+			if (seq == __atomic_load_n(&brg_client_region->state_seq, __ATOMIC_RELAXED))
+				return true;
+		}
+		sched_yield();								// Let the robot finish publishing
+	}
+	return false;
+}
+
+bool brg_client_send(U32 type, const S32 *args) {
+	BRG_CMD *cmd;
+	U32 head, tail, i;
+
+	if (!brg_client_region)
+		return false;
+	head = brg_client_region->cmd_head;
+	tail = __atomic_load_n(&brg_client_region->cmd_tail, __ATOMIC_ACQUIRE);
+	if ((head - tail) >= BRG_CMD_SLOTS)
+		return false;								// Full, the robot has not caught up
+
+	cmd = &brg_client_region->cmd[head & (BRG_CMD_SLOTS - 1)];
+	cmd->type = type;
+	cmd->seqno = head;
+	for (i = 0; i < BRG_CMD_ARGS; i++)
+		cmd->arg[i] = args ? args[i] : 0;
+	__atomic_store_n(&brg_client_region->cmd_head, head + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+void brg_client_heartbeat(void) {
+	if (brg_client_region)
+		__atomic_add_fetch(&brg_client_region->planner_heartbeat, 1, __ATOMIC_RELEASE);
+}
+
+bool brg_client_robot_alive(U32 stale_ms) {
+	if (!brg_client_region || (__atomic_load_n(&brg_client_region->magic, __ATOMIC_ACQUIRE) != BRG_MAGIC))
+		return false;								// Closed by the robot
+	return _watch_alive(&brg_robot, __atomic_load_n(&brg_client_region->robot_heartbeat, __ATOMIC_ACQUIRE),
+						stale_ms * BRG_TICKS_PER_MS);
+}
@@ -0,0 +1,172 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   budget.c
+ *  \brief  ARM-BBR per-tick budget dispatcher routines
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "ev3dev-arm-ctypes.h"
+#include <stdbool.h>
+#include "budget.h"
+#include "systick.h"
+
+#define BDGT_FRAC_BITS    4					// Cost estimates are kept in 1/16 tick units
+#define BDGT_AVG_SHIFT    3					// Running average weight of each measurement (1/8)
+
+typedef struct {
+	U8 task_class;
+	U32 max_defer;
+	U32 avg;								// Average execution time (BDGT_FRAC_BITS)
+	U32 dev;								// Average absolute deviation (BDGT_FRAC_BITS)
+	U32 cost;								// Current estimate (ticks)
+	U32 decided_tick;						// Tick in which the task was last admitted or deferred
+	U32 deferrals;							// Consecutive deferrals
+	U32 start;								// Systick when the task was admitted
+} BDGT_TASK;
+
+static BDGT_TASK tasks[BDGT_MAX_TASKS];
+static U32 num_tasks;
+static BDGT_STATS class_stats[BDGT_NUM_CLASSES];
+
+static U32 tick_count;						// Current tick number (first tick is 1)
+static U32 tick_deadline;
+static U32 tick_overruns;
+
+static const char *class_names[BDGT_NUM_CLASSES] = { "critical", "normal", "best-effort" };
+
+/* Internal Routines */
+
+/* Estimated cost of the higher priority tasks not yet run or deferred in this tick */
+static U32 _pending_cost(U32 task_class) {
+	U32 i, pending = 0;
+
+	for (i = 0; i < num_tasks; i++) {
+		if ((tasks[i].task_class < task_class) && (tasks[i].decided_tick != tick_count))
+			pending += tasks[i].cost;
+	}
+	return pending;
+}
+
+static void _update_cost(BDGT_TASK *t, U32 elapsed) {
+	S32 diff = (S32) ((elapsed << BDGT_FRAC_BITS) - t->avg);
+	U32 absdiff = (diff < 0) ? -diff : diff;
+
+	t->avg += diff >> BDGT_AVG_SHIFT;
+	t->dev += ((S32) (absdiff - t->dev)) >> BDGT_AVG_SHIFT;
+	t->cost = (t->avg + 2 * t->dev) >> BDGT_FRAC_BITS;
+}
+
+/* Public Routines */
+
+S32 bdgt_register(U32 task_class, U32 initial_cost, U32 max_defer) {
+	BDGT_TASK *t;
+
+	if ((task_class >= BDGT_NUM_CLASSES) || (num_tasks >= BDGT_MAX_TASKS))
+		return -1;
+
+	t = &tasks[num_tasks];
+	t->task_class = task_class;
+	t->max_defer = max_defer;
+	t->avg = initial_cost << BDGT_FRAC_BITS;
+	t->dev = 0;
+	t->cost = initial_cost;
+	t->decided_tick = 0;
+	t->deferrals = 0;
+	return (S32) num_tasks++;
+}
+
+void bdgt_begin_tick(U32 tick_start, U32 budget) {
+	tick_count++;
+	tick_deadline = tick_start + budget;
+}
+
+bool bdgt_admit(U32 task) {
+	BDGT_TASK *t;
+	BDGT_STATS *cs;
+	S32 remaining;
+
+	if (task >= num_tasks)
+		return true;								// Unknown tasks are not managed
+	t = &tasks[task];
+	cs = &class_stats[t->task_class];
+	t->decided_tick = tick_count;
+	t->start = tick_systick();
+	remaining = (S32) (tick_deadline - t->start);
+
+	if ((t->task_class != BDGT_CRITICAL)
+		&& (remaining < (S32) (t->cost + _pending_cost(t->task_class)))) {
+		if (!t->max_defer || (t->deferrals < t->max_defer)) {
+			t->deferrals++;
+			cs->deferred++;
+			return false;
+		}
+		cs->forced++;
+	}
+
+	if (remaining < 0)
+		cs->late++;
+	t->deferrals = 0;
+	cs->runs++;
+	return true;
+}
+
+void bdgt_done(U32 task) {
+	if (task < num_tasks)
+		_update_cost(&tasks[task], tick_systick() - tasks[task].start);
+}
+
+bool bdgt_end_tick(void) {
+	if (bdgt_remaining() >= 0)
+		return false;
+	tick_overruns++;
+	return true;
+}
+
+S32 bdgt_remaining(void) {
+	return (S32) (tick_deadline - tick_systick());
+}
+
+U32 bdgt_get_cost(U32 task) {
+	return (task < num_tasks) ? tasks[task].cost : 0;
+}
+
+bool bdgt_get_stats(U32 task_class, BDGT_STATS *stats) {
+	U32 i;
+
+	if (task_class >= BDGT_NUM_CLASSES)
+		return false;
+	*stats = class_stats[task_class];
+	stats->cost = 0;
+	for (i = 0; i < num_tasks; i++) {
+		if (tasks[i].task_class == task_class)
+			stats->cost += tasks[i].cost;
+	}
+	return true;
+}
+
+void bdgt_get_tick_stats(U32 *ticks, U32 *overruns) {
+	if (ticks)
+		*ticks = tick_count;
+	if (overruns)
+		*overruns = tick_overruns;
+}
+
+void bdgt_report(void) {
+	BDGT_STATS stats;
+	U32 i;
+
+	fprintf(stderr, "budget: %lu ticks, %lu overruns\n", tick_count, tick_overruns);
+	fprintf(stderr, "budget: %-11s %8s %8s %8s %8s %8s\n", "class", "runs", "deferred", "forced", "late", "cost(us)");
+	for (i = 0; i < BDGT_NUM_CLASSES; i++) {
+		bdgt_get_stats(i, &stats);
+		fprintf(stderr, "budget: %-11s %8lu %8lu %8lu %8lu %8lu\n", class_names[i],
+				stats.runs, stats.deferred, stats.forced, stats.late, stats.cost);
+	}
+}
@@ -0,0 +1,91 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   channel.c
+ *  \brief  ARM-BBR bounded coroutine channel routines
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "ev3dev-arm-ctypes.h"
+#include <stdbool.h>
+#include "channel.h"
+
+/* Internal Routines */
+
+static inline U8 *_slot(CHAN *ch, U32 counter) {
+	return ch->slots + (counter & ch->mask) * ch->slot_size;
+}
+
+/* Public Routines */
+
+bool chan_init(CHAN *ch, void *slots, U32 slot_size, U32 capacity) {
+	memset(ch, 0, sizeof(*ch));
+	if ((slot_size == 0) || (capacity == 0) || (capacity & (capacity - 1)))
+		return false;
+	if (!slots) {
+		if (!(slots = calloc(capacity, slot_size)))
+			return false;
+		ch->allocated = TRUE;
+	}
+	ch->slots = slots;
+	ch->slot_size = slot_size;
+	ch->mask = capacity - 1;
+	return true;
+}
+
+void chan_free(CHAN *ch) {
+	if (ch->allocated)
+		free(ch->slots);
+	ch->slots = NULL;
+	ch->allocated = FALSE;
+}
+
+void *chan_reserve(CHAN *ch) {
+	if ((ch->head - ch->tail) > ch->mask)
+		return NULL;
+	return _slot(ch, ch->head);
+}
+
+void chan_commit(CHAN *ch) {
+	ch->head++;
+}
+
+void *chan_peek(CHAN *ch) {
+	if (ch->head == ch->tail)
+		return NULL;
+	return _slot(ch, ch->tail);
+}
+
+void chan_release(CHAN *ch) {
+	ch->tail++;
+}
+
+U32 chan_count(CHAN *ch) {
+	return ch->head - ch->tail;
+}
+
+bool chan_send(CHAN *ch, const void *data) {
+	void *slot = chan_reserve(ch);
+
+	if (!slot)
+		return false;
+	memcpy(slot, data, ch->slot_size);
+	chan_commit(ch);
+	return true;
+}
+
+bool chan_recv(CHAN *ch, void *data) {
+	void *slot = chan_peek(ch);
+
+	if (!slot)
+		return false;
+	memcpy(data, slot, ch->slot_size);
+	chan_release(ch);
+	return true;
+}
@@ -0,0 +1,212 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   colorlut.c
+ *  \brief  ARM-BBR lookup table color classifier routines
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "ev3dev-arm-ctypes.h"
+#include <stdbool.h>
+#include "colorlut.h"
+
+#define CLUT_HEADER_WORDS  5								// version, num_classes, range[3]
+
+/* Internal Routines */
+
+static inline U32 _raw(S32 value) {
+	return (value < 0) ? 0 : (U32) value;
+}
+
+static inline U32 _quantize(const CLUT *lut, U32 channel, S32 value) {
+	U32 raw = _raw(value);
+	U32 q;
+
+	if (raw >= lut->range[channel])
+		return CLUT_LEVELS - 1;						// Also avoids overflow in the multiply
+	q = (raw * lut->scale[channel]) >> 16;
+	return (q >= CLUT_LEVELS) ? (CLUT_LEVELS - 1) : q;
+}
+
+/* Raw value at the center of a quantization level */
+static inline S32 _center(const CLUT *lut, U32 channel, U32 q) {
+	return (S32) (((2 * q + 1) * lut->range[channel]) / (2 * CLUT_LEVELS));
+}
+
+static void _set_range(CLUT *lut, U32 channel, U32 range) {
+	lut->range[channel] = range;
+	lut->scale[channel] = (CLUT_LEVELS << 16) / range;
+}
+
+/* Nearest class to a cell center, with the confidence margin to the second nearest class */
+static U8 _bake_cell(const CLUT *lut, const S32 mean[][3], const U32 *spread2, const S32 *center) {
+	U32 d, d1 = 0xFFFFFFFF, d2 = 0xFFFFFFFF;
+	U32 c, nearest = 0, conf;
+	S32 dr, dg, db;
+
+	for (c = 0; c < lut->num_classes; c++) {
+		dr = center[0] - mean[c][0];
+		dg = center[1] - mean[c][1];
+		db = center[2] - mean[c][2];
+		d = (U32) (dr * dr + dg * dg + db * db);
+		if (d < d1) {
+			d2 = d1;
+			d1 = d;
+			nearest = c;
+		} else if (d < d2)
+			d2 = d;
+	}
+
+	if (d1 > CLUT_REJECT_K * CLUT_REJECT_K * spread2[nearest] + CLUT_REJECT_MIN * CLUT_REJECT_MIN)
+		return CLUT_UNKNOWN;
+	if (lut->num_classes == 1)
+		conf = CLUT_MAX_CONF;
+	else
+		conf = d2 ? (CLUT_MAX_CONF * (d2 - d1)) / d2 : 0;
+	return (U8) ((conf << 4) | nearest);
+}
+
+static void _put_word(U8 *buf, U32 value) {
+	buf[0] = value & 0xFF;
+	buf[1] = (value >> 8) & 0xFF;
+	buf[2] = (value >> 16) & 0xFF;
+	buf[3] = (value >> 24) & 0xFF;
+}
+
+static U32 _get_word(const U8 *buf) {
+	return buf[0] | (buf[1] << 8) | ((U32) buf[2] << 16) | ((U32) buf[3] << 24);
+}
+
+/* Public Routines */
+
+void clut_cal_init(CLUT_CAL *cal) {
+	memset(cal, 0, sizeof(*cal));
+}
+
+bool clut_cal_add(CLUT_CAL *cal, U32 color, S32 r, S32 g, S32 b) {
+	U32 rgb[3] = { _raw(r), _raw(g), _raw(b) };
+	U32 i;
+
+	if (color >= CLUT_MAX_CLASSES)
+		return false;
+	for (i = 0; i < 3; i++) {
+		cal->sum[color][i] += rgb[i];
+		cal->sumsq[color] += (unsigned long long) rgb[i] * rgb[i];
+		if (rgb[i] > cal->max[i])
+			cal->max[i] = rgb[i];
+	}
+	cal->count[color]++;
+	if (color >= cal->num_classes)
+		cal->num_classes = color + 1;
+	return true;
+}
+
+bool clut_bake(const CLUT_CAL *cal, CLUT *lut) {
+	S32 mean[CLUT_MAX_CLASSES][3];
+	U32 spread2[CLUT_MAX_CLASSES];
+	S32 center[3];
+	long long variance;
+	U32 c, i, qr, qg, qb;
+	U8 *cell = lut->cells;
+
+	if (cal->num_classes == 0)
+		return false;
+	for (c = 0; c < cal->num_classes; c++) {
+		if (cal->count[c] == 0)
+			return false;
+		variance = (long long) (cal->sumsq[c] / cal->count[c]);
+		for (i = 0; i < 3; i++) {
+			mean[c][i] = (S32) (cal->sum[c][i] / cal->count[c]);
+			variance -= (long long) mean[c][i] * mean[c][i];
+		}
+		spread2[c] = (variance > 0) ? (U32) variance : 0;
+	}
+
+	lut->num_classes = cal->num_classes;
+	for (i = 0; i < 3; i++)
+		_set_range(lut, i, cal->max[i] + cal->max[i] / 4 + 1);		// 25% headroom
+
+	for (qr = 0; qr < CLUT_LEVELS; qr++) {
+		center[0] = _center(lut, 0, qr);
+		for (qg = 0; qg < CLUT_LEVELS; qg++) {
+			center[1] = _center(lut, 1, qg);
+			for (qb = 0; qb < CLUT_LEVELS; qb++) {
+				center[2] = _center(lut, 2, qb);
+				*cell++ = _bake_cell(lut, (const S32 (*)[3]) mean, spread2, center);
+			}
+		}
+	}
+	return true;
+}
+
+U8 clut_lookup(const CLUT *lut, S32 r, S32 g, S32 b) {
+	return lut->cells[(_quantize(lut, 0, r) << (2 * CLUT_BITS))
+					  | (_quantize(lut, 1, g) << CLUT_BITS)
+					  | _quantize(lut, 2, b)];
+}
+
+U32 clut_classify(const CLUT *lut, S32 r, S32 g, S32 b, U32 min_conf) {
+	U8 cell = clut_lookup(lut, r, g, b);
+
+	return (CLUT_CONF(cell) >= min_conf) ? CLUT_CLASS(cell) : CLUT_UNKNOWN;
+}
+
+U32 clut_classify_batch(const CLUT *lut, const S32 *rgb, U32 count, U8 *colors, U32 min_conf) {
+	U32 i, known = 0;
+
+	for (i = 0; i < count; i++, rgb += 3) {
+		colors[i] = (U8) clut_classify(lut, rgb[0], rgb[1], rgb[2], min_conf);
+		if (colors[i] != CLUT_UNKNOWN)
+			known++;
+	}
+	return known;
+}
+
+bool clut_save(const CLUT *lut, const char *path) {
+	U8 header[4 + 4 * CLUT_HEADER_WORDS];
+	FILE *f;
+	bool ok;
+
+	memcpy(header, CLUT_FILE_MAGIC, 4);
+	_put_word(&header[4], CLUT_FILE_VERSION);
+	_put_word(&header[8], lut->num_classes);
+	_put_word(&header[12], lut->range[0]);
+	_put_word(&header[16], lut->range[1]);
+	_put_word(&header[20], lut->range[2]);
+
+	if (!(f = fopen(path, "wb")))
+		return false;
+	ok = (fwrite(header, sizeof(header), 1, f) == 1) && (fwrite(lut->cells, CLUT_CELLS, 1, f) == 1);
+	return (0 == fclose(f)) && ok;
+}
+
+bool clut_load(CLUT *lut, const char *path) {
+	U8 header[4 + 4 * CLUT_HEADER_WORDS];
+	FILE *f;
+	bool ok;
+	U32 i;
+
+	if (!(f = fopen(path, "rb")))
+		return false;
+	ok = (fread(header, sizeof(header), 1, f) == 1) && (fread(lut->cells, CLUT_CELLS, 1, f) == 1);
+	fclose(f);
+
+	if (!ok || memcmp(header, CLUT_FILE_MAGIC, 4) || (_get_word(&header[4]) != CLUT_FILE_VERSION))
+		return false;
+	lut->num_classes = _get_word(&header[8]);
+	if ((lut->num_classes == 0) || (lut->num_classes > CLUT_MAX_CLASSES))
+		return false;
+	for (i = 0; i < 3; i++) {
+		if (_get_word(&header[12 + 4 * i]) == 0)
+			return false;
+		_set_range(lut, i, _get_word(&header[12 + 4 * i]));
+	}
+	return true;
+}
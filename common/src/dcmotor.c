@@ -0,0 +1,383 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   dcmotor.c
+ *  \brief  ARM-BBR software-regulated DC motor and servo driver routines
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "ev3dev-arm-ctypes.h"
+#include <stdbool.h>
+#include "dcmotor.h"
+#include "fastattr.h"
+#include "systick.h"
+
+#define DCM_IDLE_US       10000						// Maximum background thread sleep
+#define DCM_MAX_PERIOD_US 1000000
+#define DCM_Q8_MAX        (DCM_DUTY_MAX << 8)		// Full output (Q8)
+
+/* Commands (mode in the two low bits, so that mode and target are updated in a single word) */
+#define DCM_MODE_HALT     0
+#define DCM_MODE_DUTY     1
+#define DCM_MODE_SPEED    2
+#define DCM_MODE_MASK     3
+#define DCM_CMD(mode, target)  ((S32) ((target) * 4 + (mode)))
+
+typedef struct {
+	// Configuration
+	U8 sn;
+	bool servo;
+	U32 flags;
+	S32 output_fd;
+	S32 command_fd;
+	S32 feedback_fd;								// -1: open loop only
+	U32 feedback_flags;
+	U32 max_speed;									// Counts/s at full output
+	U32 ramp_up_ms;
+	U32 ramp_down_ms;
+	U32 kp;											// Q16
+	U32 ki;											// Q16
+
+	// Control (written by dcm_set_duty()/dcm_set_speed()/dcm_halt())
+	S32 command;									// DCM_CMD()
+
+	// Update state
+	bool running;									// Run command written
+	bool written;									// Output written at least once
+	S32 setpoint;									// Ramped output or speed target (Q8 duty)
+	S32 last_pos;
+	U32 last_pos_at;
+	bool have_pos;
+	long long lag;									// Integral of the speed error (counts * us)
+
+	// Published
+	S32 output;
+	S32 speed;										// Filtered speed (counts/s)
+	S32 position;
+} DCM_MOTOR;
+
+static DCM_MOTOR motors[DCM_MAX_MOTORS];
+static U32 num_motors;
+static U32 dcm_period = DCM_DEFAULT_PERIOD_US;
+static U32 dcm_next_due;
+static U32 dcm_last_update;
+static bool dcm_updated;
+static pthread_t dcm_thread;
+static bool dcm_running;
+
+/* Internal Routines */
+
+static inline bool _valid_id(S32 id) {
+	return ((id >= 0) && ((U32) id < num_motors));
+}
+
+static inline S32 _clamp(S32 value, S32 limit) {
+	return (value > limit) ? limit : ((value < -limit) ? -limit : value);
+}
+
+static const char *_run_command(DCM_MOTOR *m) {
+	return m->servo ? "run" : "run-direct";
+}
+
+static const char *_stop_command(DCM_MOTOR *m) {
+	return m->servo ? "float" : "stop";
+}
+
+/* Ramp step per period (Q8 duty), 0 for no ramp */
+static S32 _ramp_step(U32 ramp_ms) {
+	S32 step;
+
+	if (ramp_ms == 0)
+		return 0;
+	step = (S32) (((long long) DCM_Q8_MAX * dcm_period) / ((long long) ramp_ms * 1000));
+	return (step > 0) ? step : 1;
+}
+
+/* Move the setpoint towards the goal, using the ramp up rate when moving away from 0 */
+static S32 _ramp(DCM_MOTOR *m, S32 setpoint, S32 goal) {
+	S32 diff = goal - setpoint;
+	bool away = (setpoint == 0) || ((setpoint > 0) == (diff > 0));
+	S32 step = _ramp_step(__atomic_load_n(away ? &m->ramp_up_ms : &m->ramp_down_ms, __ATOMIC_RELAXED));
+
+	if ((step == 0) || (((diff < 0) ? -diff : diff) <= step))
+		return goal;
+	return setpoint + ((diff > 0) ? step : -step);
+}
+
+static void _sample_feedback(DCM_MOTOR *m, U32 now) {
+	S32 pos, raw;
+
+	if ((m->feedback_fd < 0) || !fattr_read_int(m->feedback_fd, &pos))
+		return;
+	if (m->feedback_flags & DCM_FB_INVERT)
+		pos = -pos;
+	if (m->have_pos && (now != m->last_pos_at)) {
+		raw = (S32) (((long long) (pos - m->last_pos) * TICKS_PER_SECOND) / (long long) (now - m->last_pos_at));
+		__atomic_store_n(&m->speed, m->speed + ((raw - m->speed) >> DCM_SPEED_SHIFT), __ATOMIC_RELEASE);
+	}
+	m->last_pos = pos;
+	m->last_pos_at = now;
+	m->have_pos = true;
+	__atomic_store_n(&m->position, pos, __ATOMIC_RELEASE);
+}
+
+/* PI speed regulation around the feed-forward duty cycle */
+static S32 _regulate(DCM_MOTOR *m, U32 dt) {
+	S32 want = (S32) (((long long) m->setpoint * (long long) m->max_speed) / DCM_Q8_MAX);
+	S32 error = want - m->speed;
+	long long lag = m->lag + (long long) error * (long long) dt;
+	long long total;
+	S32 out;
+
+	total = ((long long) m->setpoint << 8)
+		+ (long long) __atomic_load_n(&m->kp, __ATOMIC_RELAXED) * error
+		+ ((long long) __atomic_load_n(&m->ki, __ATOMIC_RELAXED) * lag) / TICKS_PER_SECOND;
+	out = (S32) ((total + ((total >= 0) ? 32768 : -32768)) / 65536);
+
+	if ((out > DCM_DUTY_MAX) || (out < -DCM_DUTY_MAX)) {
+		if ((out > 0) != (error > 0))
+			m->lag = lag;							// Saturated: only unwind the integral
+		return _clamp(out, DCM_DUTY_MAX);
+	}
+	m->lag = lag;
+	return out;
+}
+
+static void _write_output(DCM_MOTOR *m, S32 out) {
+	if (m->flags & DCM_INVERT)
+		out = -out;
+	if (m->written && (out == m->output))
+		return;
+	if (!m->running) {
+		fattr_write_str(m->command_fd, _run_command(m));
+		m->running = true;
+	}
+	if (fattr_write_int(m->output_fd, out)) {
+		m->written = true;
+		__atomic_store_n(&m->output, out, __ATOMIC_RELEASE);
+	}
+}
+
+static void _halt(DCM_MOTOR *m) {
+	m->setpoint = 0;
+	m->lag = 0;
+	if (!m->running)
+		return;
+	fattr_write_int(m->output_fd, 0);
+	fattr_write_str(m->command_fd, _stop_command(m));
+	m->running = false;
+	m->written = false;
+	__atomic_store_n(&m->output, 0, __ATOMIC_RELEASE);
+}
+
+static void _update(DCM_MOTOR *m, U32 now, U32 dt) {
+	S32 command = __atomic_load_n(&m->command, __ATOMIC_ACQUIRE);
+	S32 target = command >> 2;
+	S32 goal;
+
+	_sample_feedback(m, now);
+
+	switch (command & DCM_MODE_MASK) {
+	case DCM_MODE_DUTY:
+		m->setpoint = _ramp(m, m->setpoint, _clamp(target, DCM_DUTY_MAX) << 8);
+		m->lag = 0;
+		_write_output(m, m->setpoint / 256);
+		break;
+	case DCM_MODE_SPEED:
+		goal = (S32) (((long long) target * DCM_Q8_MAX) / (S32) m->max_speed);
+		m->setpoint = _ramp(m, m->setpoint, _clamp(goal, DCM_Q8_MAX));
+		_write_output(m, _regulate(m, dt));
+		break;
+	default:
+		_halt(m);
+		break;
+	}
+}
+
+static void *_dcm_thread(void *arg) {
+	(void) arg;
+	while (__atomic_load_n(&dcm_running, __ATOMIC_ACQUIRE)) {
+		tick_sleep_until(dcm_poll(), DCM_IDLE_US);
+	}
+	return NULL;
+}
+
+static S32 _add_motor(U8 sn, U32 flags, bool servo) {
+	DCM_MOTOR *m;
+	const char *path = servo ? FATTR_SERVO_PATH : FATTR_DC_PATH;
+
+	if ((num_motors >= DCM_MAX_MOTORS) || dcm_running)
+		return -1;
+
+	m = &motors[num_motors];
+	memset(m, 0, sizeof(*m));
+	m->sn = sn;
+	m->servo = servo;
+	m->flags = flags;
+	m->feedback_fd = -1;
+	m->kp = DCM_DEFAULT_KP;
+	m->ki = DCM_DEFAULT_KI;
+	m->command = DCM_CMD(DCM_MODE_HALT, 0);
+
+	m->output_fd = fattr_open(path, sn, servo ? "position_sp" : "duty_cycle_sp", true);
+	m->command_fd = fattr_open(path, sn, "command", true);
+	if ((m->output_fd < 0) || (m->command_fd < 0)) {
+		fattr_close(m->output_fd);
+		fattr_close(m->command_fd);
+		return -1;
+	}
+	return (S32) num_motors++;
+}
+
+/* Public Routines */
+
+S32 dcm_add_dc(U8 sn, U32 flags) {
+	return _add_motor(sn, flags, false);
+}
+
+S32 dcm_add_servo(U8 sn, U32 flags) {
+	return _add_motor(sn, flags, true);
+}
+
+bool dcm_set_period(U32 period_us) {
+	if ((period_us < DCM_MIN_PERIOD_US) || (period_us > DCM_MAX_PERIOD_US) || dcm_running)
+		return false;
+	dcm_period = period_us;
+	return true;
+}
+
+void dcm_set_ramp(S32 id, U32 ramp_up_ms, U32 ramp_down_ms) {
+	if (!_valid_id(id))
+		return;
+	__atomic_store_n(&motors[id].ramp_up_ms, ramp_up_ms, __ATOMIC_RELAXED);
+	__atomic_store_n(&motors[id].ramp_down_ms, ramp_down_ms, __ATOMIC_RELAXED);
+}
+
+bool dcm_set_feedback(S32 id, U8 sn, U8 value_inx, U32 max_speed, U32 flags) {
+	DCM_MOTOR *m;
+	S32 fd;
+
+	if (!_valid_id(id) || (max_speed == 0) || dcm_running)
+		return false;
+	m = &motors[id];
+	fd = (flags & DCM_FB_TACHO) ? fattr_open_tacho(sn, "position", false) : fattr_open_sensor_value(sn, value_inx);
+	if (fd < 0)
+		return false;
+
+	fattr_close(m->feedback_fd);
+	m->feedback_fd = fd;
+	m->feedback_flags = flags;
+	m->max_speed = max_speed;
+	m->have_pos = false;
+	m->speed = 0;
+	return true;
+}
+
+void dcm_set_gains(S32 id, U32 kp, U32 ki) {
+	if (!_valid_id(id))
+		return;
+	__atomic_store_n(&motors[id].kp, kp, __ATOMIC_RELAXED);
+	__atomic_store_n(&motors[id].ki, ki, __ATOMIC_RELAXED);
+}
+
+void dcm_set_duty(S32 id, S32 duty) {
+	if (!_valid_id(id))
+		return;
+	__atomic_store_n(&motors[id].command, DCM_CMD(DCM_MODE_DUTY, _clamp(duty, DCM_DUTY_MAX)), __ATOMIC_RELEASE);
+}
+
+bool dcm_set_speed(S32 id, S32 speed) {
+	if (!_valid_id(id) || (motors[id].feedback_fd < 0))
+		return false;
+	__atomic_store_n(&motors[id].command, DCM_CMD(DCM_MODE_SPEED, _clamp(speed, (S32) motors[id].max_speed)),
+					 __ATOMIC_RELEASE);
+	return true;
+}
+
+void dcm_halt(S32 id) {
+	DCM_MOTOR *m;
+
+	if (!_valid_id(id))
+		return;
+	m = &motors[id];
+	__atomic_store_n(&m->command, DCM_CMD(DCM_MODE_HALT, 0), __ATOMIC_RELEASE);
+	if (__atomic_load_n(&dcm_running, __ATOMIC_ACQUIRE))
+		fattr_write_str(m->command_fd, _stop_command(m));	// Stop now, the thread resets its state in _halt()
+	else
+		_halt(m);
+}
+
+S32 dcm_get_duty(S32 id) {
+	if (!_valid_id(id))
+		return 0;
+	return __atomic_load_n(&motors[id].output, __ATOMIC_ACQUIRE);
+}
+
+bool dcm_get_speed(S32 id, S32 *speed, S32 *position) {
+	if (!_valid_id(id) || (motors[id].feedback_fd < 0))
+		return false;
+	if (speed)
+		*speed = __atomic_load_n(&motors[id].speed, __ATOMIC_ACQUIRE);
+	if (position)
+		*position = __atomic_load_n(&motors[id].position, __ATOMIC_ACQUIRE);
+	return true;
+}
+
+U32 dcm_poll(void) {
+	U32 now = tick_systick();
+	U32 dt, i;
+
+	if (!tick_is_due_within(now, dcm_next_due, dcm_period))
+		return dcm_next_due;
+
+	dt = dcm_updated ? (now - dcm_last_update) : dcm_period;
+	for (i = 0; i < num_motors; i++)
+		_update(&motors[i], now, dt);
+	dcm_last_update = now;
+	dcm_updated = true;
+	dcm_next_due = now + dcm_period;				// Don't try to catch up
+	return dcm_next_due;
+}
+
+bool dcm_start(void) {
+	if (dcm_running)
+		return false;
+	dcm_running = true;
+	if (0 != pthread_create(&dcm_thread, NULL, _dcm_thread, NULL)) {
+		dcm_running = false;
+		return false;
+	}
+	return true;
+}
+
+void dcm_stop(void) {
+	if (!dcm_running)
+		return;
+	__atomic_store_n(&dcm_running, false, __ATOMIC_RELEASE);
+	pthread_join(dcm_thread, NULL);
+}
+
+void dcm_release(void) {
+	U32 i;
+	DCM_MOTOR *m;
+
+	dcm_stop();
+	for (i = 0; i < num_motors; i++) {
+		m = &motors[i];
+		m->running = true;							// Stop even if the run command was never written
+		_halt(m);
+		fattr_close(m->output_fd);
+		fattr_close(m->command_fd);
+		fattr_close(m->feedback_fd);
+	}
+	num_motors = 0;
+	dcm_updated = false;
+}
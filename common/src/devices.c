@@ -12,11 +12,21 @@
 
 #include <stdlib.h>
 #include <unistd.h>
+#include <pthread.h>
 #include "ev3dev-arm-ctypes.h"
 #include "devices.h"
+#include "startup.h"
 
 #define MS_TO_US_MULTIPLIER  1000
 #define DEVICE_SETTLING_TIME (500 * MS_TO_US_MULTIPLIER)
+#define DISCOVERY_POLL_TIME  (50 * MS_TO_US_MULTIPLIER)
+
+typedef struct {
+	int (*init)(void);						// ev3_xxx_init()
+	U32 min_count;
+	U32 timeout_ms;
+	bool found;
+} DISCOVERY;
 
 /* Internal Routines */
 bool _is_sn_identical_and_valid(U8 port_sn, U8 type_sn) {
@@ -24,6 +34,30 @@ bool _is_sn_identical_and_valid(U8 port_sn, U8 type_sn) {
 }
 
 
+/* Rescan the device class until at least min_count devices are present (or timeout) */
+static void _discover(DISCOVERY *disc) {
+	U32 elapsed = 0;
+
+	for (;;) {
+		int count = disc->init();
+		if ((count >= 0) && ((U32) count >= disc->min_count)) {
+			disc->found = true;
+			return;
+		}
+		if (disc->timeout_ms && (elapsed >= disc->timeout_ms * MS_TO_US_MULTIPLIER))
+			return;
+		usleep(DISCOVERY_POLL_TIME);
+		elapsed += DISCOVERY_POLL_TIME;
+	}
+}
+
+static void *_discover_sensors(void *arg) {
+	_discover((DISCOVERY *) arg);
+	stup_mark("dvcs_discover: sensors");
+	return NULL;
+}
+
+
 /* Convert a Sensor Type into the appropriate Port Mode for configuring set_port_mode_inx() */
 INX_T ev3_sensor_port_mode_inx(INX_T type_inx ) {
 
@@ -99,7 +133,7 @@ INX_T ev3_sensor_port_mode_inx(INX_T type_inx ) {
 	case MS_PIXY_ADAPTER:
 		return EV3_INPUT_NXT_I2C;
 	case MS_EV3_SMUX:
-		return MS_EV3_SMUX_ANALOG;				// FIXME: There are two settings, MS_EV3_SMUX_ANALOG and MS_EV3_SMUX_UART
+		return EV3_INPUT_NXT_I2C;				// Mux channel modes are selected by dvcs_mux_channel_mode_inx()
 	case MS_NXTMMX:
 		return MS_NXTMMX_OUT_TACHO_MOTOR;
 	case MS_NXT_TOUCH_MUX:
@@ -110,7 +144,42 @@ INX_T ev3_sensor_port_mode_inx(INX_T type_inx ) {
 }
 
 
-#if 0
+/* Public Routines */
+
+bool dvcs_discover(U32 num_sensors, U32 num_tachos, U32 timeout_ms) {
+
+	DISCOVERY sensors = { ev3_sensor_init, num_sensors, timeout_ms, false };
+	DISCOVERY tachos = { ev3_tacho_init, num_tachos, timeout_ms, false };
+	pthread_t sensor_thread;
+	bool threaded;
+
+	// ev3_sensor_init() and ev3_tacho_init() scan different sysfs classes into separate descriptor tables
+	threaded = (0 == pthread_create(&sensor_thread, NULL, _discover_sensors, &sensors));
+	_discover(&tachos);
+	stup_mark("dvcs_discover: tachos");
+	if (threaded)
+		pthread_join(sensor_thread, NULL);
+	else
+		_discover_sensors(&sensors);
+
+	return (sensors.found && tachos.found);
+}
+
+/* Convert a Sensor Type into the appropriate Mux Channel Port Mode for a given Sensor Multiplexer */
+INX_T dvcs_mux_channel_mode_inx(INX_T mux_type_inx, INX_T type_inx) {
+
+	INX_T port_mode = ev3_sensor_port_mode_inx(type_inx);
+
+	switch ( mux_type_inx ) {
+	case MS_EV3_SMUX:
+		return (port_mode == EV3_INPUT_EV3_UART) ? MS_EV3_SMUX_UART : MS_EV3_SMUX_ANALOG;
+	case HT_NXT_SMUX:
+		return (port_mode == EV3_INPUT_NXT_I2C) ? HT_NXT_SMUX_I2C : HT_NXT_SMUX_ANALOG;
+	default:
+		return PORT_MODE__NONE_;
+	}
+}
+
 // Not valid unless it has been setup using dvcs_config_dc_type_for_port() beforehand
 bool dvcs_search_dc_type_for_port(INX_T type_inx, U8 port, U8 extport, U8 *sn ) {
 
@@ -156,10 +225,7 @@ bool dvcs_search_servo_type_for_port(INX_T type_inx, U8 port, U8 extport, U8 *sn
 
 	return retval;
 }
-#endif
 
-
-/* Public Routines */
 bool dvcs_search_sensor_type_for_port(INX_T type_inx, U8 port, U8 extport, U8 *sn ) {
 
 	U8 from = 0;
@@ -265,25 +331,18 @@ bool dvcs_reset_port_for_sensor(U8 sn ) {
 	return (set_port_mode_inx(sn_port, EV3_INPUT_AUTO) > 0) ? true : false;
 }
 
-#if 0
 // Not tested (no hardware)
 bool dvcs_config_servo_type_for_port(INX_T type_inx, U8 port, U8 extport, U8 *sn ) {
 
 	bool retval = false;
-	uint8_t sn_port;
-
-	INX_T port_mode = OUTPUT_TACHO_MOTOR;							// FIXME: Need to verify if this is correct
+	U8 ctrl_sn;
 
-	sn_port = ev3_search_port( port, extport );
-	set_port_mode_inx( sn_port, port_mode );
-	usleep(DEVICE_SETTLING_TIME);
-	retval = (get_port_mode_inx(sn_port) == port_mode);
+	// RC servos are driven by a servo controller on an input port (I2C), each servo is an extended port of the controller
+	retval = dvcs_config_sensor_type_for_port( MS_8CH_SERVO, port, EXT_PORT__NONE_, &ctrl_sn );
 	if (retval) {
+		usleep(DEVICE_SETTLING_TIME);								// Servo devices are registered by the controller driver
 		ev3_servo_init();											// Populate servo descriptors
-		retval = ev3_search_servo_plugged_in( port, extport, sn, 0 );
-		if (retval) {
-			retval = (ev3_servo_desc_type_inx(*sn) == type_inx);	// We need the descriptor to be valid for this to work
-		}
+		retval = dvcs_search_servo_type_for_port( type_inx, port, extport, sn );
 	}
 
 	return retval;
@@ -291,8 +350,7 @@ bool dvcs_config_servo_type_for_port(INX_T type_inx, U8 port, U8 extport, U8 *sn
 }
 
 bool dvcs_reset_port_for_servo(U8 sn ) {
-	uint8_t sn_port = ev3_servo_desc_port(sn);
-	return (set_port_mode_inx(sn_port, OUTPUT_AUTO) > 0) ? true : false;
+	uint8_t sn_port = ev3_search_port( ev3_servo_desc_port(sn), EXT_PORT__NONE_ );	// Controller input port
+	return (set_port_mode_inx(sn_port, EV3_INPUT_AUTO) > 0) ? true : false;
 }
 
-#endif
@@ -0,0 +1,105 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   fastattr.c
+ *  \brief  ARM-BBR persistent sysfs attribute access routines
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "ev3dev-arm-ctypes.h"
+#include <stdbool.h>
+#include "fastattr.h"
+
+#define PATHSIZE 96
+#define INTBUFSIZE 16
+
+/* Public Routines */
+
+S32 fattr_open_sensor_value(U8 sn, U8 inx) {
+	char attr[INTBUFSIZE];
+
+	snprintf(attr, sizeof(attr), "value%u", inx);
+	return fattr_open(FATTR_SENSOR_PATH, sn, attr, false);
+}
+
+S32 fattr_open_tacho(U8 sn, const char *attr, bool writable) {
+	return fattr_open(FATTR_TACHO_PATH, sn, attr, writable);
+}
+
+S32 fattr_open(const char *path_prefix, U8 sn, const char *attr, bool writable) {
+	char path[PATHSIZE];
+
+	snprintf(path, sizeof(path), "%s%u/%s", path_prefix, sn, attr);
+	return open(path, writable ? O_WRONLY : O_RDONLY);
+}
+
+bool fattr_read_int(S32 fd, S32 *value) {
+	char buf[INTBUFSIZE];
+	ssize_t len = pread(fd, buf, sizeof(buf), 0);		// sysfs regenerates the value on each read from offset 0
+	ssize_t i = 0;
+	S32 result = 0;
+	bool negative = false;
+
+	if (len <= 0)
+		return false;
+	if (buf[0] == '-') {
+		negative = true;
+		i++;
+	}
+	if ((i >= len) || (buf[i] < '0') || (buf[i] > '9'))
+		return false;
+	for (; (i < len) && (buf[i] >= '0') && (buf[i] <= '9'); i++)
+		result = result * 10 + (buf[i] - '0');
+
+	*value = negative ? -result : result;
+	return true;
+}
+
+bool fattr_write_int(S32 fd, S32 value) {
+	char buf[INTBUFSIZE];
+	char *p = &buf[INTBUFSIZE];
+	U32 magnitude = (value < 0) ? -(U32) value : (U32) value;
+
+	do {
+		*--p = '0' + (magnitude % 10);
+		magnitude /= 10;
+	} while (magnitude);
+	if (value < 0)
+		*--p = '-';
+
+	return (pwrite(fd, p, &buf[INTBUFSIZE] - p, 0) == &buf[INTBUFSIZE] - p);
+}
+
+bool fattr_read_str(S32 fd, char *buf, U32 size) {
+	ssize_t len;
+
+	if (size == 0)
+		return false;
+	len = pread(fd, buf, size - 1, 0);
+	if (len <= 0)
+		return false;
+	if (buf[len - 1] == '\n')
+		len--;
+	buf[len] = '\0';
+	return true;
+}
+
+bool fattr_write_str(S32 fd, const char *str) {
+	size_t len = strlen(str);
+
+	return (pwrite(fd, str, len, 0) == (ssize_t) len);
+}
+
+void fattr_close(S32 fd) {
+	if (fd >= 0)
+		close(fd);
+}
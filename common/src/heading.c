@@ -0,0 +1,324 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   heading.c
+ *  \brief  ARM-BBR gyro and odometry heading estimator routines
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "ev3dev-arm-ctypes.h"
+#include <stdbool.h>
+#include "devices.h"
+#include "fastattr.h"
+#include "heading.h"
+#include "sensormgr.h"
+#include "systick.h"
+
+#define HDG_IDLE_US          10000					// Maximum background thread sleep
+#define HDG_MAX_DT_US        50000					// Longer gaps (e.g. a stalled thread) are not integrated
+#define HDG_NDEG_PER_MDEG  1000000LL				// Gyro integration (mdeg/s * us) units per mdeg
+
+typedef struct {
+	// Gyro
+	S32 gyro_fd;
+	U32 gyro_flags;
+	S32 bias;										// mdeg/s
+	long long gyro_frac;							// Integrated rate below 1 mdeg (mdeg/s * us)
+
+	// Odometry
+	S32 left_fd, right_fd;
+	S32 left_cmd_fd, right_cmd_fd;
+	S32 last_left, last_right;
+	long long odo_counts;							// Sum of (right - left) position changes
+	long long odo_num, odo_den;						// mdeg = odo_counts * odo_num / odo_den
+	U32 odo_weight;									// Q16
+	U32 odo_countdown;
+	bool wheels_moved;
+
+	// Estimates (written by the sampler)
+	S32 heading;									// Fused heading (mdeg)
+	S32 gyro_heading;
+	S32 odo_heading;
+	S32 rate;										// mdeg/s
+	S32 offset;										// Set by hdg_reset(), subtracted from the internal headings
+
+	// Sampler
+	U32 last_sample;
+	U32 next_due;
+	U32 still_since;
+	bool sampled;
+
+	// Turn (target is an internal heading)
+	S32 turn_target;
+	S32 turn_dir;
+	U32 turn_tolerance;
+	U32 turn_flags;
+	bool turn_active;
+} HDG_STATE;
+
+static HDG_STATE hdg = {
+	.gyro_fd = -1, .left_fd = -1, .right_fd = -1, .left_cmd_fd = -1, .right_cmd_fd = -1,
+	.odo_weight = HDG_ODO_WEIGHT
+};
+static pthread_t hdg_thread;
+static bool hdg_running;
+
+/* Internal Routines */
+
+static inline S32 _abs(S32 value) {
+	return (value < 0) ? -value : value;
+}
+
+static bool _read_gyro(S32 *rate_mdps) {
+	S32 raw;
+
+	if (!fattr_read_int(hdg.gyro_fd, &raw))
+		return false;
+	// The EV3 gyro rate is clockwise positive when mounted upright
+	*rate_mdps = (hdg.gyro_flags & HDG_GYRO_INVERT) ? (raw * 1000) : (-raw * 1000);
+	return true;
+}
+
+/* Update the odometry heading, returns TRUE if it was sampled */
+static bool _sample_odometry(void) {
+	S32 left, right;
+
+	if (!fattr_read_int(hdg.left_fd, &left) || !fattr_read_int(hdg.right_fd, &right))
+		return false;
+	hdg.wheels_moved = (left != hdg.last_left) || (right != hdg.last_right);
+	hdg.odo_counts += (right - hdg.last_right) - (left - hdg.last_left);
+	hdg.last_left = left;
+	hdg.last_right = right;
+	hdg.odo_heading = (S32) ((hdg.odo_counts * hdg.odo_num) / hdg.odo_den);
+	return true;
+}
+
+/* Stationary: gyro rate close to the bias and wheels not moving, for HDG_STILL_US */
+static bool _is_still(S32 raw, U32 now) {
+	if ((_abs(raw - hdg.bias) > HDG_STILL_MDPS) || hdg.wheels_moved || !hdg.sampled) {
+		hdg.still_since = now;
+		return false;
+	}
+	return (now - hdg.still_since) >= HDG_STILL_US;
+}
+
+static void _check_turn(void) {
+	S32 remaining, lead;
+
+	if (!__atomic_load_n(&hdg.turn_active, __ATOMIC_ACQUIRE))
+		return;
+	remaining = (hdg.turn_target - hdg.heading) * hdg.turn_dir;
+	lead = (S32) (((long long) _abs(hdg.rate) * HDG_TURN_LEAD_US) / TICKS_PER_SECOND);
+	if (remaining > (S32) hdg.turn_tolerance + lead)
+		return;
+
+	if ((hdg.turn_flags & HDG_TURN_STOP) && (hdg.left_cmd_fd >= 0)) {
+		fattr_write_str(hdg.left_cmd_fd, "stop");
+		fattr_write_str(hdg.right_cmd_fd, "stop");
+	}
+	__atomic_store_n(&hdg.turn_active, false, __ATOMIC_RELEASE);
+}
+
+static void _sample(U32 now) {
+	U32 dt = now - hdg.last_sample;
+	S32 raw = 0, delta = 0, prev_odo = hdg.odo_heading;
+	bool odo_sampled = false;
+	long long steps;
+
+	if (!hdg.sampled || (dt > HDG_MAX_DT_US))
+		dt = 0;
+	hdg.last_sample = now;
+
+	if ((hdg.left_fd >= 0) && ((hdg.gyro_fd < 0) || (--hdg.odo_countdown == 0))) {
+		hdg.odo_countdown = HDG_ODO_DIVIDER;
+		odo_sampled = _sample_odometry();
+	}
+
+	if ((hdg.gyro_fd >= 0) && _read_gyro(&raw)) {
+		if (_is_still(raw, now)) {
+			hdg.bias += (raw - hdg.bias) >> HDG_BIAS_SHIFT;		// Track the drift, don't integrate
+			hdg.rate = 0;
+		} else
+			hdg.rate = raw - hdg.bias;
+
+		hdg.gyro_frac += (long long) hdg.rate * (long long) dt;
+		steps = hdg.gyro_frac / HDG_NDEG_PER_MDEG;
+		hdg.gyro_frac -= steps * HDG_NDEG_PER_MDEG;
+		delta = (S32) steps;
+		hdg.gyro_heading += delta;
+
+		// Complementary filter: gyro changes, pulled towards the odometry heading
+		hdg.heading += delta;
+		if (odo_sampled)
+			hdg.heading += (S32) (((long long) (hdg.odo_heading - hdg.heading) * (long long) hdg.odo_weight) >> 16);
+	} else if (odo_sampled) {
+		if (hdg.gyro_fd < 0) {
+			hdg.rate = dt ? (S32) (((long long) (hdg.odo_heading - prev_odo) * TICKS_PER_SECOND) / (long long) dt) : 0;
+			hdg.heading = hdg.odo_heading;
+		}
+	}
+	hdg.sampled = true;
+	_check_turn();
+}
+
+static void *_hdg_thread(void *arg) {
+	(void) arg;
+	while (__atomic_load_n(&hdg_running, __ATOMIC_ACQUIRE)) {
+		tick_sleep_until(hdg_poll(), HDG_IDLE_US);
+	}
+	return NULL;
+}
+
+/* Public Routines */
+
+bool hdg_set_gyro(U8 sn, U32 flags) {
+	if (hdg_running || !snsr_set_mode(sn, LEGO_EV3_GYRO_GYRO_RATE))
+		return false;
+	fattr_close(hdg.gyro_fd);
+	if ((hdg.gyro_fd = fattr_open_sensor_value(sn, 0)) < 0)
+		return false;
+	hdg.gyro_flags = flags;
+	usleep(SNSR_SETTLE_US);							// Values before the mode switch settles are angles
+	return true;
+}
+
+bool hdg_set_odometry(U8 left_sn, U8 right_sn, U32 wheel_mm, U32 track_mm, U32 count_per_rot) {
+	if (hdg_running || (wheel_mm == 0) || (track_mm == 0) || (count_per_rot == 0))
+		return false;
+	fattr_close(hdg.left_fd);
+	fattr_close(hdg.right_fd);
+	fattr_close(hdg.left_cmd_fd);
+	fattr_close(hdg.right_cmd_fd);
+	hdg.left_fd = fattr_open_tacho(left_sn, "position", false);
+	hdg.right_fd = fattr_open_tacho(right_sn, "position", false);
+	hdg.left_cmd_fd = fattr_open_tacho(left_sn, "command", true);
+	hdg.right_cmd_fd = fattr_open_tacho(right_sn, "command", true);
+	if ((hdg.left_fd < 0) || (hdg.right_fd < 0) || (hdg.left_cmd_fd < 0) || (hdg.right_cmd_fd < 0)
+		|| !fattr_read_int(hdg.left_fd, &hdg.last_left) || !fattr_read_int(hdg.right_fd, &hdg.last_right)) {
+		fattr_close(hdg.left_fd);
+		fattr_close(hdg.right_fd);
+		fattr_close(hdg.left_cmd_fd);
+		fattr_close(hdg.right_cmd_fd);
+		hdg.left_fd = hdg.right_fd = hdg.left_cmd_fd = hdg.right_cmd_fd = -1;
+		return false;
+	}
+
+	// Heading change (deg) = (right - left) * (pi * wheel / count_per_rot) / track * (180 / pi)
+	hdg.odo_num = 180000LL * wheel_mm;
+	hdg.odo_den = (long long) count_per_rot * track_mm;
+	hdg.odo_counts = 0;
+	hdg.odo_countdown = HDG_ODO_DIVIDER;
+	return true;
+}
+
+void hdg_set_odometry_weight(U32 weight_q16) {
+	hdg.odo_weight = (weight_q16 > 65536) ? 65536 : weight_q16;
+}
+
+bool hdg_calibrate(U32 duration_ms) {
+	S32 rate, min = 0x7FFFFFFF, max = -0x7FFFFFFF;
+	long long sum = 0;
+	U32 count = 0;
+	U32 duration = duration_ms * (TICKS_PER_SECOND / 1000);
+	U32 start = tick_systick();
+
+	if ((hdg.gyro_fd < 0) || hdg_running)
+		return false;
+	do {
+		if (_read_gyro(&rate)) {
+			sum += rate;
+			count++;
+			if (rate < min)
+				min = rate;
+			if (rate > max)
+				max = rate;
+		}
+		usleep(HDG_PERIOD_US);
+	} while ((tick_systick() - start) < duration);		// Elapsed time, not a deadline
+
+	if ((count == 0) || ((max - min) > HDG_CAL_MAX_SPREAD * 1000))
+		return false;
+	hdg.bias = (S32) (sum / (long long) count);
+	hdg.gyro_frac = 0;
+	return true;
+}
+
+void hdg_reset(S32 heading) {
+	hdg.offset = __atomic_load_n(&hdg.heading, __ATOMIC_ACQUIRE) - heading;
+}
+
+U32 hdg_poll(void) {
+	U32 now = tick_systick();
+
+	if ((hdg.gyro_fd < 0) && (hdg.left_fd < 0))
+		return now + HDG_IDLE_US;
+	if (!hdg.sampled || tick_is_due_within(now, hdg.next_due, HDG_PERIOD_US)) {
+		_sample(now);
+		hdg.next_due = now + HDG_PERIOD_US;			// Don't try to catch up
+	}
+	return hdg.next_due;
+}
+
+bool hdg_start(void) {
+	if (hdg_running || ((hdg.gyro_fd < 0) && (hdg.left_fd < 0)))
+		return false;
+	hdg_running = true;
+	if (0 != pthread_create(&hdg_thread, NULL, _hdg_thread, NULL)) {
+		hdg_running = false;
+		return false;
+	}
+	return true;
+}
+
+void hdg_stop(void) {
+	if (!hdg_running)
+		return;
+	__atomic_store_n(&hdg_running, false, __ATOMIC_RELEASE);
+	pthread_join(hdg_thread, NULL);
+}
+
+S32 hdg_get_heading(void) {
+	return __atomic_load_n(&hdg.heading, __ATOMIC_ACQUIRE) - hdg.offset;
+}
+
+S32 hdg_get_rate(void) {
+	return __atomic_load_n(&hdg.rate, __ATOMIC_ACQUIRE);
+}
+
+S32 hdg_get_bias(void) {
+	return __atomic_load_n(&hdg.bias, __ATOMIC_ACQUIRE);
+}
+
+void hdg_get_sources(S32 *gyro, S32 *odometry) {
+	if (gyro)
+		*gyro = __atomic_load_n(&hdg.gyro_heading, __ATOMIC_ACQUIRE) - hdg.offset;
+	if (odometry)
+		*odometry = __atomic_load_n(&hdg.odo_heading, __ATOMIC_ACQUIRE) - hdg.offset;
+}
+
+void hdg_turn_start(S32 angle, U32 tolerance, U32 flags) {
+	__atomic_store_n(&hdg.turn_active, false, __ATOMIC_RELEASE);
+	hdg.turn_target = __atomic_load_n(&hdg.heading, __ATOMIC_ACQUIRE) + angle;
+	hdg.turn_dir = (angle < 0) ? -1 : 1;
+	hdg.turn_tolerance = tolerance;
+	hdg.turn_flags = flags;
+	__atomic_store_n(&hdg.turn_active, true, __ATOMIC_RELEASE);
+}
+
+bool hdg_turn_done(void) {
+	return !__atomic_load_n(&hdg.turn_active, __ATOMIC_ACQUIRE);
+}
+
+S32 hdg_turn_remaining(void) {
+	if (hdg_turn_done())
+		return 0;
+	return hdg.turn_target - __atomic_load_n(&hdg.heading, __ATOMIC_ACQUIRE);
+}
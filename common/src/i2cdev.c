@@ -0,0 +1,250 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   i2cdev.c
+ *  \brief  ARM-BBR direct /dev/i2c sensor access routines
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include "ev3dev-arm-ctypes.h"
+#include "devices.h"
+#include "i2cdev.h"
+
+#define I2C_DEV_FMT   "/dev/i2c-%lu"
+#define I2C_MOCK_FMT  "%s/i2c-%lu-%02x.bin"
+#define PATHSIZE 128
+
+typedef enum {
+	I2CD_UNUSED,
+	I2CD_RDWR,									// Combined I2C transactions
+	I2CD_SMBUS,									// SMBus I2C block transfers (e.g., i2c-stub)
+	I2CD_MOCK									// Register image file
+} I2CD_BACKEND;
+
+typedef struct {
+	I2CD_BACKEND backend;
+	int fd;
+	const I2CD_DESC *desc;
+} I2CD_DEVICE;
+
+/* 7-bit addresses; the sensor documentation usually gives 8-bit addresses (e.g., 0x02 == 0x01) */
+static const I2CD_DESC i2cd_desc_table[] = {
+	{ LEGO_NXT_US,       0x01, 0x42, 1, "LEGO",     "Sonar"    },	// Distance (cm)
+	{ HT_NXT_COMPASS,    0x01, 0x42, 2, "HiTechnc", "Compass"  },	// Heading / 2, heading LSB
+	{ HT_NXT_IR_SEEK_V2, 0x08, 0x49, 6, "HiTechnc", "NewIRDir" },	// AC direction, 5 AC strengths
+	{ HT_NXT_COLOR_V2,   0x01, 0x42, 4, "HiTechnc", "ColorPD"  },	// Color number, R, G, B
+	{ HT_NXT_ACCEL,      0x01, 0x42, 6, "HiTechnc", "Accel."   },	// X, Y, Z upper 8 bits, X, Y, Z lower 2 bits
+	{ HT_NXT_ANGLE,      0x01, 0x42, 8, "HiTechnc", "AnglSnsr" },	// Angle / 2, angle LSB, accumulated angle, RPM
+	{ MS_LIGHT_ARRAY,    0x0A, 0x42, 8, "mndsnsrs", "LSArray"  },	// 8 calibrated light values
+};
+
+#define I2CD_NUM_DESC (sizeof(i2cd_desc_table) / sizeof(i2cd_desc_table[0]))
+
+static I2CD_DEVICE devices[I2CD_MAX_DEVICES];
+
+/* Internal Routines */
+
+static I2CD_DEVICE *_get_device(S32 dev) {
+	if ((dev < 0) || (dev >= I2CD_MAX_DEVICES) || (devices[dev].backend == I2CD_UNUSED))
+		return NULL;
+	return &devices[dev];
+}
+
+static bool _rdwr_read(I2CD_DEVICE *d, U8 reg, U8 *buf, U32 len) {
+	struct i2c_msg msgs[2] = {
+		{ .addr = d->desc->address, .flags = 0, .len = 1, .buf = &reg },
+		{ .addr = d->desc->address, .flags = I2C_M_RD, .len = len, .buf = buf },
+	};
+	struct i2c_rdwr_ioctl_data xfer = { .msgs = msgs, .nmsgs = 2 };
+
+	// Register address write, repeated start, burst read
+	return (ioctl(d->fd, I2C_RDWR, &xfer) == 2);
+}
+
+static bool _rdwr_write(I2CD_DEVICE *d, U8 reg, const U8 *buf, U32 len) {
+	U8 data[I2CD_MAX_TRANSFER + 1];
+	struct i2c_msg msg = { .addr = d->desc->address, .flags = 0, .len = len + 1, .buf = data };
+	struct i2c_rdwr_ioctl_data xfer = { .msgs = &msg, .nmsgs = 1 };
+
+	data[0] = reg;
+	memcpy(&data[1], buf, len);
+	return (ioctl(d->fd, I2C_RDWR, &xfer) == 1);
+}
+
+static bool _smbus_xfer(I2CD_DEVICE *d, char read_write, U8 reg, U8 *buf, U32 len) {
+	union i2c_smbus_data data;
+	struct i2c_smbus_ioctl_data args = {
+		.read_write = read_write, .command = reg, .size = I2C_SMBUS_I2C_BLOCK_DATA, .data = &data
+	};
+
+	data.block[0] = len;
+	if (read_write == I2C_SMBUS_WRITE)
+		memcpy(&data.block[1], buf, len);
+	if (ioctl(d->fd, I2C_SMBUS, &args) < 0)
+		return false;
+	if (read_write == I2C_SMBUS_READ)
+		memcpy(buf, &data.block[1], len);
+	return true;
+}
+
+static int _open_bus(U32 bus, U8 address, I2CD_BACKEND *backend) {
+	char path[PATHSIZE];
+	const char *mock_dir = getenv(I2CD_MOCK_ENV);
+	unsigned long funcs = 0;
+	int fd;
+
+	if (mock_dir && *mock_dir) {
+		snprintf(path, sizeof(path), I2C_MOCK_FMT, mock_dir, bus, address);
+		*backend = I2CD_MOCK;
+		return open(path, O_RDWR);							// Missing file == device not present
+	}
+
+	snprintf(path, sizeof(path), I2C_DEV_FMT, bus);
+	if ((fd = open(path, O_RDWR)) < 0)
+		return -1;
+
+	if ((ioctl(fd, I2C_FUNCS, &funcs) == 0) && (funcs & I2C_FUNC_I2C)) {
+		*backend = I2CD_RDWR;
+	} else if ((funcs & I2C_FUNC_SMBUS_I2C_BLOCK) && (ioctl(fd, I2C_SLAVE, address) == 0)) {
+		*backend = I2CD_SMBUS;
+	} else {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+/* Public Routines */
+
+const I2CD_DESC *i2cd_find_desc(INX_T type_inx) {
+	U32 i;
+
+	for (i = 0; i < I2CD_NUM_DESC; i++) {
+		if (i2cd_desc_table[i].type_inx == type_inx)
+			return &i2cd_desc_table[i];
+	}
+	return NULL;
+}
+
+bool i2cd_claim_port(U8 port, U8 extport) {
+	uint8_t sn_port = ev3_search_port( port, extport );
+
+	if (sn_port == DESC_LIMIT)
+		return false;
+	set_port_mode_inx( sn_port, EV3_INPUT_OTHER_I2C );		// lego-sensor driver releases the sensor
+	return (get_port_mode_inx(sn_port) == EV3_INPUT_OTHER_I2C);
+}
+
+S32 i2cd_open(U32 bus, INX_T type_inx) {
+	const I2CD_DESC *desc = i2cd_find_desc(type_inx);
+	I2CD_BACKEND backend;
+	S32 dev;
+	int fd;
+
+	if (!desc)
+		return -1;
+	for (dev = 0; (dev < I2CD_MAX_DEVICES) && (devices[dev].backend != I2CD_UNUSED); dev++)
+		;
+	if (dev >= I2CD_MAX_DEVICES)
+		return -1;
+
+	if ((fd = _open_bus(bus, desc->address, &backend)) < 0)
+		return -1;
+
+	devices[dev].fd = fd;
+	devices[dev].desc = desc;
+	devices[dev].backend = backend;
+	return dev;
+}
+
+bool i2cd_identify(S32 dev) {
+	I2CD_DEVICE *d = _get_device(dev);
+	char id[I2CD_ID_LEN + 1];
+
+	if (!d)
+		return false;
+
+	// ID registers are space or NUL padded
+	if (d->desc->vendor_id) {
+		if (!i2cd_read(dev, I2CD_VENDOR_ID_REG, (U8 *) id, I2CD_ID_LEN))
+			return false;
+		id[I2CD_ID_LEN] = '\0';
+		if (strncmp(id, d->desc->vendor_id, strlen(d->desc->vendor_id)) != 0)
+			return false;
+	}
+	if (d->desc->product_id) {
+		if (!i2cd_read(dev, I2CD_PRODUCT_ID_REG, (U8 *) id, I2CD_ID_LEN))
+			return false;
+		id[I2CD_ID_LEN] = '\0';
+		if (strncmp(id, d->desc->product_id, strlen(d->desc->product_id)) != 0)
+			return false;
+	}
+	return true;
+}
+
+bool i2cd_read(S32 dev, U8 reg, U8 *buf, U32 len) {
+	I2CD_DEVICE *d = _get_device(dev);
+
+	if (!d || (len == 0) || (len > I2CD_MAX_TRANSFER))
+		return false;
+
+	switch (d->backend) {
+	case I2CD_RDWR:
+		return _rdwr_read(d, reg, buf, len);
+	case I2CD_SMBUS:
+		return _smbus_xfer(d, I2C_SMBUS_READ, reg, buf, len);
+	case I2CD_MOCK:
+		return (pread(d->fd, buf, len, reg) == (ssize_t) len);
+	default:
+		return false;
+	}
+}
+
+bool i2cd_write(S32 dev, U8 reg, const U8 *buf, U32 len) {
+	I2CD_DEVICE *d = _get_device(dev);
+
+	if (!d || (len == 0) || (len > I2CD_MAX_TRANSFER))
+		return false;
+
+	switch (d->backend) {
+	case I2CD_RDWR:
+		return _rdwr_write(d, reg, buf, len);
+	case I2CD_SMBUS:
+		return _smbus_xfer(d, I2C_SMBUS_WRITE, reg, (U8 *) buf, len);
+	case I2CD_MOCK:
+		return (pwrite(d->fd, buf, len, reg) == (ssize_t) len);
+	default:
+		return false;
+	}
+}
+
+bool i2cd_read_data(S32 dev, U8 *buf) {
+	I2CD_DEVICE *d = _get_device(dev);
+
+	if (!d)
+		return false;
+	return i2cd_read(dev, d->desc->data_reg, buf, d->desc->data_len);
+}
+
+void i2cd_close(S32 dev) {
+	I2CD_DEVICE *d = _get_device(dev);
+
+	if (!d)
+		return;
+	close(d->fd);
+	d->backend = I2CD_UNUSED;
+}
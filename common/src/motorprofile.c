@@ -0,0 +1,164 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   motorprofile.c
+ *  \brief  ARM-BBR named motor configuration profile routines
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "ev3dev-arm-ctypes.h"
+#include "devices.h"
+#include "motorprofile.h"
+
+typedef struct {
+	U32 valid;										// Cached attributes (MOTOR_PROF_XXX)
+	S32 ramp_up_sp;
+	S32 ramp_down_sp;
+	S32 stop_action;
+	S32 speed_sp;
+	S32 position_sp;
+	S32 profile;									// Last applied profile ID
+} MOTOR_CACHE;
+
+static MOTOR_PROFILE profiles[MOTOR_MAX_PROFILES];
+static U32 num_profiles;
+static MOTOR_CACHE motors[DESC_LIMIT];
+static bool motors_initialized;
+static MOTOR_PROFILE_STATS profile_stats;
+
+/* Internal Routines */
+
+static void _init_motors(void) {
+	U32 i;
+
+	for (i = 0; i < DESC_LIMIT; i++) {
+		motors[i].valid = 0;
+		motors[i].profile = -1;
+	}
+	motors_initialized = true;
+}
+
+static bool _is_valid(const MOTOR_PROFILE *p) {
+	if (!p->name || !p->fields || (p->fields & ~MOTOR_PROF_ALL))
+		return false;
+	if ((p->fields & MOTOR_PROF_RAMP_UP) && ((p->ramp_up_sp < 0) || (p->ramp_up_sp > MOTOR_MAX_RAMP_MS)))
+		return false;
+	if ((p->fields & MOTOR_PROF_RAMP_DOWN) && ((p->ramp_down_sp < 0) || (p->ramp_down_sp > MOTOR_MAX_RAMP_MS)))
+		return false;
+	if ((p->fields & MOTOR_PROF_STOP_ACTION) && ((p->stop_action < TACHO_COAST) || (p->stop_action > TACHO_HOLD)))
+		return false;
+	if ((p->fields & MOTOR_PROF_SPEED) && ((p->speed_sp < -MOTOR_MAX_SPEED_SP) || (p->speed_sp > MOTOR_MAX_SPEED_SP)))
+		return false;
+	return true;
+}
+
+/* Write one attribute unless the cache says the motor already has the value */
+static bool _update(U8 sn, MOTOR_CACHE *m, U32 field, S32 *cached, S32 value) {
+	size_t written;
+
+	if ((m->valid & field) && (*cached == value)) {
+		profile_stats.skipped++;
+		return true;
+	}
+
+	switch (field) {
+	case MOTOR_PROF_RAMP_UP:		written = set_tacho_ramp_up_sp(sn, value); break;
+	case MOTOR_PROF_RAMP_DOWN:		written = set_tacho_ramp_down_sp(sn, value); break;
+	case MOTOR_PROF_STOP_ACTION:	written = set_tacho_stop_action_inx(sn, (INX_T) value); break;
+	case MOTOR_PROF_SPEED:			written = set_tacho_speed_sp(sn, value); break;
+	case MOTOR_PROF_POSITION:		written = set_tacho_position_sp(sn, value); break;
+	default:						written = 0; break;
+	}
+
+	if (written == 0) {
+		m->valid &= ~field;							// Motor state unknown
+		profile_stats.failed++;
+		return false;
+	}
+	*cached = value;
+	m->valid |= field;
+	profile_stats.writes++;
+	return true;
+}
+
+/* Public Routines */
+
+S32 motor_register_profile(const MOTOR_PROFILE *profile) {
+	if (!profile || !_is_valid(profile) || (num_profiles >= MOTOR_MAX_PROFILES)
+		|| (motor_find_profile(profile->name) >= 0))
+		return -1;
+	profiles[num_profiles] = *profile;
+	return (S32) num_profiles++;
+}
+
+S32 motor_find_profile(const char *name) {
+	U32 i;
+
+	for (i = 0; i < num_profiles; i++) {
+		if (0 == strcmp(profiles[i].name, name))
+			return (S32) i;
+	}
+	return -1;
+}
+
+bool motor_apply_profile(U8 sn, S32 id) {
+	const MOTOR_PROFILE *p;
+	MOTOR_CACHE *m;
+	bool ok = true;
+
+	if ((id < 0) || ((U32) id >= num_profiles) || (sn >= DESC_LIMIT))
+		return false;
+	if (!motors_initialized)
+		_init_motors();
+	p = &profiles[id];
+	m = &motors[sn];
+
+	if (p->fields & MOTOR_PROF_RAMP_UP)
+		ok &= _update(sn, m, MOTOR_PROF_RAMP_UP, &m->ramp_up_sp, p->ramp_up_sp);
+	if (p->fields & MOTOR_PROF_RAMP_DOWN)
+		ok &= _update(sn, m, MOTOR_PROF_RAMP_DOWN, &m->ramp_down_sp, p->ramp_down_sp);
+	if (p->fields & MOTOR_PROF_STOP_ACTION)
+		ok &= _update(sn, m, MOTOR_PROF_STOP_ACTION, &m->stop_action, (S32) p->stop_action);
+	if (p->fields & MOTOR_PROF_SPEED)
+		ok &= _update(sn, m, MOTOR_PROF_SPEED, &m->speed_sp, p->speed_sp);
+	if (p->fields & MOTOR_PROF_POSITION)
+		ok &= _update(sn, m, MOTOR_PROF_POSITION, &m->position_sp, p->position_sp);
+
+	m->profile = id;
+	profile_stats.applied++;
+	return ok;
+}
+
+bool motor_apply_profile_vec(const U8 *sns, S32 id) {
+	bool ok = true;
+
+	while (*sns != DESC_LIMIT)
+		ok &= motor_apply_profile(*sns++, id);
+	return ok;
+}
+
+void motor_invalidate(U8 sn, U32 fields) {
+	if (sn >= DESC_LIMIT)
+		return;
+	if (!motors_initialized)
+		_init_motors();
+	motors[sn].valid &= ~fields;
+	if (fields == MOTOR_PROF_ALL)
+		motors[sn].profile = -1;
+}
+
+S32 motor_current_profile(U8 sn) {
+	if ((sn >= DESC_LIMIT) || !motors_initialized)
+		return -1;
+	return motors[sn].profile;
+}
+
+void motor_get_profile_stats(MOTOR_PROFILE_STATS *stats) {
+	*stats = profile_stats;
+}
@@ -0,0 +1,121 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   numfmt.c
+ *  \brief  ARM-BBR integer formatting routines
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#include "ev3dev-arm-ctypes.h"
+#include "numfmt.h"
+#include <string.h>
+#include <stdint.h>
+
+#define NFMT_DEC_SIZE 12						// Sign + 10 digits + NUL
+
+static const char hex_digits[16] = "0123456789ABCDEF";
+
+// 4-bit Binary LUT
+static const char bit_rep[16][4] = {
+    [ 0] = "0000", [ 1] = "0001", [ 2] = "0010", [ 3] = "0011",
+    [ 4] = "0100", [ 5] = "0101", [ 6] = "0110", [ 7] = "0111",
+    [ 8] = "1000", [ 9] = "1001", [10] = "1010", [11] = "1011",
+    [12] = "1100", [13] = "1101", [14] = "1110", [15] = "1111",
+};
+
+/* Internal Routines */
+
+static U32 nfmt_prefix(char *buf, U32 flags, char radix)
+{
+	if (!(flags & NFMT_PREFIX))
+		return 0;
+	buf[0] = '0';
+	buf[1] = radix;
+	return 2;
+}
+
+/* Public Routines */
+
+U32 nfmt_udec_ref(char *buf, U32 value)
+{
+	uint32_t x = (uint32_t) value;
+	uint32_t pow10 = 10;
+	uint32_t q;
+	U32 len = 1;
+	char *p;
+
+	while ((len < 10) && (x >= pow10)) {
+		len++;
+		pow10 *= 10;
+	}
+	p = buf + len;
+	*p = '\0';
+	do {
+		q = (uint32_t) (((uint64_t) x * 0xCCCCCCCDU) >> 35);
+		*--p = '0' + (char) (x - q * 10);
+		x = q;
+	} while (x != 0);
+	return len;
+}
+
+U32 nfmt_dec(char *buf, U32 value, U32 width, U32 flags)
+{
+	char digits[NFMT_DEC_SIZE];
+	uint32_t magnitude = (uint32_t) value;
+	char sign = '\0';
+	U32 len, pos = 0;
+
+	if (flags & NFMT_SIGNED) {
+		if ((int32_t) magnitude < 0) {
+			sign = '-';
+			magnitude = -magnitude;
+		} else if (flags & NFMT_PLUS)
+			sign = '+';
+	}
+	len = nfmt_udec(digits, magnitude);
+
+	if (width > NFMT_MAX_WIDTH)
+		width = NFMT_MAX_WIDTH;
+	while (pos + len + (sign ? 1 : 0) < width)
+		buf[pos++] = ' ';
+	if (sign)
+		buf[pos++] = sign;
+	memcpy(&buf[pos], digits, len + 1);		// Including the NUL
+	return pos + len;
+}
+
+U32 nfmt_hex(char *buf, U32 value, U32 digits, U32 flags)
+{
+	U32 pos = nfmt_prefix(buf, flags, 'x');
+	U32 i;
+
+	if ((digits == 0) || (digits > 8))
+		digits = 8;
+	for (i = digits; i > 0; i--) {
+		buf[pos + i - 1] = hex_digits[value & 0xF];
+		value >>= 4;
+	}
+	pos += digits;
+	buf[pos] = '\0';
+	return pos;
+}
+
+U32 nfmt_bin(char *buf, U32 value, U32 bits, U32 flags)
+{
+	U32 pos = nfmt_prefix(buf, flags, 'b');
+
+	if ((bits == 0) || (bits > 32))
+		bits = 32;
+	bits = (bits + 3) & ~3;
+	while (bits) {
+		bits -= 4;
+		memcpy(&buf[pos], bit_rep[(value >> bits) & 0xF], 4);
+		pos += 4;
+	}
+	buf[pos] = '\0';
+	return pos;
+}
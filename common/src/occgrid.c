@@ -0,0 +1,271 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   occgrid.c
+ *  \brief  ARM-BBR fixed-point occupancy grid routines
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "ev3dev-arm-ctypes.h"
+#include <stdbool.h>
+#include "occgrid.h"
+
+#define OGRID_TILE_CELLS   (OGRID_TILE * OGRID_TILE)
+#define OGRID_TILE_MASK    (OGRID_TILE - 1)
+#define OGRID_QUARTER      (OGRID_ANGLES / 4)
+#define OGRID_Q14          14
+#define OGRID_ALIGN        32							// ARM926EJ-S cache line size
+
+/* Quarter wave sine table (Q14), OGRID_QUARTER + 1 entries */
+static const U16 sin_q14[OGRID_QUARTER + 1] = {
+	    0,   402,   804,  1205,  1606,  2006,  2404,  2801,
+	 3196,  3590,  3981,  4370,  4756,  5139,  5520,  5897,
+	 6270,  6639,  7005,  7366,  7723,  8076,  8423,  8765,
+	 9102,  9434,  9760, 10080, 10394, 10702, 11003, 11297,
+	11585, 11866, 12140, 12406, 12665, 12916, 13160, 13395,
+	13623, 13842, 14053, 14256, 14449, 14635, 14811, 14978,
+	15137, 15286, 15426, 15557, 15679, 15791, 15893, 15986,
+	16069, 16143, 16207, 16261, 16305, 16340, 16364, 16379,
+	16384
+};
+
+/* Internal Routines */
+
+static S32 _sin(S32 angle) {
+	angle &= (OGRID_ANGLES - 1);
+	if (angle < OGRID_QUARTER)
+		return sin_q14[angle];
+	if (angle < 2 * OGRID_QUARTER)
+		return sin_q14[2 * OGRID_QUARTER - angle];
+	if (angle < 3 * OGRID_QUARTER)
+		return -sin_q14[angle - 2 * OGRID_QUARTER];
+	return -sin_q14[OGRID_ANGLES - angle];
+}
+
+/* Floor division (the cell of a negative coordinate is below the origin) */
+static inline S32 _floor_div(S32 value, S32 divisor) {
+	return (value >= 0) ? (value / divisor) : -((divisor - 1 - value) / divisor);
+}
+
+static inline S32 _cell_x(const OGRID *grid, S32 x) {
+	return _floor_div(x, grid->cell_mm) + (S32) (grid->width / 2);
+}
+
+static inline S32 _cell_y(const OGRID *grid, S32 y) {
+	return _floor_div(y, grid->cell_mm) + (S32) (grid->height / 2);
+}
+
+static inline bool _inside(const OGRID *grid, S32 cx, S32 cy) {
+	return (cx >= 0) && (cy >= 0) && ((U32) cx < grid->width) && ((U32) cy < grid->height);
+}
+
+static inline S8 *_cell(const OGRID *grid, S32 cx, S32 cy) {
+	U32 tile = (cy >> OGRID_TILE_BITS) * grid->tiles_x + (cx >> OGRID_TILE_BITS);
+
+	return &grid->cells[tile * OGRID_TILE_CELLS + ((cy & OGRID_TILE_MASK) << OGRID_TILE_BITS) + (cx & OGRID_TILE_MASK)];
+}
+
+static inline void _add(S8 *cell, S32 delta) {
+	S32 value = *cell + delta;
+
+	if (value > OGRID_LOGODDS_MAX)
+		value = OGRID_LOGODDS_MAX;
+	else if (value < -OGRID_LOGODDS_MAX)
+		value = -OGRID_LOGODDS_MAX;
+	*cell = (S8) value;
+}
+
+/* Ray end point (mm) */
+static void _ray_end(const OGRID_POSE *pose, S32 angle, S32 range_mm, S32 *x, S32 *y) {
+	S32 c, s;
+
+	ogrid_cos_sin(angle, &c, &s);
+	*x = pose->x + ((range_mm * c) >> OGRID_Q14);
+	*y = pose->y + ((range_mm * s) >> OGRID_Q14);
+}
+
+/** Bresenham line stepper state */
+typedef struct {
+	S32 x, y;
+	S32 dx, dy;
+	S32 sx, sy;
+	S32 err;
+} OGRID_LINE;
+
+static void _line_init(OGRID_LINE *line, S32 x0, S32 y0, S32 x1, S32 y1) {
+	line->x = x0;
+	line->y = y0;
+	line->dx = (x1 >= x0) ? (x1 - x0) : (x0 - x1);
+	line->dy = (y1 >= y0) ? (y0 - y1) : (y1 - y0);		// -|dy|
+	line->sx = (x0 < x1) ? 1 : -1;
+	line->sy = (y0 < y1) ? 1 : -1;
+	line->err = line->dx + line->dy;
+}
+
+static void _line_step(OGRID_LINE *line) {
+	S32 e2 = 2 * line->err;
+
+	if (e2 >= line->dy) {
+		line->err += line->dy;
+		line->x += line->sx;
+	}
+	if (e2 <= line->dx) {
+		line->err += line->dx;
+		line->y += line->sy;
+	}
+}
+
+/* Public Routines */
+
+bool ogrid_init(OGRID *grid, U32 width, U32 height, U32 cell_mm) {
+	void *cells;
+
+	memset(grid, 0, sizeof(*grid));
+	width = (width + OGRID_TILE_MASK) & ~OGRID_TILE_MASK;
+	height = (height + OGRID_TILE_MASK) & ~OGRID_TILE_MASK;
+	if ((width == 0) || (height == 0) || (cell_mm == 0))
+		return false;
+	if (0 != posix_memalign(&cells, OGRID_ALIGN, width * height))
+		return false;
+
+	grid->cells = cells;
+	grid->width = width;
+	grid->height = height;
+	grid->tiles_x = width >> OGRID_TILE_BITS;
+	grid->cell_mm = cell_mm;
+	ogrid_clear(grid);
+	return true;
+}
+
+void ogrid_free(OGRID *grid) {
+	free(grid->cells);
+	grid->cells = NULL;
+}
+
+void ogrid_clear(OGRID *grid) {
+	memset(grid->cells, 0, grid->width * grid->height);
+	grid->updates = 0;
+}
+
+void ogrid_cos_sin(S32 angle, S32 *cos_q14, S32 *sin_q14) {
+	*cos_q14 = _sin(angle + OGRID_QUARTER);
+	*sin_q14 = _sin(angle);
+}
+
+U32 ogrid_update(OGRID *grid, const OGRID_POSE *pose, S32 bearing, S32 range_mm, S32 max_range_mm) {
+	OGRID_LINE line;
+	S32 ex, ey, cx1, cy1;
+	bool hit = (range_mm < max_range_mm);
+	U32 steps = 0;
+
+	if (range_mm < 0)
+		return 0;
+	if (!hit)
+		range_mm = max_range_mm;
+	_ray_end(pose, pose->heading + bearing, range_mm, &ex, &ey);
+	cx1 = _cell_x(grid, ex);
+	cy1 = _cell_y(grid, ey);
+	_line_init(&line, _cell_x(grid, pose->x), _cell_y(grid, pose->y), cx1, cy1);
+	grid->updates++;
+
+	// Cells up to (not including) the end cell are free
+	while (((line.x != cx1) || (line.y != cy1)) && (steps < OGRID_MAX_RAY_CELLS)) {
+		if (!_inside(grid, line.x, line.y))
+			return steps;
+		_add(_cell(grid, line.x, line.y), OGRID_FREE_DELTA);
+		steps++;
+		_line_step(&line);
+	}
+
+	if (hit && (steps < OGRID_MAX_RAY_CELLS) && _inside(grid, cx1, cy1)) {
+		_add(_cell(grid, cx1, cy1), OGRID_OCC_DELTA);
+		steps++;
+	}
+	return steps;
+}
+
+S32 ogrid_get(const OGRID *grid, S32 x, S32 y) {
+	S32 cx = _cell_x(grid, x);
+	S32 cy = _cell_y(grid, y);
+
+	return _inside(grid, cx, cy) ? *_cell(grid, cx, cy) : 0;
+}
+
+S32 ogrid_freest_direction(const OGRID *grid, const OGRID_POSE *pose, U32 num_dirs, S32 max_range_mm,
+						   S32 *clearance_mm) {
+	OGRID_LINE line;
+	S32 ex, ey, cx0, cy0, cx1, cy1, value;
+	S32 bearing, best_bearing = 0, best_clearance = 0;
+	U32 dir, steps, score, best_score = 0;
+
+	if (num_dirs == 0)
+		num_dirs = 1;
+	cx0 = _cell_x(grid, pose->x);
+	cy0 = _cell_y(grid, pose->y);
+
+	for (dir = 0; dir < num_dirs; dir++) {
+		bearing = (S32) ((dir * OGRID_ANGLES) / num_dirs);
+		_ray_end(pose, pose->heading + bearing, max_range_mm, &ex, &ey);
+		cx1 = _cell_x(grid, ex);
+		cy1 = _cell_y(grid, ey);
+		_line_init(&line, cx0, cy0, cx1, cy1);
+		_line_step(&line);								// Skip the robot cell
+
+		for (steps = 0, score = 0; steps < OGRID_MAX_RAY_CELLS; steps++) {
+			if (!_inside(grid, line.x, line.y))
+				break;
+			value = *_cell(grid, line.x, line.y);
+			if (value > OGRID_OCC_THRESHOLD)
+				break;
+			score += (value < 0) ? 2 : 1;				// Prefer known free space
+			if ((line.x == cx1) && (line.y == cy1))
+				break;
+			_line_step(&line);
+		}
+
+		if ((dir == 0) || (score > best_score)) {
+			best_score = score;
+			best_bearing = bearing;
+			best_clearance = (S32) (steps * grid->cell_mm);
+		}
+	}
+
+	if (clearance_mm)
+		*clearance_mm = (best_clearance < max_range_mm) ? best_clearance : max_range_mm;
+	return best_bearing;
+}
+
+bool ogrid_dump(const OGRID *grid, const OGRID_POSE *pose, const char *path) {
+	FILE *f;
+	S32 cx, cy, robot_x = -1, robot_y = -1;
+	S32 value;
+	bool ok;
+
+	if (!(f = fopen(path, "wb")))
+		return false;
+	if (pose) {
+		robot_x = _cell_x(grid, pose->x);
+		robot_y = _cell_y(grid, pose->y);
+	}
+
+	fprintf(f, "P5\n# ARM-BBR occupancy grid, %lu mm cells, %lu readings\n%lu %lu\n255\n",
+			grid->cell_mm, grid->updates, grid->width, grid->height);
+	for (cy = (S32) grid->height - 1; cy >= 0; cy--) {
+		for (cx = 0; cx < (S32) grid->width; cx++) {
+			if ((cx == robot_x) && (cy == robot_y))
+				value = 64;
+			else											// +OGRID_LOGODDS_MAX: 0 (black), -OGRID_LOGODDS_MAX: 255 (white)
+				value = 128 - (*_cell(grid, cx, cy) * 127) / OGRID_LOGODDS_MAX;
+			fputc(value, f);
+		}
+	}
+	ok = !ferror(f);
+	return (0 == fclose(f)) && ok;
+}
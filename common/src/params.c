@@ -0,0 +1,246 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   params.c
+ *  \brief  ARM-BBR live-tunable parameter store routines
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ev3dev-arm-ctypes.h"
+#include <stdbool.h>
+#include "params.h"
+
+#define PRM_FNV_OFFSET     2166136261U
+#define PRM_FNV_PRIME      16777619U
+#define PRM_SNAPSHOT_TRIES 100							// Give up waiting for a writer that died
+
+volatile S32 *prm_values = NULL;
+
+static volatile U32 *prm_header;					// Start of the mapped (or private) region
+static size_t prm_size;
+static bool prm_shared;
+static const PRM_DEF *prm_defs;
+static U32 prm_num;
+
+/* Internal Routines */
+
+static U32 _fnv_bytes(U32 hash, const void *data, size_t len) {
+	const U8 *p = data;
+
+	while (len--) {
+		hash ^= *p++;
+		hash *= PRM_FNV_PRIME;
+	}
+	return hash;
+}
+
+static U32 _fnv_word(U32 hash, U32 value) {
+	U8 buf[4] = { value & 0xFF, (value >> 8) & 0xFF, (value >> 16) & 0xFF, (value >> 24) & 0xFF };
+
+	return _fnv_bytes(hash, buf, sizeof(buf));
+}
+
+/* Schema hash: names, types and limits, so that a changed table resets the file to the new defaults */
+static U32 _schema(const PRM_DEF *defs, U32 count) {
+	U32 hash = PRM_FNV_OFFSET;
+	U32 i;
+
+	for (i = 0; i < count; i++) {
+		hash = _fnv_bytes(hash, defs[i].name, strlen(defs[i].name) + 1);
+		hash = _fnv_word(hash, defs[i].type);
+		hash = _fnv_word(hash, (U32) defs[i].def);
+		hash = _fnv_word(hash, (U32) defs[i].min);
+		hash = _fnv_word(hash, (U32) defs[i].max);
+	}
+	return hash;
+}
+
+static size_t _file_size(U32 count) {
+	return (PRM_HDR_WORDS + count) * sizeof(U32) + count * sizeof(PRM_ENTRY);
+}
+
+static bool _in_range(const PRM_DEF *def, S32 value) {
+	if (def->type == PRM_U32)
+		return ((U32) value >= (U32) def->min) && ((U32) value <= (U32) def->max);
+	return (value >= def->min) && (value <= def->max);
+}
+
+/* Count and check the definitions */
+static U32 _count(const PRM_DEF *defs) {
+	U32 count;
+
+	for (count = 0; defs[count].name; count++) {
+		if ((count >= PRM_MAX_PARAMS) || (strlen(defs[count].name) >= PRM_NAME_SIZE)
+			|| (defs[count].type > PRM_BOOL) || !_in_range(&defs[count], defs[count].def))
+			return 0;
+	}
+	return count;
+}
+
+static void _init_file(volatile U32 *header, const PRM_DEF *defs, U32 count, U32 schema) {
+	PRM_ENTRY *entries = (PRM_ENTRY *) &header[PRM_HDR_WORDS + count];
+	U32 i;
+
+	memset((void *) header, 0, _file_size(count));
+	for (i = 0; i < count; i++) {
+		header[PRM_HDR_WORDS + i] = (U32) defs[i].def;
+		strcpy(entries[i].name, defs[i].name);
+		entries[i].type = defs[i].type;
+		entries[i].def = defs[i].def;
+		entries[i].min = defs[i].min;
+		entries[i].max = defs[i].max;
+	}
+	header[PRM_HDR_VERSION] = PRM_FILE_VERSION;
+	header[PRM_HDR_SCHEMA] = schema;
+	header[PRM_HDR_COUNT] = count;
+	__atomic_store_n(&header[PRM_HDR_MAGIC], PRM_FILE_MAGIC, __ATOMIC_RELEASE);		// Valid from now on
+}
+
+/* Keep the values of a file created with the same table, replacing any value out of range */
+static bool _reuse_file(volatile U32 *header, const PRM_DEF *defs, U32 count, U32 schema) {
+	U32 i;
+
+	if ((header[PRM_HDR_MAGIC] != PRM_FILE_MAGIC) || (header[PRM_HDR_VERSION] != PRM_FILE_VERSION)
+		|| (header[PRM_HDR_SCHEMA] != schema) || (header[PRM_HDR_COUNT] != count))
+		return false;
+
+	if (header[PRM_HDR_SEQ] & 1)
+		header[PRM_HDR_SEQ]++;						// The last writer died during an update
+	for (i = 0; i < count; i++) {
+		if (!_in_range(&defs[i], (S32) header[PRM_HDR_WORDS + i]))
+			header[PRM_HDR_WORDS + i] = (U32) defs[i].def;
+	}
+	return true;
+}
+
+/* Public Routines */
+
+volatile S32 *prm_open(const char *path, const PRM_DEF *defs) {
+	struct stat st;
+	void *mem = MAP_FAILED;
+	U32 count, schema;
+	size_t size;
+	bool reuse = false;
+	int fd;
+
+	prm_close();
+	if (0 == (count = _count(defs)))
+		return NULL;
+	schema = _schema(defs, count);
+	size = _file_size(count);
+
+	fd = open(path ? path : PRM_DEFAULT_PATH, O_RDWR | O_CREAT, 0666);
+	if (fd >= 0) {
+		reuse = (0 == fstat(fd, &st)) && ((size_t) st.st_size == size);
+		if (reuse || (0 == ftruncate(fd, size)))
+			mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		close(fd);									// The mapping keeps the file open
+	}
+
+	prm_shared = (mem != MAP_FAILED);
+	if (!prm_shared) {
+		reuse = false;
+		if (!(mem = malloc(size)))					// Not tunable, but the robot still runs with the defaults
+			return NULL;
+	}
+
+	prm_header = mem;
+	prm_size = size;
+	prm_defs = defs;
+	prm_num = count;
+	if (!reuse || !_reuse_file(prm_header, defs, count, schema))
+		_init_file(prm_header, defs, count, schema);
+	prm_values = (volatile S32 *) &prm_header[PRM_HDR_WORDS];
+	return prm_values;
+}
+
+void prm_close(void) {
+	if (!prm_header)
+		return;
+	if (prm_shared)
+		munmap((void *) prm_header, prm_size);
+	else
+		free((void *) prm_header);
+	prm_values = NULL;
+	prm_header = NULL;
+	prm_num = 0;
+}
+
+bool prm_is_shared(void) {
+	return prm_header && prm_shared;
+}
+
+U32 prm_count(void) {
+	return prm_num;
+}
+
+S32 prm_find(const char *name) {
+	U32 i;
+
+	for (i = 0; i < prm_num; i++) {
+		if (0 == strcmp(prm_defs[i].name, name))
+			return (S32) i;
+	}
+	return -1;
+}
+
+S32 prm_get(U32 index) {
+	return (index < prm_num) ? prm_values[index] : 0;
+}
+
+bool prm_set(U32 index, S32 value) {
+	U32 seq;
+
+	if ((index >= prm_num) || !_in_range(&prm_defs[index], value))
+		return false;
+
+	seq = __atomic_load_n(&prm_header[PRM_HDR_SEQ], __ATOMIC_RELAXED);
+	__atomic_store_n(&prm_header[PRM_HDR_SEQ], seq + 1, __ATOMIC_RELAXED);		// Odd: update in progress
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	prm_values[index] = value;
+	__atomic_add_fetch(&prm_header[PRM_HDR_GENERATION], 1, __ATOMIC_RELAXED);
+	__atomic_store_n(&prm_header[PRM_HDR_SEQ], seq + 2, __ATOMIC_RELEASE);
+	return true;
+}
+
+U32 prm_generation(void) {
+	return prm_header ? __atomic_load_n(&prm_header[PRM_HDR_GENERATION], __ATOMIC_ACQUIRE) : 0;
+}
+
+bool prm_changed(U32 *last_gen) {
+	U32 gen = prm_generation();
+
+	if (gen == *last_gen)
+		return false;
+	*last_gen = gen;
+	return true;
+}
+
+U32 prm_snapshot(S32 *values) {
+	U32 seq, gen, i, tries = 0;
+
+	if (!prm_header)
+		return 0;
+	do {
+		seq = __atomic_load_n(&prm_header[PRM_HDR_SEQ], __ATOMIC_ACQUIRE);
+		gen = prm_header[PRM_HDR_GENERATION];
+		for (i = 0; i < prm_num; i++)
+			values[i] = prm_values[i];
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (!(seq & 1) && (seq == __atomic_load_n(&prm_header[PRM_HDR_SEQ], __ATOMIC_RELAXED)))
+			break;
+		sched_yield();								// Let the writer finish (the EV3 has a single core)
+	} while (++tries < PRM_SNAPSHOT_TRIES);			// Each value is still valid if the writer died
+	return gen;
+}
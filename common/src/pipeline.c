@@ -0,0 +1,323 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   pipeline.c
+ *  \brief  ARM-BBR sense/decide/act pipeline routines
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include "ev3dev-arm-ctypes.h"
+#include <stdbool.h>
+#include "pipeline.h"
+#include "systick.h"
+
+#define PPLN_TB_FRESH   0x04					// Middle slot holds unread data
+#define PPLN_TB_INDEX   0x03
+#define PPLN_WAIT_US    1000					// Poll interval while waiting for the first input
+
+typedef struct {
+	PPLN_STAGE_FUNC func;
+	U32 period;
+	U32 priority;
+	PPLN_TRIPLEBUF *in;
+	PPLN_TRIPLEBUF *out;
+	void *out_data;								// Stage owned output buffer
+	pthread_t thread;
+	bool started;
+
+	// Statistics (written by the stage thread only)
+	U32 runs;
+	U32 overruns;
+	U32 last_seq;
+	U32 skipped;
+	U32 exec_min, exec_max;
+	unsigned long long exec_total;
+	U32 age_min, age_max, age_count;
+	unsigned long long age_total;
+	U32 lat_min, lat_max, lat_count;
+	unsigned long long lat_total;
+} PPLN_STAGE;
+
+static PPLN_TRIPLEBUF world_tb;
+static PPLN_TRIPLEBUF command_tb;
+static PPLN_STAGE stages[PPLN_NUM_STAGES];
+static bool ppln_running;
+
+static const char *stage_names[PPLN_NUM_STAGES] = { "sense", "decide", "act" };
+
+/* Internal Routines */
+
+static inline void _update_minmax(U32 value, U32 *min, U32 *max, unsigned long long *total) {
+	if (value < *min)
+		*min = value;
+	if (value > *max)
+		*max = value;
+	*total += value;
+}
+
+static void _run_stage(PPLN_STAGE *st) {
+	const void *in = NULL;
+	U32 seq = 0, origin, start, end;
+
+	start = tick_systick();
+	if (st->in) {
+		in = ppln_tb_read(st->in, &seq, &origin);
+		if (seq == 0)
+			return;									// No input published yet
+		if (seq != st->last_seq) {
+			if (st->last_seq && (seq - st->last_seq > 1))
+				st->skipped += seq - st->last_seq - 1;
+			_update_minmax(start - origin, &st->age_min, &st->age_max, &st->age_total);
+			st->age_count++;
+		}
+	} else
+		origin = start;								// Sense stage: the world state originates here
+
+	st->func(in, st->out_data);
+	end = tick_systick();
+	_update_minmax(end - start, &st->exec_min, &st->exec_max, &st->exec_total);
+	st->runs++;
+
+	if (st->out)
+		ppln_tb_publish(st->out, st->out_data, origin);
+	else if (seq != st->last_seq) {
+		_update_minmax(end - origin, &st->lat_min, &st->lat_max, &st->lat_total);
+		st->lat_count++;
+	}
+	st->last_seq = seq;
+}
+
+static void *_stage_thread(void *arg) {
+	PPLN_STAGE *st = (PPLN_STAGE *) arg;
+	U32 next = tick_systick();
+	U32 now;
+
+	while (__atomic_load_n(&ppln_running, __ATOMIC_ACQUIRE)) {
+		_run_stage(st);
+		if (st->runs == 0) {
+			usleep(PPLN_WAIT_US);
+			next = tick_systick();
+			continue;
+		}
+
+		next += st->period;							// Absolute deadlines, so that sleep overshoot does not accumulate
+		now = tick_systick();
+		if (tick_is_due_within(now, next, st->period)) {
+			st->overruns++;
+			if (!tick_is_due(now, next) || ((now - next) >= st->period))
+				next = now;							// Fell behind, don't try to catch up
+		} else
+			usleep(next - now);
+	}
+	return NULL;
+}
+
+static void _reset_stats(PPLN_STAGE *st) {
+	st->runs = st->overruns = st->last_seq = st->skipped = 0;
+	st->exec_min = st->age_min = st->lat_min = 0xFFFFFFFF;
+	st->exec_max = st->age_max = st->lat_max = 0;
+	st->exec_total = st->age_total = st->lat_total = 0;
+	st->age_count = st->lat_count = 0;
+}
+
+static bool _create_thread(PPLN_STAGE *st) {
+	pthread_attr_t attr;
+	struct sched_param param;
+	bool created = false;
+
+	if (st->priority && (0 == pthread_attr_init(&attr))) {
+		param.sched_priority = st->priority;
+		pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+		pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+		pthread_attr_setschedparam(&attr, &param);
+		created = (0 == pthread_create(&st->thread, &attr, _stage_thread, st));
+		pthread_attr_destroy(&attr);
+	}
+	// Not permitted (no CAP_SYS_NICE) or not requested: inherit the caller's scheduling
+	if (!created)
+		created = (0 == pthread_create(&st->thread, NULL, _stage_thread, st));
+	return created;
+}
+
+/* Public Routines */
+
+bool ppln_tb_init(PPLN_TRIPLEBUF *tb, U32 size) {
+	memset(tb, 0, sizeof(*tb));
+	if ((size == 0) || !(tb->data = calloc(PPLN_TB_SLOTS, size)))
+		return false;
+	tb->size = size;
+	tb->back = 0;
+	tb->middle = 1;
+	tb->front = 2;
+	return true;
+}
+
+U32 ppln_tb_publish(PPLN_TRIPLEBUF *tb, const void *data, U32 origin) {
+	U32 old;
+
+	memcpy(tb->data + tb->back * tb->size, data, tb->size);
+	tb->seq[tb->back] = ++tb->write_seq;
+	tb->origin[tb->back] = origin;
+
+	// Release: the slot contents are visible before the reader can take the slot
+	old = __atomic_exchange_n(&tb->middle, tb->back | PPLN_TB_FRESH, __ATOMIC_ACQ_REL);
+	if (old & PPLN_TB_FRESH)
+		tb->overwritten++;
+	tb->back = old & PPLN_TB_INDEX;
+	return tb->write_seq;
+}
+
+const void *ppln_tb_read(PPLN_TRIPLEBUF *tb, U32 *seq, U32 *origin) {
+	U32 old;
+
+	if (__atomic_load_n(&tb->middle, __ATOMIC_RELAXED) & PPLN_TB_FRESH) {
+		old = __atomic_exchange_n(&tb->middle, tb->front, __ATOMIC_ACQ_REL);
+		tb->front = old & PPLN_TB_INDEX;
+	}
+	*seq = tb->seq[tb->front];
+	if (origin)
+		*origin = tb->origin[tb->front];
+	return tb->data + tb->front * tb->size;
+}
+
+void ppln_tb_free(PPLN_TRIPLEBUF *tb) {
+	free(tb->data);
+	tb->data = NULL;
+}
+
+bool ppln_init(U32 world_size, U32 command_size) {
+	if (ppln_running)
+		return false;
+	if (!ppln_tb_init(&world_tb, world_size))
+		return false;
+	if (!ppln_tb_init(&command_tb, command_size)) {
+		ppln_tb_free(&world_tb);
+		return false;
+	}
+
+	memset(stages, 0, sizeof(stages));
+	stages[PPLN_STAGE_SENSE].out = &world_tb;
+	stages[PPLN_STAGE_DECIDE].in = &world_tb;
+	stages[PPLN_STAGE_DECIDE].out = &command_tb;
+	stages[PPLN_STAGE_ACT].in = &command_tb;
+	stages[PPLN_STAGE_SENSE].out_data = calloc(1, world_size);
+	stages[PPLN_STAGE_DECIDE].out_data = calloc(1, command_size);
+	if (!stages[PPLN_STAGE_SENSE].out_data || !stages[PPLN_STAGE_DECIDE].out_data) {
+		ppln_exit();
+		return false;
+	}
+	return true;
+}
+
+bool ppln_set_stage(U32 stage, PPLN_STAGE_FUNC func, U32 period_us, U32 priority) {
+	if ((stage >= PPLN_NUM_STAGES) || !func || (period_us == 0) || (priority > 99) || ppln_running)
+		return false;
+	stages[stage].func = func;
+	stages[stage].period = period_us;
+	stages[stage].priority = priority;
+	return true;
+}
+
+bool ppln_start(void) {
+	U32 i;
+
+	if (ppln_running || !world_tb.data || !command_tb.data)
+		return false;
+	for (i = 0; i < PPLN_NUM_STAGES; i++) {
+		if (!stages[i].func)
+			return false;
+		_reset_stats(&stages[i]);
+	}
+
+	ppln_running = true;
+	for (i = 0; i < PPLN_NUM_STAGES; i++) {
+		stages[i].started = _create_thread(&stages[i]);
+		if (!stages[i].started) {
+			ppln_stop();
+			return false;
+		}
+	}
+	return true;
+}
+
+void ppln_stop(void) {
+	U32 i;
+
+	__atomic_store_n(&ppln_running, false, __ATOMIC_RELEASE);
+	for (i = 0; i < PPLN_NUM_STAGES; i++) {
+		if (stages[i].started) {
+			pthread_join(stages[i].thread, NULL);
+			stages[i].started = false;
+		}
+	}
+}
+
+bool ppln_is_running(void) {
+	return __atomic_load_n(&ppln_running, __ATOMIC_ACQUIRE);
+}
+
+bool ppln_get_stats(U32 stage, PPLN_STATS *stats) {
+	PPLN_STAGE *st;
+
+	if (stage >= PPLN_NUM_STAGES)
+		return false;
+	st = &stages[stage];
+
+	memset(stats, 0, sizeof(*stats));
+	stats->runs = st->runs;
+	stats->overruns = st->overruns;
+	stats->skipped = st->skipped;
+	if (st->runs) {
+		stats->exec_min = st->exec_min;
+		stats->exec_max = st->exec_max;
+		stats->exec_avg = (U32) (st->exec_total / st->runs);
+	}
+	if (st->age_count) {
+		stats->age_min = st->age_min;
+		stats->age_max = st->age_max;
+		stats->age_avg = (U32) (st->age_total / st->age_count);
+	}
+	if (st->lat_count) {
+		stats->latency_min = st->lat_min;
+		stats->latency_max = st->lat_max;
+		stats->latency_avg = (U32) (st->lat_total / st->lat_count);
+	}
+	return true;
+}
+
+void ppln_report(void) {
+	PPLN_STATS stats;
+	U32 i;
+
+	fprintf(stderr, "pipeline: %-6s %8s %8s %8s  %-20s  %-20s\n", "stage", "runs", "overrun", "skipped",
+			"exec min/avg/max", "input age min/avg/max");
+	for (i = 0; i < PPLN_NUM_STAGES; i++) {
+		ppln_get_stats(i, &stats);
+		fprintf(stderr, "pipeline: %-6s %8lu %8lu %8lu  %6lu/%6lu/%6lu  %6lu/%6lu/%6lu\n", stage_names[i],
+				stats.runs, stats.overruns, stats.skipped, stats.exec_min, stats.exec_avg, stats.exec_max,
+				stats.age_min, stats.age_avg, stats.age_max);
+	}
+	ppln_get_stats(PPLN_STAGE_ACT, &stats);
+	fprintf(stderr, "pipeline: sense-to-act latency min/avg/max %lu/%lu/%lu us\n",
+			stats.latency_min, stats.latency_avg, stats.latency_max);
+}
+
+void ppln_exit(void) {
+	ppln_stop();
+	ppln_tb_free(&world_tb);
+	ppln_tb_free(&command_tb);
+	free(stages[PPLN_STAGE_SENSE].out_data);
+	free(stages[PPLN_STAGE_DECIDE].out_data);
+	stages[PPLN_STAGE_SENSE].out_data = NULL;
+	stages[PPLN_STAGE_DECIDE].out_data = NULL;
+}
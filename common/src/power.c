@@ -0,0 +1,239 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   power.c
+ *  \brief  ARM-BBR battery monitor and energy accounting routines
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include "ev3dev-arm-ctypes.h"
+#include <stdbool.h>
+#include "fastattr.h"
+#include "power.h"
+#include "systick.h"
+
+#define PWR_NO_BEHAVIOR    -1
+
+typedef struct {
+	const char *name;
+	U32 type;										// PWR_ACCT_XXX
+	S32 duty_fd;									// Actuators only
+	S32 duty;										// Last duty cycle magnitude (%)
+	unsigned long long energy;						// uJ
+} PWR_ACCOUNT;
+
+static PWR_ACCOUNT accounts[PWR_MAX_ACCOUNTS] = { { "no_motors", PWR_ACCT_IDLE, -1, 0, 0 } };
+static U32 num_accounts = 1;
+static S32 voltage_fd = -1;
+static S32 current_fd = -1;
+static U32 nominal;									// mV
+static U32 voltage;									// Smoothed, mV << PWR_SMOOTH_SHIFT
+static U32 current;									// Smoothed, mA << PWR_SMOOTH_SHIFT
+static S32 behavior = PWR_NO_BEHAVIOR;
+static U32 last_sample;
+static U32 next_due;
+static bool sampled;
+static unsigned long long total_energy;				// uJ
+static pthread_t pwr_thread;
+static bool pwr_running;
+
+/* Internal Routines */
+
+static S32 _open_battery(const char *attr) {
+	char path[sizeof(PWR_BATTERY_PATH) + 16];
+
+	snprintf(path, sizeof(path), "%s%s", PWR_BATTERY_PATH, attr);
+	return open(path, O_RDONLY);
+}
+
+static void _smooth(U32 *avg, U32 sample) {
+	if (!sampled)
+		*avg = sample << PWR_SMOOTH_SHIFT;
+	else
+		*avg += sample - (*avg >> PWR_SMOOTH_SHIFT);	// avg += (sample - avg) / 2^PWR_SMOOTH_SHIFT
+}
+
+/* Charge the energy of one sample period to the accounts */
+static void _charge(unsigned long long energy) {
+	S32 id = __atomic_load_n(&behavior, __ATOMIC_ACQUIRE);
+	S32 duty;
+	U32 i, total_duty = 0;
+
+	total_energy += energy;
+	if ((id > PWR_IDLE_ACCOUNT) && ((U32) id < num_accounts))
+		accounts[id].energy += energy;
+
+	for (i = 1; i < num_accounts; i++) {
+		if (accounts[i].type != PWR_ACCT_ACTUATOR)
+			continue;
+		if (!fattr_read_int(accounts[i].duty_fd, &duty))
+			duty = 0;
+		accounts[i].duty = (duty < 0) ? -duty : duty;
+		total_duty += accounts[i].duty;
+	}
+
+	if (total_duty == 0) {
+		accounts[PWR_IDLE_ACCOUNT].energy += energy;
+		return;
+	}
+	for (i = 1; i < num_accounts; i++) {
+		if (accounts[i].type == PWR_ACCT_ACTUATOR)
+			accounts[i].energy += energy * accounts[i].duty / total_duty;
+	}
+}
+
+static void _sample(U32 now) {
+	S32 uv, ua;
+	U32 mv, ma;
+
+	if (!fattr_read_int(voltage_fd, &uv) || !fattr_read_int(current_fd, &ua))
+		return;
+	mv = (uv > 0) ? uv / 1000 : 0;
+	ma = (ua > 0) ? ua / 1000 : 0;
+
+	// mV * mA = uW, over the period since the last sample (us)
+	if (sampled)
+		_charge((unsigned long long) mv * ma * (now - last_sample) / TICKS_PER_SECOND);
+	last_sample = now;
+
+	_smooth(&voltage, mv);
+	_smooth(&current, ma);
+	__atomic_store_n(&sampled, true, __ATOMIC_RELEASE);
+}
+
+static void *_pwr_thread(void *arg) {
+	(void) arg;
+	while (__atomic_load_n(&pwr_running, __ATOMIC_ACQUIRE)) {
+		tick_sleep_until(pwr_poll(), PWR_PERIOD_US);
+	}
+	return NULL;
+}
+
+static S32 _add_account(const char *name, U32 type, S32 duty_fd) {
+	if ((num_accounts >= PWR_MAX_ACCOUNTS) || pwr_running)
+		return -1;
+	accounts[num_accounts].name = name;
+	accounts[num_accounts].type = type;
+	accounts[num_accounts].duty_fd = duty_fd;
+	return (S32) num_accounts++;
+}
+
+/* Public Routines */
+
+bool pwr_init(U32 nominal_mv) {
+	nominal = nominal_mv;
+	voltage_fd = _open_battery("voltage_now");
+	current_fd = _open_battery("current_now");
+	next_due = tick_systick();
+	return ((voltage_fd >= 0) && (current_fd >= 0));
+}
+
+S32 pwr_add_behavior(const char *name) {
+	return _add_account(name, PWR_ACCT_BEHAVIOR, -1);
+}
+
+S32 pwr_add_actuator(const char *name, U8 sn) {
+	S32 fd = fattr_open_tacho(sn, "duty_cycle", false);
+	S32 id;
+
+	if (fd < 0)
+		return -1;
+	if ((id = _add_account(name, PWR_ACCT_ACTUATOR, fd)) < 0)
+		fattr_close(fd);
+	return id;
+}
+
+void pwr_set_behavior(S32 id) {
+	__atomic_store_n(&behavior, id, __ATOMIC_RELEASE);
+}
+
+U32 pwr_poll(void) {
+	U32 now = tick_systick();
+
+	if ((voltage_fd < 0) || (current_fd < 0))
+		return now + PWR_PERIOD_US;
+	if (tick_is_due_within(now, next_due, PWR_PERIOD_US)) {
+		_sample(now);
+		next_due = now + PWR_PERIOD_US;				// Don't try to catch up
+	}
+	return next_due;
+}
+
+bool pwr_start(void) {
+	if (pwr_running || (voltage_fd < 0) || (current_fd < 0))
+		return false;
+	pwr_running = true;
+	if (0 != pthread_create(&pwr_thread, NULL, _pwr_thread, NULL)) {
+		pwr_running = false;
+		return false;
+	}
+	return true;
+}
+
+void pwr_stop(void) {
+	if (!pwr_running)
+		return;
+	__atomic_store_n(&pwr_running, false, __ATOMIC_RELEASE);
+	pthread_join(pwr_thread, NULL);
+}
+
+U32 pwr_get_voltage(void) {
+	if (!__atomic_load_n(&sampled, __ATOMIC_ACQUIRE))
+		return 0;
+	return __atomic_load_n(&voltage, __ATOMIC_RELAXED) >> PWR_SMOOTH_SHIFT;
+}
+
+U32 pwr_get_current(void) {
+	if (!__atomic_load_n(&sampled, __ATOMIC_ACQUIRE))
+		return 0;
+	return __atomic_load_n(&current, __ATOMIC_RELAXED) >> PWR_SMOOTH_SHIFT;
+}
+
+S32 pwr_compensate(S32 value, S32 limit) {
+	U32 mv = pwr_get_voltage();
+	S32 result;
+
+	if ((mv == 0) || (nominal == 0))
+		return value;								// No reading, leave it alone
+	if (mv * PWR_MAX_GAIN_PCT < nominal * 100)
+		mv = nominal * 100 / PWR_MAX_GAIN_PCT;		// Limit the gain on a flat (or failing) battery
+
+	result = (S32) ((long long) value * (long long) nominal / (long long) mv);
+	if (result > limit)
+		return limit;
+	if (result < -limit)
+		return -limit;
+	return result;
+}
+
+U32 pwr_get_energy(S32 id) {
+	if ((id < 0) || ((U32) id >= num_accounts))
+		return 0;
+	return (U32) (accounts[id].energy / 1000);
+}
+
+U32 pwr_get_total_energy(void) {
+	return (U32) (total_energy / 1000);
+}
+
+void pwr_report(void) {
+	U32 i, total = pwr_get_total_energy();
+
+	fprintf(stderr, "power: %lu mV, %lu mA, %lu mJ total\n", pwr_get_voltage(), pwr_get_current(), total);
+	fprintf(stderr, "power: %-12s %-9s %10s %6s\n", "account", "type", "mJ", "%");
+	for (i = 0; i < num_accounts; i++) {
+		fprintf(stderr, "power: %-12s %-9s %10lu %6lu\n", accounts[i].name,
+				(accounts[i].type == PWR_ACCT_BEHAVIOR) ? "behavior" :
+				(accounts[i].type == PWR_ACCT_ACTUATOR) ? "actuator" : "-",
+				pwr_get_energy(i), total ? pwr_get_energy(i) * 100 / total : 0);
+	}
+}
@@ -0,0 +1,101 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   prng.c
+ *  \brief  ARM-BBR deterministic pseudo random number generator routines
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#include "ev3dev-arm-ctypes.h"
+#include "prng.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <time.h>
+#include <stdint.h>
+
+// xorshift32 state, shared with prng-xorshift.S
+U32 prng_state = PRNG_ZERO_SEED;
+
+static U32 prng_seed_value = PRNG_ZERO_SEED;
+
+/* Internal Routines */
+
+static U32 prng_startup_seed(void)
+{
+	struct timespec now;
+	char *seedstr = getenv(PRNG_SEED_ENV);
+
+	if (seedstr && *seedstr)
+		return (U32) strtoul(seedstr, NULL, 0);
+
+	clock_gettime(CLOCK_REALTIME, &now);
+	return ((U32) getpid() << 16) ^ (U32) now.tv_sec ^ (U32) now.tv_nsec;
+}
+
+/* Public Routines */
+
+U32 prng_init(void)
+{
+	prng_seed(prng_startup_seed());
+
+	// stdout belongs to the LCD, so log the seed where it can be captured for replay
+	fprintf(stderr, PRNG_SEED_ENV "=0x%08lX\n", prng_seed_value);
+	fflush(stderr);
+	return prng_seed_value;
+}
+
+void prng_seed(U32 seed)
+{
+	if (seed == 0)
+		seed = PRNG_ZERO_SEED;
+	prng_seed_value = seed;
+	prng_state = seed;
+}
+
+U32 prng_get_seed(void)
+{
+	return prng_seed_value;
+}
+
+U32 prng_choose_weighted(const U8 *weights, U32 count)
+{
+	U32 i;
+	U32 total = 0;
+	U32 pick;
+
+	for (i = 0; i < count; i++)
+		total += weights[i];
+	if (total == 0)
+		return count;
+
+	pick = prng_range(total);
+	for (i = 0; i < count; i++) {
+		if (pick < weights[i])
+			break;
+		pick -= weights[i];
+	}
+	return i;
+}
+
+U32 prng_next_ref(U32 *state)
+{
+	uint32_t x = (uint32_t) *state;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+	return x;
+}
+
+U32 prng_range_ref(U32 *state, U32 bound)
+{
+	uint64_t product = (uint64_t) (uint32_t) prng_next_ref(state) * (uint32_t) bound;
+
+	return (U32) (product >> 32);
+}
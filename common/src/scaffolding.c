@@ -12,11 +12,17 @@
 
 #include "ev3dev-arm-ctypes.h"
 #include "alerts.h"
+#include "numfmt.h"
 #include "scaffolding.h"
+#include "startup.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <unistd.h>
 #include <string.h>
+#include <sched.h>
+#include <pthread.h>
+#include <malloc.h>
+#include <sys/mman.h>
 
 static bool audible = TRUE;
 
@@ -30,6 +36,13 @@ static bool audible = TRUE;
 #define FBCON_TTYNAME  "/dev/tty"
 #define BUFSIZE 64
 
+#define CPUFREQ_GOVERNOR "/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor"
+#define CPUFREQ_RT_GOVERNOR "performance"
+
+// glibc malloc defaults, restored after real-time mode
+#define MALLOC_TRIM_THRESHOLD_DEFAULT (128 * 1024)
+#define MALLOC_MMAP_MAX_DEFAULT 65536
+
 
 /* Internal Routines */
 //
@@ -46,13 +59,16 @@ static bool audible = TRUE;
 
 static bool is_FBConsole;
 
-// 4-bit Binary LUT
-static const char bit_rep[16][5] = {
-    [ 0] = "0000", [ 1] = "0001", [ 2] = "0010", [ 3] = "0011",
-    [ 4] = "0100", [ 5] = "0101", [ 6] = "0110", [ 7] = "0111",
-    [ 8] = "1000", [ 9] = "1001", [10] = "1010", [11] = "1011",
-    [12] = "1100", [13] = "1101", [14] = "1110", [15] = "1111",
-};
+// Fast start helper thread (font and startup tone)
+static pthread_t fast_start_thread;
+static bool fast_start_active;
+
+// Real-time mode settings to be restored by prog_exit()
+static U32 rt_caps;
+static bool rt_malloc_tuned;
+static int rt_saved_policy;
+static struct sched_param rt_saved_param;
+static char rt_saved_governor[BUFSIZE];
 
 typedef enum {
 	NORMAL_INT,
@@ -127,53 +143,52 @@ static inline bool term_disp_string(char *string)
 	return TRUE;
 }
 
-static void print_bin(U8 value) {
-	printf("0b%s%s", bit_rep[(value & 0xF0) >> 4], bit_rep[value & 0x0F]);
-}
-
 static bool term_disp_value(U32 value, VALTYPE type, U32 width)
 {
+	char buf[NFMT_BUF_SIZE];
+
 	/* It does not make sense to provide alignment for Binary and Hex outputs */
 	switch(type) {
 
 	case SIGNED_INT:
-		printf("%+ld",(S32) value);
+		nfmt_dec(buf, value, 0, NFMT_SIGNED | NFMT_PLUS);
 		break;
 
 	case UNSIGNED_INT:
-		printf("%lu",(U32) value);
+		nfmt_dec(buf, value, 0, 0);
 		break;
 
 	case ALIGNED_INT:
-		printf("%*ld",(int) width, (S32) value);
+		nfmt_dec(buf, value, width, NFMT_SIGNED);
 		break;
 
 	case ALIGNED_SINT:
-		printf("%+*ld",(int) width, (S32) value);
+		nfmt_dec(buf, value, width, NFMT_SIGNED | NFMT_PLUS);
 		break;
 
 	case ALIGNED_UINT:
-		printf("%*lu",(int) width, (S32) value);
+		nfmt_dec(buf, value, width, 0);
 		break;
 
 	case BIN8:
-		print_bin((U8) value & 0xFF);
+		nfmt_bin(buf, value, 8, NFMT_PREFIX);
 		break;
 
 	case HEX8:
-		printf("0x%02X",(U8) value & 0xFF);
+		nfmt_hex(buf, value, 2, NFMT_PREFIX);
 		break;
 
 	case HEX32:
-		printf("0x%08lX",(U32) value);
+		nfmt_hex(buf, value, 8, NFMT_PREFIX);
 		break;
 
 	case NORMAL_INT:
 	default:
-		printf("%ld", (S32) value);
+		nfmt_dec(buf, value, 0, NFMT_SIGNED);
 		break;
 	}
 
+	fputs(buf, stdout);
 	if (!is_FBConsole)
 		fputs("\n",stdout);
 	fflush(stdout);
@@ -181,12 +196,60 @@ static bool term_disp_value(U32 value, VALTYPE type, U32 width)
 }
 
 
-/* Public Routines */
+static bool rt_read_governor(char *governor, size_t size)
+{
+	FILE *f = fopen(CPUFREQ_GOVERNOR, "r");
+	bool retval = FALSE;
 
-void prog_init(void)
+	if (f) {
+		retval = (NULL != fgets(governor, size, f));
+		fclose(f);
+	}
+	return retval;
+}
+
+static bool rt_write_governor(const char *governor)
 {
-	/* Program Initialization Routine */
+	FILE *f = fopen(CPUFREQ_GOVERNOR, "w");
+	bool retval = FALSE;
+
+	if (f) {
+		retval = (fputs(governor, f) >= 0);
+		retval = (fclose(f) == 0) && retval;
+	}
+	return retval;
+}
+
+static void rt_prefault_stack(void)
+{
+	volatile U8 stack[RT_PREFAULT_STACK];
+	U32 i;
+
+	for (i = 0; i < sizeof(stack); i += sysconf(_SC_PAGESIZE))
+		stack[i] = 0;
+}
+
+static bool rt_prefault_heap(void)
+{
+	U8 *heap;
+	U32 i;
+
+	// Keep freed memory in the heap instead of returning it to the kernel
+	mallopt(M_TRIM_THRESHOLD, -1);
+	mallopt(M_MMAP_MAX, 0);
+	rt_malloc_tuned = TRUE;
+
+	heap = malloc(RT_PREFAULT_HEAP);
+	if (!heap)
+		return FALSE;
+	for (i = 0; i < RT_PREFAULT_HEAP; i += sysconf(_SC_PAGESIZE))
+		heap[i] = 0;
+	free(heap);
+	return TRUE;
+}
 
+static void term_init(void)
+{
 	// Check if we're running on Frameb Buffer Console, or else in Debugger w/o ncurses support.
 	char ttynamestr[BUFSIZE];
 	if (0 == ttyname_r(STDOUT_FILENO, ttynamestr, sizeof(ttynamestr))) {
@@ -200,21 +263,111 @@ void prog_init(void)
 
 	term_hidecursor();
 	term_clearscr();
+	stup_mark("prog_init: console");
+}
+
+static void term_setfont_and_hello(void)
+{
 	system("setfont " ARM_BBR_TERMFONT);		// Use legible font for status messages
+	stup_mark("prog_init: setfont");
 	alrt_hello(audible);
+	stup_mark("prog_init: hello tone");
+}
+
+static void *fast_start_helper(void *arg)
+{
+	(void) arg;
+	term_setfont_and_hello();
+	return NULL;
+}
+
+/* Public Routines */
+
+void prog_exit_rt(void)
+{
+	/* Program Real-time Mode Exit Routine */
+	if (rt_malloc_tuned) {
+		mallopt(M_TRIM_THRESHOLD, MALLOC_TRIM_THRESHOLD_DEFAULT);
+		mallopt(M_MMAP_MAX, MALLOC_MMAP_MAX_DEFAULT);
+		rt_malloc_tuned = FALSE;
+	}
+	if (rt_caps & RT_CAP_CPUFREQ)
+		rt_write_governor(rt_saved_governor);
+	if (rt_caps & RT_CAP_MLOCKALL)
+		munlockall();
+	if (rt_caps & RT_CAP_SCHED_FIFO)
+		sched_setscheduler(0, rt_saved_policy, &rt_saved_param);
+	rt_caps = 0;
+}
+
+void prog_init(void)
+{
+	/* Program Initialization Routine */
+	term_init();
+	term_setfont_and_hello();
+}
+
+void prog_init_fast(void)
+{
+	/* Program Fast Start Initialization Routine */
+	term_init();
+
+	// setfont and beep are separate processes which do not affect device discovery
+	fast_start_active = (0 == pthread_create(&fast_start_thread, NULL, fast_start_helper, NULL));
+	if (!fast_start_active)
+		term_setfont_and_hello();
 }
 
 void prog_exit(void)
 {
 	/* Program Exit Routine */
+	if (fast_start_active) {
+		pthread_join(fast_start_thread, NULL);		// Don't overlap the hello and goodbye tones
+		fast_start_active = FALSE;
+	}
 #ifdef RESTORE_SETFONT
 	system("setfont " SYSTEM_TERMFONT);		// Use legible font for status messages
 #endif
+	prog_exit_rt();
 	alrt_goodbye(audible);
 	term_showcursor();
 
 }
 
+U32 prog_init_rt(U32 priority)
+{
+	/* Program Real-time Mode Initialization Routine */
+	struct sched_param param;
+
+	if (priority == 0)
+		priority = RT_PRIORITY_DEFAULT;
+
+	// Lock memory before prefaulting so that the prefaulted pages stay resident
+	if (0 == mlockall(MCL_CURRENT | MCL_FUTURE))
+		rt_caps |= RT_CAP_MLOCKALL;
+
+	rt_prefault_stack();
+	if (rt_prefault_heap())
+		rt_caps |= RT_CAP_PREFAULT;
+
+	if (rt_read_governor(rt_saved_governor, sizeof(rt_saved_governor))
+		&& rt_write_governor(CPUFREQ_RT_GOVERNOR))
+		rt_caps |= RT_CAP_CPUFREQ;
+
+	rt_saved_policy = sched_getscheduler(0);
+	sched_getparam(0, &rt_saved_param);
+	param.sched_priority = (int) priority;
+	if ((rt_saved_policy >= 0) && (0 == sched_setscheduler(0, SCHED_FIFO, &param)))
+		rt_caps |= RT_CAP_SCHED_FIFO;
+
+	// stdout belongs to the LCD
+	fprintf(stderr, "prog_init_rt: sched_fifo(%lu)=%s mlockall=%s prefault=%s cpufreq=%s\n", priority,
+			(rt_caps & RT_CAP_SCHED_FIFO) ? "yes" : "no", (rt_caps & RT_CAP_MLOCKALL) ? "yes" : "no",
+			(rt_caps & RT_CAP_PREFAULT) ? "yes" : "no", (rt_caps & RT_CAP_CPUFREQ) ? "yes" : "no");
+	fflush(stderr);
+	return rt_caps;
+}
+
 void prog_title(char *string)
 {
 	//printf("Debug: prog_title()\n");
@@ -0,0 +1,194 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   sensormgr.c
+ *  \brief  ARM-BBR mode-aware sensor manager routines
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#include <stdlib.h>
+#include "ev3dev-arm-ctypes.h"
+#include "devices.h"
+#include "sensormgr.h"
+#include "systick.h"
+
+typedef struct {
+	bool cached;
+	INX_T mode;
+	U32 settle;										// 0 selects SNSR_SETTLE_US
+	U32 valid_at;									// Systick when values in the current mode are valid
+} SENSOR_STATE;
+
+typedef struct {
+	U8 sn;
+	U8 num_values;
+	INX_T mode;
+	U32 max_age;
+	bool valid;
+	U32 systick;
+	S32 values[SNSR_MAX_VALUES];
+} SNSR_REQUEST;
+
+static SENSOR_STATE sensors[DESC_LIMIT];
+static SNSR_REQUEST requests[SNSR_MAX_REQUESTS];
+static U32 num_requests;
+static U32 num_switches;
+static U32 num_suppressed;
+
+/* Internal Routines */
+
+static bool _read_request(SNSR_REQUEST *req, U32 now) {
+	int buf[SNSR_MAX_VALUES];
+	U32 i;
+
+	for (i = 0; i < req->num_values; i++) {
+		if (!get_sensor_value(i, req->sn, &buf[i]))
+			return false;
+	}
+	for (i = 0; i < req->num_values; i++)
+		req->values[i] = buf[i];
+	req->systick = now;
+	req->valid = true;
+	return true;
+}
+
+static void _cache_mode(U8 sn) {
+	SENSOR_STATE *st = &sensors[sn];
+
+	st->mode = get_sensor_mode_inx(sn);					// Reading the mode is much cheaper than switching
+	st->cached = true;
+	st->valid_at = tick_systick();
+}
+
+/* Service all requests for one sensor: batch reads in the current mode, then switch modes if needed */
+static U32 _poll_sensor(U8 sn, U32 first, U32 now) {
+	SENSOR_STATE *st = &sensors[sn];
+	SNSR_REQUEST *req, *urgent = NULL;
+	U32 settle = st->settle ? st->settle : SNSR_SETTLE_US;
+	U32 i, updated = 0;
+	S32 slack, min_slack = 0;
+
+	if (!tick_is_due(now, st->valid_at))
+		return 0;										// Mode switch in progress, values are stale
+
+	for (i = first; i < num_requests; i++) {
+		req = &requests[i];
+		if (req->sn != sn)
+			continue;
+		if (req->mode == st->mode) {
+			if (_read_request(req, now))
+				updated++;
+			continue;
+		}
+		// Time left before this request's value becomes too old, allowing for the switch
+		slack = req->valid ? (S32) (req->systick + req->max_age - settle - now) : 0;
+		if (!urgent || (slack < min_slack)) {
+			urgent = req;
+			min_slack = slack;
+		}
+	}
+
+	if (urgent && (min_slack <= 0))
+		snsr_set_mode(sn, urgent->mode);
+	return updated;
+}
+
+/* Public Routines */
+
+bool snsr_set_mode(U8 sn, INX_T mode_inx) {
+	SENSOR_STATE *st;
+
+	if (sn >= DESC_LIMIT)
+		return false;
+	st = &sensors[sn];
+
+	if (!st->cached)
+		_cache_mode(sn);
+	if (st->mode == mode_inx) {
+		num_suppressed++;
+		return true;
+	}
+
+	if (set_sensor_mode_inx(sn, mode_inx) == 0) {
+		st->cached = false;								// Unknown state
+		return false;
+	}
+	st->mode = mode_inx;
+	st->valid_at = tick_systick() + (st->settle ? st->settle : SNSR_SETTLE_US);
+	num_switches++;
+	return true;
+}
+
+S32 snsr_get_mode(U8 sn) {
+	if ((sn >= DESC_LIMIT) || !sensors[sn].cached)
+		return SNSR_MODE_UNKNOWN;
+	return (S32) sensors[sn].mode;
+}
+
+void snsr_invalidate(U8 sn) {
+	if (sn < DESC_LIMIT)
+		sensors[sn].cached = false;
+}
+
+void snsr_set_settle(U8 sn, U32 settle_us) {
+	if (sn < DESC_LIMIT)
+		sensors[sn].settle = settle_us;
+}
+
+S32 snsr_request(U8 sn, INX_T mode_inx, U32 max_age_us, U32 num_values) {
+	SNSR_REQUEST *req;
+
+	if ((sn >= DESC_LIMIT) || (num_requests >= SNSR_MAX_REQUESTS) || (num_values == 0) || (num_values > SNSR_MAX_VALUES))
+		return -1;
+
+	req = &requests[num_requests];
+	req->sn = sn;
+	req->mode = mode_inx;
+	req->max_age = max_age_us;
+	req->num_values = num_values;
+	req->valid = false;
+	return (S32) num_requests++;
+}
+
+U32 snsr_poll(void) {
+	U32 now = tick_systick();
+	U32 i, j, updated = 0;
+	bool seen;
+
+	for (i = 0; i < num_requests; i++) {
+		// Poll each sensor once, starting from its first request
+		seen = false;
+		for (j = 0; j < i; j++)
+			seen = seen || (requests[j].sn == requests[i].sn);
+		if (seen)
+			continue;
+		if (!sensors[requests[i].sn].cached)
+			_cache_mode(requests[i].sn);
+		updated += _poll_sensor(requests[i].sn, i, now);
+	}
+	return updated;
+}
+
+bool snsr_get_value(U32 request, U32 inx, S32 *value, U32 *systick) {
+	SNSR_REQUEST *req;
+
+	if ((request >= num_requests) || (inx >= requests[request].num_values) || !requests[request].valid)
+		return false;
+
+	req = &requests[request];
+	*value = req->values[inx];
+	if (systick)
+		*systick = req->systick;
+	return true;
+}
+
+void snsr_get_stats(U32 *switches, U32 *suppressed) {
+	if (switches)
+		*switches = num_switches;
+	if (suppressed)
+		*suppressed = num_suppressed;
+}
@@ -0,0 +1,299 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   smux.c
+ *  \brief  ARM-BBR sensor multiplexer polling scheduler routines
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "ev3dev-arm-ctypes.h"
+#include "devices.h"
+#include "smux.h"
+#include "systick.h"
+
+#define SMUX_CONFIG_RETRIES    3					// Sensor search attempts before giving up on a channel
+#define SMUX_IDLE_US       10000					// Maximum background thread sleep
+#define SMUX_MODE_NONE        -2					// No pending mode change
+
+typedef struct {
+	// Configuration
+	INX_T type_inx;
+	INX_T channel_mode;								// Mux channel port mode
+	U8 port;
+	U8 extport;
+	U8 sn_port;
+	U8 sn;
+	U8 num_values;
+	U8 retries;
+	bool device_set;
+	U32 period;										// Ticks
+	U32 settle;										// Ticks
+
+	// Scheduling
+	U8 state;
+	S32 mode_inx;
+	S32 pending_mode;								// Set by smux_set_mode(), applied by smux_poll()
+	U32 mode_gen;									// Incremented by each mode change
+	U32 applied_gen;								// mode_gen of the mode applied to the sensor
+	U32 ready_at;									// Systick when configuration has settled
+	U32 next_due;
+
+	// Published readings (seqlock)
+	U32 seq;
+	U32 value_gen;
+	U32 systick;
+	S32 values[SMUX_MAX_VALUES];
+	U32 reads;
+	U32 late;
+} SMUX_CHANNEL;
+
+static SMUX_CHANNEL channels[SMUX_MAX_CHANNELS];
+static U32 num_channels;
+static U32 rr_next;									// Next channel to be considered
+static pthread_t smux_thread;
+static bool smux_running;
+
+/* Internal Routines */
+
+static U32 _default_settle(INX_T channel_mode) {
+	switch ( channel_mode ) {
+	case MS_EV3_SMUX_UART:
+		return SMUX_SETTLE_UART_US;
+	case HT_NXT_SMUX_I2C:
+		return SMUX_SETTLE_I2C_US;
+	default:
+		return SMUX_SETTLE_ANALOG_US;
+	}
+}
+
+static void _apply_mode(SMUX_CHANNEL *ch, U32 now) {
+	if (ch->mode_inx != SMUX_MODE_DEFAULT) {
+		set_sensor_mode_inx(ch->sn, ch->mode_inx);
+		ch->state = SMUX_CH_SETTLING;
+		ch->ready_at = now + SMUX_SETTLE_MODE_US;
+	} else {
+		ch->state = SMUX_CH_ACTIVE;
+		ch->ready_at = now;
+	}
+	ch->next_due = ch->ready_at;
+}
+
+/* Advance a channel which is not yet active, without blocking */
+static void _configure(SMUX_CHANNEL *ch, U32 now) {
+
+	if (!tick_is_due(now, ch->ready_at))
+		return;
+
+	switch ( ch->state ) {
+	case SMUX_CH_CONFIGURING:
+		// Analog sensors cannot be detected automatically
+		if (!ch->device_set && (ch->channel_mode == MS_EV3_SMUX_ANALOG || ch->channel_mode == HT_NXT_SMUX_ANALOG)) {
+			set_port_set_device(ch->sn_port, (char *) ev3_sensor_type(ch->type_inx));
+			ch->device_set = true;
+			ch->ready_at = now + ch->settle;
+			return;
+		}
+		ev3_sensor_init();											// Populate sensor descriptors
+		if (dvcs_search_sensor_type_for_port(ch->type_inx, ch->port, ch->extport, &ch->sn)) {
+			_apply_mode(ch, now);
+		} else if (++ch->retries >= SMUX_CONFIG_RETRIES) {
+			ch->state = SMUX_CH_FAILED;
+		} else {
+			ch->ready_at = now + ch->settle;
+		}
+		break;
+
+	case SMUX_CH_SETTLING:
+		ch->state = SMUX_CH_ACTIVE;
+		break;
+	}
+}
+
+static void _read(SMUX_CHANNEL *ch, U32 now) {
+	int buf[SMUX_MAX_VALUES];
+	bool ok = true;
+	U32 i;
+
+	for (i = 0; i < ch->num_values; i++)
+		ok = get_sensor_value(i, ch->sn, &buf[i]) && ok;
+
+	if (ok) {
+		__atomic_store_n(&ch->seq, ch->seq + 1, __ATOMIC_RELAXED);	// Odd: update in progress
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+		for (i = 0; i < ch->num_values; i++)
+			ch->values[i] = buf[i];
+		ch->systick = now;
+		ch->value_gen = ch->applied_gen;
+		ch->reads++;
+		__atomic_store_n(&ch->seq, ch->seq + 1, __ATOMIC_RELEASE);
+	}
+
+	if ((now - ch->next_due) >= ch->period) {
+		ch->late++;
+		ch->next_due = now + ch->period;						// Fell behind, don't try to catch up
+	} else
+		ch->next_due += ch->period;
+}
+
+static void *_smux_thread(void *arg) {
+	(void) arg;
+	while (__atomic_load_n(&smux_running, __ATOMIC_ACQUIRE)) {
+		tick_sleep_until(smux_poll(0), SMUX_IDLE_US);
+	}
+	return NULL;
+}
+
+/* Public Routines */
+
+S32 smux_add_channel(INX_T mux_type_inx, U8 port, U8 extport, INX_T type_inx, S32 mode_inx,
+					 U32 rate_hz, U32 num_values, U32 settle_us) {
+
+	SMUX_CHANNEL *ch;
+	INX_T channel_mode = dvcs_mux_channel_mode_inx(mux_type_inx, type_inx);
+
+	if ((num_channels >= SMUX_MAX_CHANNELS) || (channel_mode == PORT_MODE__NONE_) || (rate_hz == 0)
+		|| (num_values == 0) || (num_values > SMUX_MAX_VALUES) || smux_running)
+		return -1;
+
+	ch = &channels[num_channels];
+	ch->type_inx = type_inx;
+	ch->channel_mode = channel_mode;
+	ch->port = port;
+	ch->extport = extport;
+	ch->num_values = num_values;
+	ch->period = TICKS_PER_SECOND / rate_hz;
+	ch->settle = settle_us ? settle_us : _default_settle(channel_mode);
+	ch->mode_inx = mode_inx;
+	ch->pending_mode = SMUX_MODE_NONE;
+
+	ch->sn_port = ev3_search_port(port, extport);
+	if (ch->sn_port == DESC_LIMIT)
+		return -1;
+	set_port_mode_inx(ch->sn_port, channel_mode);
+	ch->state = SMUX_CH_CONFIGURING;
+	ch->ready_at = tick_systick() + ch->settle;
+
+	return (S32) num_channels++;
+}
+
+bool smux_set_mode(U32 channel, S32 mode_inx) {
+	if (channel >= num_channels)
+		return false;
+	// Invalidate current values, then request the change (readings in the old mode keep the old generation)
+	__atomic_add_fetch(&channels[channel].mode_gen, 1, __ATOMIC_RELEASE);
+	__atomic_store_n(&channels[channel].pending_mode, mode_inx, __ATOMIC_RELEASE);
+	return true;
+}
+
+U32 smux_poll(U32 budget_us) {
+
+	U32 now = tick_systick();
+	U32 start = now;
+	U32 next = now + SMUX_IDLE_US;
+	U32 i, index;
+	S32 mode;
+	SMUX_CHANNEL *ch;
+
+	for (i = 0; i < num_channels; i++) {
+		ch = &channels[i];
+		mode = __atomic_exchange_n(&ch->pending_mode, SMUX_MODE_NONE, __ATOMIC_ACQUIRE);
+		if (mode != SMUX_MODE_NONE) {
+			ch->mode_inx = mode;
+			ch->applied_gen = __atomic_load_n(&ch->mode_gen, __ATOMIC_ACQUIRE);
+			if ((ch->state == SMUX_CH_SETTLING) || (ch->state == SMUX_CH_ACTIVE))
+				_apply_mode(ch, now);
+		}
+		if ((ch->state == SMUX_CH_CONFIGURING) || (ch->state == SMUX_CH_SETTLING))
+			_configure(ch, now);
+	}
+
+	// Round-robin through the due channels
+	for (i = 0; i < num_channels; i++) {
+		index = (rr_next + i) % num_channels;
+		ch = &channels[index];
+		if (ch->state != SMUX_CH_ACTIVE)
+			continue;
+		if (tick_is_due(now, ch->next_due)) {
+			if (budget_us && ((now - start) >= budget_us)) {
+				rr_next = index;								// Out of time, resume here next pass
+				return now;
+			}
+			_read(ch, now);
+			now = tick_systick();
+		}
+	}
+	rr_next = (rr_next + 1) % (num_channels ? num_channels : 1);
+
+	// Earliest pending deadline
+	for (i = 0; i < num_channels; i++) {
+		ch = &channels[i];
+		if ((ch->state == SMUX_CH_ACTIVE) && ((S32) (ch->next_due - next) < 0))
+			next = ch->next_due;
+		else if ((ch->state == SMUX_CH_CONFIGURING || ch->state == SMUX_CH_SETTLING)
+				 && ((S32) (ch->ready_at - next) < 0))
+			next = ch->ready_at;
+	}
+	return next;
+}
+
+bool smux_start(void) {
+	if (smux_running)
+		return false;
+	smux_running = true;
+	if (0 != pthread_create(&smux_thread, NULL, _smux_thread, NULL)) {
+		smux_running = false;
+		return false;
+	}
+	return true;
+}
+
+void smux_stop(void) {
+	if (!smux_running)
+		return;
+	__atomic_store_n(&smux_running, false, __ATOMIC_RELEASE);
+	pthread_join(smux_thread, NULL);
+}
+
+bool smux_get_value(U32 channel, U32 inx, S32 *value, U32 *systick) {
+
+	SMUX_CHANNEL *ch;
+	U32 seq, stamp, gen;
+	S32 val;
+
+	if ((channel >= num_channels) || (inx >= channels[channel].num_values))
+		return false;
+
+	ch = &channels[channel];
+	do {
+		seq = __atomic_load_n(&ch->seq, __ATOMIC_ACQUIRE);
+		val = ch->values[inx];
+		stamp = ch->systick;
+		gen = ch->value_gen;
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	} while ((seq & 1) || (seq != __atomic_load_n(&ch->seq, __ATOMIC_RELAXED)));
+
+	if ((seq == 0) || (gen != __atomic_load_n(&ch->mode_gen, __ATOMIC_ACQUIRE)))
+		return false;											// No reading yet, or read in a previous mode
+
+	*value = val;
+	if (systick)
+		*systick = stamp;
+	return true;
+}
+
+U8 smux_get_stats(U32 channel, U32 *reads, U32 *late) {
+	if (channel >= num_channels)
+		return SMUX_CH_UNUSED;
+	if (reads)
+		*reads = channels[channel].reads;
+	if (late)
+		*late = channels[channel].late;
+	return channels[channel].state;
+}
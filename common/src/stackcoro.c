@@ -0,0 +1,142 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   stackcoro.c
+ *  \brief  ARM-BBR stackful coroutine routines
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "ev3dev-arm-ctypes.h"
+#include <stdbool.h>
+#include "stackcoro.h"
+
+/* Context register slots (see stackcoro-switch.S) */
+#define SCORO_CTX_FUNC   0						// R4: coroutine routine (trampoline)
+#define SCORO_CTX_ARG    1						// R5: coroutine routine argument (trampoline)
+#define SCORO_CTX_CORO   2						// R6: coroutine (trampoline)
+#define SCORO_CTX_SP     8
+#define SCORO_CTX_LR     9
+
+static SCORO *current;							// Running coroutine, NULL for the main program
+
+/* Internal Routines */
+
+static void _init_context(SCORO *co) {
+	U32 *p = (U32 *) co->stack;
+	U32 *top = (U32 *) (co->stack + co->stack_size);
+
+	// Paint the whole stack for the high-water measurement; this also faults in every page up front
+	while (p < top)
+		*p++ = SCORO_STACK_PAINT;
+
+	co->context[SCORO_CTX_FUNC] = (U32) co->func;
+	co->context[SCORO_CTX_ARG] = (U32) co->arg;
+	co->context[SCORO_CTX_CORO] = (U32) co;
+	co->context[SCORO_CTX_SP] = (U32) top;		// Page aligned, so AAPCS 8-byte alignment holds
+	co->context[SCORO_CTX_LR] = (U32) scoro_trampoline;
+	co->status = SCORO_READY;
+}
+
+static void _suspend(U32 status) {
+	SCORO *co = current;
+
+	current = co->resumer;
+	scoro_switch(co->context, co->caller, status);
+}
+
+/* Public Routines */
+
+SCORO *scoro_create(SCORO_FUNC func, void *arg, U32 stack_size) {
+	SCORO *co;
+	U32 page = (U32) sysconf(_SC_PAGESIZE);
+
+	if (!func || !(co = calloc(1, sizeof(SCORO))))
+		return NULL;
+
+	if (stack_size < SCORO_MIN_STACK)
+		stack_size = SCORO_MIN_STACK;
+	co->stack_size = (stack_size + page - 1) & ~(page - 1);
+	co->mapping_size = co->stack_size + page;
+	co->mapping = mmap(NULL, co->mapping_size, PROT_READ | PROT_WRITE,
+					   MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+	if (co->mapping == MAP_FAILED) {
+		free(co);
+		return NULL;
+	}
+	// The stack grows down, so the guard page goes below it
+	if (mprotect(co->mapping, page, PROT_NONE) != 0) {
+		munmap(co->mapping, co->mapping_size);
+		free(co);
+		return NULL;
+	}
+	co->stack = co->mapping + page;
+	co->func = func;
+	co->arg = arg;
+	_init_context(co);
+	return co;
+}
+
+U32 scoro_resume(SCORO *co) {
+	if (co->status == SCORO_END)
+		return SCORO_END;
+
+	co->resumer = current;
+	current = co;
+	co->switches++;
+	co->status = scoro_switch(co->caller, co->context, 0);
+	return co->status;
+}
+
+void scoro_yield(void) {
+	if (current)
+		_suspend(SCORO_YIELD);
+}
+
+void scoro_wait(bool (*cont_eval_function)(void)) {
+	while (current && !cont_eval_function())
+		_suspend(SCORO_WAIT);
+}
+
+bool scoro_restart(SCORO *co) {
+	if (co == current)
+		return false;
+	_init_context(co);
+	return true;
+}
+
+bool scoro_alive(SCORO *co) {
+	return (co->status != SCORO_END);
+}
+
+SCORO *scoro_current(void) {
+	return current;
+}
+
+U32 scoro_stack_used(SCORO *co) {
+	U32 *p = (U32 *) co->stack;
+	U32 *top = (U32 *) (co->stack + co->stack_size);
+
+	while ((p < top) && (*p == SCORO_STACK_PAINT))
+		p++;
+	return (U32) ((U8 *) top - (U8 *) p);
+}
+
+void scoro_destroy(SCORO *co) {
+	if (!co || (co == current))
+		return;
+	munmap(co->mapping, co->mapping_size);
+	free(co);
+}
+
+void scoro_finish(SCORO *co) {
+	// An ended coroutine is never resumed (see scoro_resume()), so this switch does not return
+	current = co->resumer;
+	scoro_switch(co->context, co->caller, SCORO_END);
+}
@@ -0,0 +1,246 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   stalldet.c
+ *  \brief  ARM-BBR motor stall and end-stop detector routines
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "ev3dev-arm-ctypes.h"
+#include <stdbool.h>
+#include "fastattr.h"
+#include "stalldet.h"
+#include "systick.h"
+
+#define STALL_IDLE_US      10000					// Maximum background thread sleep
+#define STALL_STATE_SIZE      64					// Tacho state attribute buffer size
+#define STALL_NO_EVENT  ((U32) -1)					// event_gen before the first stall
+
+typedef struct {
+	// Configuration
+	U8 sn;
+	U32 min_speed;									// Tacho counts/s
+	U32 debounce;									// Ticks
+	U32 grace;										// Ticks
+	U32 flags;
+	S32 position_fd;
+	S32 state_fd;
+	S32 command_fd;
+
+	// Control (written by stall_arm()/stall_disarm())
+	U32 arm_gen;									// Incremented by each stall_arm()
+	bool armed;
+
+	// Sampling
+	U32 active_gen;									// arm_gen being sampled
+	U32 armed_at;
+	U32 next_due;
+	S32 anchor_pos;									// Position at the start of the slow window
+	U32 anchor_at;
+
+	// Published event
+	U32 event_gen;									// arm_gen when the motor stalled
+	S32 stall_pos;
+	U32 latency;
+	U32 samples;
+	U32 events;
+} STALL_MOTOR;
+
+static STALL_MOTOR motors[STALL_MAX_MOTORS];
+static U32 num_motors;
+static pthread_t stall_thread;
+static bool stall_running;
+
+/* Internal Routines */
+
+static inline bool _valid_id(S32 id) {
+	return ((id >= 0) && ((U32) id < num_motors));
+}
+
+/* Moved further than min_speed over the time since the anchor sample (plus the encoder slack) */
+static bool _is_moving(STALL_MOTOR *m, S32 pos, U32 now) {
+	S32 moved = pos - m->anchor_pos;
+
+	if (moved < 0)
+		moved = -moved;
+	moved -= STALL_SLACK_COUNTS;
+	return (moved > 0)
+		&& ((long long) moved * TICKS_PER_SECOND > (long long) m->min_speed * (long long) (now - m->anchor_at));
+}
+
+static bool _state_stalled(STALL_MOTOR *m) {
+	char state[STALL_STATE_SIZE];
+
+	return fattr_read_str(m->state_fd, state, sizeof(state)) && (strstr(state, "stalled") != NULL);
+}
+
+static void _sample(STALL_MOTOR *m, U32 now) {
+	S32 pos;
+	bool stalled = false;
+
+	if (!fattr_read_int(m->position_fd, &pos))
+		return;
+	m->samples++;
+
+	if ((now - m->armed_at) < m->grace) {
+		m->anchor_pos = pos;						// Still ramping up
+		m->anchor_at = now;
+		return;
+	}
+
+	if ((m->flags & STALL_USE_STATE) && _state_stalled(m))
+		stalled = true;
+	else if (_is_moving(m, pos, now)) {
+		m->anchor_pos = pos;
+		m->anchor_at = now;
+	} else if ((now - m->anchor_at) >= m->debounce)
+		stalled = true;
+
+	if (stalled) {
+		if (m->flags & STALL_STOP_MOTOR)
+			fattr_write_str(m->command_fd, "stop");
+		m->stall_pos = pos;
+		m->latency = now - m->armed_at;
+		m->events++;
+		__atomic_store_n(&m->event_gen, m->active_gen, __ATOMIC_RELEASE);
+	}
+}
+
+static void *_stall_thread(void *arg) {
+	(void) arg;
+	while (__atomic_load_n(&stall_running, __ATOMIC_ACQUIRE)) {
+		tick_sleep_until(stall_poll(), STALL_IDLE_US);
+	}
+	return NULL;
+}
+
+/* Public Routines */
+
+S32 stall_add_motor(U8 sn, U32 min_speed, U32 debounce_us, U32 grace_us, U32 flags) {
+	STALL_MOTOR *m;
+
+	if ((num_motors >= STALL_MAX_MOTORS) || (debounce_us == 0) || stall_running)
+		return -1;
+
+	m = &motors[num_motors];
+	memset(m, 0, sizeof(*m));
+	m->sn = sn;
+	m->min_speed = min_speed;
+	m->debounce = debounce_us;
+	m->grace = grace_us;
+	m->flags = flags;
+	m->event_gen = STALL_NO_EVENT;
+	m->state_fd = m->command_fd = -1;
+
+	m->position_fd = fattr_open_tacho(sn, "position", false);
+	if (flags & STALL_USE_STATE)
+		m->state_fd = fattr_open_tacho(sn, "state", false);
+	if (flags & STALL_STOP_MOTOR)
+		m->command_fd = fattr_open_tacho(sn, "command", true);
+
+	if ((m->position_fd < 0) || ((flags & STALL_USE_STATE) && (m->state_fd < 0))
+		|| ((flags & STALL_STOP_MOTOR) && (m->command_fd < 0))) {
+		fattr_close(m->position_fd);
+		fattr_close(m->state_fd);
+		fattr_close(m->command_fd);
+		return -1;
+	}
+	return (S32) num_motors++;
+}
+
+void stall_arm(S32 id) {
+	if (!_valid_id(id))
+		return;
+	__atomic_add_fetch(&motors[id].arm_gen, 1, __ATOMIC_RELEASE);
+	__atomic_store_n(&motors[id].armed, true, __ATOMIC_RELEASE);
+}
+
+void stall_disarm(S32 id) {
+	if (!_valid_id(id))
+		return;
+	__atomic_store_n(&motors[id].armed, false, __ATOMIC_RELEASE);
+}
+
+bool stall_detected(S32 id) {
+	if (!_valid_id(id))
+		return false;
+	return (__atomic_load_n(&motors[id].event_gen, __ATOMIC_ACQUIRE)
+			== __atomic_load_n(&motors[id].arm_gen, __ATOMIC_ACQUIRE));
+}
+
+bool stall_get_position(S32 id, S32 *position, U32 *latency) {
+	if (!stall_detected(id))
+		return false;
+	*position = motors[id].stall_pos;
+	if (latency)
+		*latency = motors[id].latency;
+	return true;
+}
+
+U32 stall_poll(void) {
+	U32 now = tick_systick();
+	U32 next = now + STALL_IDLE_US;
+	U32 i, gen;
+	STALL_MOTOR *m;
+
+	for (i = 0; i < num_motors; i++) {
+		m = &motors[i];
+		if (!__atomic_load_n(&m->armed, __ATOMIC_ACQUIRE))
+			continue;
+
+		gen = __atomic_load_n(&m->arm_gen, __ATOMIC_ACQUIRE);
+		if (gen != m->active_gen) {
+			// Newly armed, restart from the current position
+			m->active_gen = gen;
+			m->armed_at = m->anchor_at = now;
+			m->next_due = now;
+			if (!fattr_read_int(m->position_fd, &m->anchor_pos))
+				continue;
+		}
+		if (m->event_gen == m->active_gen)
+			continue;								// Already stalled, wait for the next stall_arm()
+
+		if (tick_is_due_within(now, m->next_due, STALL_PERIOD_US)) {
+			_sample(m, now);
+			m->next_due = now + STALL_PERIOD_US;	// Don't try to catch up
+			now = tick_systick();
+		}
+		if ((S32) (m->next_due - next) < 0)
+			next = m->next_due;
+	}
+	return next;
+}
+
+bool stall_start(void) {
+	if (stall_running)
+		return false;
+	stall_running = true;
+	if (0 != pthread_create(&stall_thread, NULL, _stall_thread, NULL)) {
+		stall_running = false;
+		return false;
+	}
+	return true;
+}
+
+void stall_stop(void) {
+	if (!stall_running)
+		return;
+	__atomic_store_n(&stall_running, false, __ATOMIC_RELEASE);
+	pthread_join(stall_thread, NULL);
+}
+
+bool stall_get_stats(S32 id, U32 *samples, U32 *events) {
+	if (!_valid_id(id))
+		return false;
+	*samples = motors[id].samples;
+	*events = motors[id].events;
+	return true;
+}
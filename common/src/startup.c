@@ -0,0 +1,159 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   startup.c
+ *  \brief  ARM-BBR startup phase tracer routines
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#define _GNU_SOURCE
+
+#include "ev3dev-arm-ctypes.h"
+#include "startup.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+
+#define PROC_SELF_STAT "/proc/self/stat"
+#define STAT_STARTTIME_FIELD 22					// Field number of starttime in /proc/[pid]/stat
+#define BUFSIZE 512
+
+typedef struct {
+	const char *phase;
+	pthread_t thread;
+	U32 time_us;								// Since process creation
+} STUP_MARK;
+
+static STUP_MARK marks[STUP_MAX_PHASES];
+static U32 num_marks;							// Slots claimed (may exceed STUP_MAX_PHASES)
+static unsigned long long process_start_us;	// CLOCK_BOOTTIME at process creation
+static pthread_t main_thread;
+static pthread_once_t stup_once = PTHREAD_ONCE_INIT;
+
+/* Internal Routines */
+
+static unsigned long long boottime_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_BOOTTIME, &ts);
+	return (unsigned long long) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* Process creation time, in clock ticks since boot */
+static bool read_starttime(unsigned long long *starttime)
+{
+	char buf[BUFSIZE];
+	char *p;
+	FILE *f = fopen(PROC_SELF_STAT, "r");
+	U32 field;
+	bool retval = FALSE;
+
+	if (!f)
+		return FALSE;
+	if (fgets(buf, sizeof(buf), f) && (p = strrchr(buf, ')'))) {
+		// Field 2 (comm) may contain spaces, so count fields after the closing parenthesis
+		for (field = 2; p && (field < STAT_STARTTIME_FIELD); field++)
+			p = strchr(p + 1, ' ');
+		if (p)
+			retval = (sscanf(p, "%llu", starttime) == 1);
+	}
+	fclose(f);
+	return retval;
+}
+
+static void stup_init(void)
+{
+	unsigned long long starttime;
+	long hz = sysconf(_SC_CLK_TCK);
+
+	main_thread = pthread_self();
+	if (read_starttime(&starttime) && (hz > 0))
+		process_start_us = starttime * 1000000 / hz;
+	else
+		process_start_us = boottime_us();		// Unknown, start from the first mark
+}
+
+static void stup_write_report(FILE *f, U32 count)
+{
+	U32 i, j, prev_us;
+	bool is_main;
+
+	fprintf(f, "startup: %8s %8s  %s\n", "at(ms)", "dur(ms)", "phase");
+	for (i = 0; i < count; i++) {
+		// Duration is measured from the previous mark made by the same thread.
+		// A helper thread's first phase is measured from the preceding main thread mark (where it was started).
+		is_main = pthread_equal(marks[i].thread, main_thread);
+		prev_us = 0;
+		for (j = i; j-- > 0; ) {
+			if (pthread_equal(marks[j].thread, marks[i].thread)) {
+				prev_us = marks[j].time_us;
+				break;
+			}
+			if (!prev_us && !is_main && pthread_equal(marks[j].thread, main_thread))
+				prev_us = marks[j].time_us;
+		}
+		fprintf(f, "startup: %8.1f %8.1f  %s%s\n", marks[i].time_us / 1000.0,
+				(marks[i].time_us - prev_us) / 1000.0, marks[i].phase, is_main ? "" : " [helper]");
+	}
+	if (num_marks > STUP_MAX_PHASES)
+		fprintf(f, "startup: %lu marks not recorded\n", num_marks - STUP_MAX_PHASES);
+}
+
+static int compare_marks(const void *a, const void *b)
+{
+	U32 x = ((const STUP_MARK *) a)->time_us;
+	U32 y = ((const STUP_MARK *) b)->time_us;
+	return (x > y) - (x < y);
+}
+
+/* Public Routines */
+
+void stup_mark(const char *phase)
+{
+	U32 index;
+
+	pthread_once(&stup_once, stup_init);
+	index = __atomic_fetch_add(&num_marks, 1, __ATOMIC_RELAXED);
+	if (index < STUP_MAX_PHASES) {
+		marks[index].phase = phase;
+		marks[index].thread = pthread_self();
+		marks[index].time_us = (U32) (boottime_us() - process_start_us);
+	}
+}
+
+U32 stup_report(void)
+{
+	const char *dest = getenv(STUP_REPORT_ENV);
+	U32 count, first_tick_us;
+	FILE *f;
+
+	stup_mark("first tick");
+	first_tick_us = (U32) (boottime_us() - process_start_us);
+	count = __atomic_load_n(&num_marks, __ATOMIC_RELAXED);
+	if (count > STUP_MAX_PHASES)
+		count = STUP_MAX_PHASES;
+	if (!dest || !*dest)
+		return first_tick_us;
+
+	// Helper thread marks may interleave, so list phases in time order
+	qsort(marks, count, sizeof(STUP_MARK), compare_marks);
+
+	f = strcmp(dest, "-") ? fopen(dest, "w") : stderr;	// stdout belongs to the LCD
+	if (f) {
+		stup_write_report(f, count);
+		fprintf(f, "startup: first tick at %.1f ms\n", first_tick_us / 1000.0);
+		if (f == stderr)
+			fflush(f);
+		else
+			fclose(f);
+	}
+	return first_tick_us;
+}
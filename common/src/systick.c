@@ -14,22 +14,22 @@
 #include "systick.h"
 #include <time.h>
 
-#define NANOSECONDS_PER_SECOND 1000000000L
-
 static	struct timespec start_time = { 0, 0 };
 
 void tick_init(void) {
-	clock_gettime(CLOCK_REALTIME, &start_time);
+	clock_gettime(CLOCK_MONOTONIC, &start_time);
 }
 
 U32 tick_systick(void) {
 	struct timespec curr_time;
-	long elapsed_time = 0;
+	U32 elapsed_sec;
+	S32 elapsed_usec;
 
-	clock_gettime(CLOCK_REALTIME, &curr_time);
+	clock_gettime(CLOCK_MONOTONIC, &curr_time);
 
-	elapsed_time = (curr_time.tv_nsec - start_time.tv_nsec)
-				+ (curr_time.tv_sec - start_time.tv_sec) * NANOSECONDS_PER_SECOND;
+	// Microsecond arithmetic in U32 so that the tick count wraps cleanly at 2^32 (every 71.6 minutes)
+	elapsed_sec = (U32) (curr_time.tv_sec - start_time.tv_sec);
+	elapsed_usec = (S32) ((curr_time.tv_nsec - start_time.tv_nsec) / NANOSECONDS_PER_TICK);
 
-	return (U32) (elapsed_time / NANOSECONDS_PER_TICK);
+	return (elapsed_sec * TICKS_PER_SECOND) + (U32) elapsed_usec;
 }
@@ -0,0 +1,231 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   telemetry.c
+ *  \brief  ARM-BBR UDP telemetry exporter routines
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#define _GNU_SOURCE
+
+#include "ev3dev-arm-ctypes.h"
+#include "telemetry.h"
+#include "systick.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#define TLM_RING_MASK (TLM_RING_SIZE - 1)
+
+/* Frame wire format */
+typedef struct {
+	uint32_t seqno;
+	uint32_t systick;
+	int32_t fields[TLM_MAX_FIELDS];
+} TLM_FRAME;
+
+/* Single producer (control loop), single consumer (sender thread) ring buffer */
+static TLM_FRAME ring[TLM_RING_SIZE];
+static U32 ring_head;						// Written by producer only
+static U32 ring_tail;						// Written by consumer only
+
+static bool tlm_active;
+static bool tlm_quit;
+static int tlm_socket = -1;
+static struct sockaddr_in tlm_dest;
+static U32 tlm_num_fields;
+static U32 tlm_frame_seqno;
+static U32 tlm_dropped_count;
+static U16 tlm_datagram_seqno;
+static S32 tlm_staged[TLM_MAX_FIELDS];
+static sem_t tlm_wakeup;
+static pthread_t tlm_thread;
+
+/* Sender thread datagram buffers */
+static U8 tlm_dgram[TLM_DATAGRAMS_PER_SEND][sizeof(TLM_HEADER) + TLM_FRAMES_PER_DATAGRAM * sizeof(TLM_FRAME)];
+
+/* Internal Routines */
+
+static void tlm_count_drops(U32 count)
+{
+	__atomic_add_fetch(&tlm_dropped_count, count, __ATOMIC_RELAXED);
+}
+
+/* Pack queued frames into datagrams and send them, returns number of frames consumed */
+static U32 tlm_send_batch(bool flush)
+{
+	struct mmsghdr msgs[TLM_DATAGRAMS_PER_SEND];
+	struct iovec iovs[TLM_DATAGRAMS_PER_SEND];
+	U32 tail = ring_tail;
+	U32 head = __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE);
+	U32 frame_size = (2 + tlm_num_fields) * sizeof(uint32_t);
+	U32 num_dgrams = 0, consumed = 0;
+	int sent;
+
+	while ((num_dgrams < TLM_DATAGRAMS_PER_SEND) && (head != tail)) {
+		U32 avail = head - tail;
+		U32 num_frames = (avail < TLM_FRAMES_PER_DATAGRAM) ? avail : TLM_FRAMES_PER_DATAGRAM;
+		TLM_HEADER *hdr = (TLM_HEADER *) tlm_dgram[num_dgrams];
+		U8 *p = tlm_dgram[num_dgrams] + sizeof(TLM_HEADER);
+		U32 i;
+
+		if ((num_frames < TLM_FRAMES_PER_DATAGRAM) && !flush)
+			break;							// Wait for a full datagram
+
+		hdr->magic = TLM_MAGIC;
+		hdr->version = TLM_VERSION;
+		hdr->num_fields = (U8) tlm_num_fields;
+		hdr->num_frames = (U16) num_frames;
+		hdr->datagram_seqno = tlm_datagram_seqno++;
+		hdr->dropped = __atomic_load_n(&tlm_dropped_count, __ATOMIC_RELAXED);
+
+		for (i = 0; i < num_frames; i++, tail++) {
+			memcpy(p, &ring[tail & TLM_RING_MASK], frame_size);		// seqno, systick, fields[]
+			p += frame_size;
+		}
+
+		iovs[num_dgrams].iov_base = tlm_dgram[num_dgrams];
+		iovs[num_dgrams].iov_len = p - tlm_dgram[num_dgrams];
+		memset(&msgs[num_dgrams], 0, sizeof(msgs[num_dgrams]));
+		msgs[num_dgrams].msg_hdr.msg_name = &tlm_dest;
+		msgs[num_dgrams].msg_hdr.msg_namelen = sizeof(tlm_dest);
+		msgs[num_dgrams].msg_hdr.msg_iov = &iovs[num_dgrams];
+		msgs[num_dgrams].msg_hdr.msg_iovlen = 1;
+		num_dgrams++;
+		consumed += num_frames;
+	}
+
+	// Frames are released whether or not they were sent; the link must not back up the ring
+	__atomic_store_n(&ring_tail, tail, __ATOMIC_RELEASE);
+
+	if (num_dgrams) {
+		sent = sendmmsg(tlm_socket, msgs, num_dgrams, MSG_DONTWAIT);
+		if (sent < 0)
+			sent = 0;
+		while ((U32) sent < num_dgrams)
+			tlm_count_drops(((TLM_HEADER *) tlm_dgram[sent++])->num_frames);
+	}
+	return consumed;
+}
+
+static void *tlm_sender(void *arg)
+{
+	(void) arg;
+
+	while (!__atomic_load_n(&tlm_quit, __ATOMIC_ACQUIRE)) {
+		sem_wait(&tlm_wakeup);
+		while (tlm_send_batch(FALSE) > 0)
+			;
+	}
+	while (tlm_send_batch(TRUE) > 0)
+		;
+	return NULL;
+}
+
+/* Public Routines */
+
+bool tlm_init(const char *host, U32 port, U32 num_fields)
+{
+	if (tlm_active || (num_fields == 0) || (num_fields > TLM_MAX_FIELDS))
+		return FALSE;
+
+	if (!host)
+		host = getenv(TLM_HOST_ENV);
+	if (!host || !*host)
+		host = TLM_DEFAULT_HOST;
+	if (port == 0)
+		port = TLM_DEFAULT_PORT;
+
+	memset(&tlm_dest, 0, sizeof(tlm_dest));
+	tlm_dest.sin_family = AF_INET;
+	tlm_dest.sin_port = htons((U16) port);
+	if (inet_pton(AF_INET, host, &tlm_dest.sin_addr) != 1)
+		return FALSE;
+
+	tlm_socket = socket(AF_INET, SOCK_DGRAM, 0);
+	if (tlm_socket < 0)
+		return FALSE;
+	fcntl(tlm_socket, F_SETFL, fcntl(tlm_socket, F_GETFL) | O_NONBLOCK);
+
+	tlm_num_fields = num_fields;
+	tlm_frame_seqno = 0;
+	tlm_dropped_count = 0;
+	ring_head = ring_tail = 0;
+	tlm_quit = FALSE;
+	memset(tlm_staged, 0, sizeof(tlm_staged));
+	sem_init(&tlm_wakeup, 0, 0);
+
+	if (pthread_create(&tlm_thread, NULL, tlm_sender, NULL) != 0) {
+		close(tlm_socket);
+		tlm_socket = -1;
+		return FALSE;
+	}
+	tlm_active = TRUE;
+	return TRUE;
+}
+
+void tlm_set(U32 index, S32 value)
+{
+	if (index < TLM_MAX_FIELDS)
+		tlm_staged[index] = value;
+}
+
+bool tlm_commit(void)
+{
+	return tlm_submit(tlm_staged);
+}
+
+bool tlm_submit(const S32 *values)
+{
+	U32 head = ring_head;
+	TLM_FRAME *frame;
+	U32 i;
+
+	if (!tlm_active)
+		return FALSE;
+
+	if (head - __atomic_load_n(&ring_tail, __ATOMIC_ACQUIRE) >= TLM_RING_SIZE) {
+		tlm_count_drops(1);					// Ring full, sender is behind
+		return FALSE;
+	}
+
+	frame = &ring[head & TLM_RING_MASK];
+	frame->seqno = tlm_frame_seqno++;
+	frame->systick = tick_systick();
+	for (i = 0; i < tlm_num_fields; i++)
+		frame->fields[i] = values[i];
+	__atomic_store_n(&ring_head, head + 1, __ATOMIC_RELEASE);
+
+	if (((head + 1) % TLM_FRAMES_PER_DATAGRAM) == 0)
+		sem_post(&tlm_wakeup);				// Wake sender once per datagram
+	return TRUE;
+}
+
+U32 tlm_dropped(void)
+{
+	return __atomic_load_n(&tlm_dropped_count, __ATOMIC_RELAXED);
+}
+
+void tlm_exit(void)
+{
+	if (!tlm_active)
+		return;
+
+	__atomic_store_n(&tlm_quit, TRUE, __ATOMIC_RELEASE);
+	sem_post(&tlm_wakeup);
+	pthread_join(tlm_thread, NULL);
+	sem_destroy(&tlm_wakeup);
+	close(tlm_socket);
+	tlm_socket = -1;
+	tlm_active = FALSE;
+}
@@ -53,6 +53,27 @@
  *  Any local variables which need to be persistent across a coroutine switching
  *  must be declared in the data section (CORO_LOCAL).
  *
+ *  Coroutines can pass data through bounded channels (CHAN_INIT). The sender reserves a slot
+ *  with CHAN_SEND (waiting while the channel is full), fills it in place and commits it with
+ *  CHAN_COMMIT. The receiver gets the oldest slot with CHAN_RECV (waiting while the channel is empty),
+ *  uses it in place and frees it with CHAN_RELEASE. No data is copied.
+ *
+ *  \code
+ *  CHAN_INIT readings, 16, 4           // 4 slots of 16 bytes
+ *
+ *  CORO_START A
+ *      CHAN_SEND readings              // R0: slot address
+ *      // ... fill slot
+ *      CHAN_COMMIT readings
+ *  CORO_END
+ *
+ *  CORO_START B
+ *      CHAN_RECV readings              // R0: slot address
+ *      // ... use slot
+ *      CHAN_RELEASE readings
+ *  CORO_END
+ *  \endcode
+ *
  *  \{
  */
 
@@ -291,5 +312,136 @@ semcheck_\name:
     add     r1, r1, #1
     str     r1, [r0]
     .endm
+
+/* Channel structure (CHAN in channel.h) */
+    .equiv  CHAN_SLOTS, 0               // Slot array address
+    .equiv  CHAN_SLOT_SIZE, 4           // Slot size (bytes)
+    .equiv  CHAN_MASK, 8                // Capacity - 1 (capacity is a power of two)
+    .equiv  CHAN_HEAD, 12               // Number of slots committed (free-running)
+    .equiv  CHAN_TAIL, 16               // Number of slots released (free-running)
+    .equiv  CHAN_ALLOCATED, 20          // Slot array allocated by chan_init()
+    .equiv  CHAN_STRUCT_SIZE, 24
+
+/**
+ *  \brief Initialize the channel.
+ *  \param name Channel name.
+ *  \param slot_size Slot size (bytes, multiple of 4).
+ *  \param capacity Number of slots (power of two).
+ *
+ *  Note: We insert the channel check routine definitions here as well
+ */
+    .macro  CHAN_INIT name, slot_size, capacity
+    .if ((\capacity) < 1) || ((\capacity) & ((\capacity) - 1))
+    .error  "CHAN_INIT capacity must be a power of two"
+    .endif
+    .if ((\slot_size) < 4) || ((\slot_size) & 3)
+    .error  "CHAN_INIT slot size must be a multiple of 4"
+    .endif
+    .data
+    .align 2
+chan_\name:
+    .word   chanbuf_\name
+    .word   \slot_size
+    .word   (\capacity) - 1
+    .word   0
+    .word   0
+    .word   FALSE
+chanbuf_\name:
+    .space  (\slot_size) * (\capacity)
+
+    .text
+    .align 4
+chansendok_\name:
+    ldr     r0, =chan_\name
+    ldr     r1, [r0, #CHAN_HEAD]
+    ldr     r2, [r0, #CHAN_TAIL]
+    ldr     r3, [r0, #CHAN_MASK]
+    sub     r1, r1, r2                  // Slots in use
+    cmp     r1, r3
+    movls   r0, #TRUE                   // A slot is free
+    movhi   r0, #FALSE
+    bx      lr                          // return to caller
+
+chanrecvok_\name:
+    ldr     r0, =chan_\name
+    ldr     r1, [r0, #CHAN_HEAD]
+    ldr     r2, [r0, #CHAN_TAIL]
+    teq     r1, r2
+    movne   r0, #TRUE                   // A slot is committed
+    moveq   r0, #FALSE
+    bx      lr                          // return to caller
+    .endm
+
+/**
+ *  \brief Get the slot address for a free-running slot counter.
+ *
+ *  R1: channel address (destroyed), R2: slot counter (destroyed)
+ *  R0 returns the slot address; R3 is destroyed
+ *
+ *  Note: This macro is not intended for public use
+ */
+    .macro  CHAN_SLOT_ADDR
+    ldr     r3, [r1, #CHAN_MASK]
+    and     r2, r2, r3                  // Slot index
+    ldr     r3, [r1, #CHAN_SLOT_SIZE]
+    ldr     r1, [r1, #CHAN_SLOTS]
+    mla     r0, r2, r3, r1              // slots + index * slot_size
+    .endm
+
+/**
+ *  \brief Waiting for a free slot and reserve it.
+ *  \param name Channel name.
+ *  \return R0: Slot address
+ *
+ *  The slot is not visible to the receiver until CHAN_COMMIT.
+ *  Note: R0-R3 are destroyed
+ */
+    .macro  CHAN_SEND name
+    CORO_WAIT chansendok_\name
+    ldr     r1, =chan_\name
+    ldr     r2, [r1, #CHAN_HEAD]
+    CHAN_SLOT_ADDR
+    .endm
+
+/**
+ *  \brief Commit the slot reserved by CHAN_SEND.
+ *  \param name Channel name.
+ *
+ *  Note: R0 and R1 are destroyed
+ */
+    .macro  CHAN_COMMIT name
+    ldr     r0, =chan_\name
+    ldr     r1, [r0, #CHAN_HEAD]
+    add     r1, r1, #1
+    str     r1, [r0, #CHAN_HEAD]
+    .endm
+
+/**
+ *  \brief Waiting for a committed slot and get the oldest one.
+ *  \param name Channel name.
+ *  \return R0: Slot address
+ *
+ *  The slot is not reused by the sender until CHAN_RELEASE.
+ *  Note: R0-R3 are destroyed
+ */
+    .macro  CHAN_RECV name
+    CORO_WAIT chanrecvok_\name
+    ldr     r1, =chan_\name
+    ldr     r2, [r1, #CHAN_TAIL]
+    CHAN_SLOT_ADDR
+    .endm
+
+/**
+ *  \brief Release the slot obtained by CHAN_RECV.
+ *  \param name Channel name.
+ *
+ *  Note: R0 and R1 are destroyed
+ */
+    .macro  CHAN_RELEASE name
+    ldr     r0, =chan_\name
+    ldr     r1, [r0, #CHAN_TAIL]
+    add     r1, r1, #1
+    str     r1, [r0, #CHAN_TAIL]
+    .endm
 #endif
 /** \} */
@@ -0,0 +1,120 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   arm-params.h
+ *  \brief  Parameter Store definitions for Assembly Language Routines
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ *  \defgroup aparams Parameter Store in ARM Assembly
+ *
+ *  Assembly Language wrappers for the Parameter Store (see params.h).
+ *  The PRM_XXX constants and routines are declared in ev3dev-arm-bbr.h.
+ *
+ *  The parameter table is defined using PARAM entries between PARAM_TABLE and PARAM_TABLE_END.
+ *  Each PARAM entry defines the PRM_<name> offset of the parameter value in prm_values,
+ *  so the table must be defined before the parameters are loaded (e.g., in the .data section at the top of the file).
+ *
+ *  \code
+ *  PARAM_TABLE robot_params
+ *  PARAM   max_speed, PRM_S32, 200, 0, 1000       // name, type, default, min, max
+ *  PARAM   use_escape, PRM_BOOL, TRUE, FALSE, TRUE
+ *  PARAM_TABLE_END
+ *
+ *      .text
+ *  main:
+ *      PARAM_OPEN robot_params, NULL       // PRM_DEFAULT_PATH
+ *      ...
+ *      PARAM_LOAD r1, max_speed            // Current value, no system call
+ *  \endcode
+ *
+ *  \{
+ */
+
+#pragma once
+
+#ifdef __ASSEMBLY__
+
+#include "arm-stddef.h"
+
+/**
+ *  \brief Start a parameter table (PRM_DEF array).
+ *  \param name Table name.
+ */
+    .macro  PARAM_TABLE name
+    .data
+    .align 2
+\name:
+    .set    prm_index, 0
+    .endm
+
+/**
+ *  \brief Define a parameter, and its PRM_<name> value offset.
+ *  \param name Parameter name (up to PRM_NAME_SIZE - 1 characters).
+ *  \param type PRM_S32, PRM_U32 or PRM_BOOL.
+ *  \param default Default value.
+ *  \param min Minimum value.
+ *  \param max Maximum value.
+ */
+    .macro  PARAM name, type, default, min, max
+    .pushsection .rodata
+prm_\name\()_str:   .asciz  "\name"
+    .popsection
+    .word   prm_\name\()_str, \type, \default, \min, \max
+    .equiv  PRM_\name, prm_index * 4
+    .set    prm_index, prm_index + 1
+    .endm
+
+/**
+ *  \brief End a parameter table.
+ */
+    .macro  PARAM_TABLE_END
+    .word   NULL, 0, 0, 0, 0
+    .endm
+
+/**
+ *  \brief Open the parameter store.
+ *  \param table Parameter table.
+ *  \param path File path string (NULL for PRM_DEFAULT_PATH).
+ *  \return R0: Parameter values (NULL if the table is invalid)
+ *
+ *  R0-R3 are modified in this macro (not preserved per AAPCS)
+ */
+    .macro  PARAM_OPEN table, path
+    ldr     r0, =\path
+    ldr     r1, =\table
+    bl      prm_open
+    .endm
+
+/**
+ *  \brief Get the parameter values pointer.
+ *  \param reg Register for the pointer.
+ */
+    .macro  PARAM_BASE reg
+    ldr     \reg, =prm_values
+    ldr     \reg, [\reg]
+    .endm
+
+/**
+ *  \brief Load the current value of a parameter.
+ *  \param reg Register for the value.
+ *  \param name Parameter name.
+ */
+    .macro  PARAM_LOAD reg, name
+    PARAM_BASE \reg
+    ldr     \reg, [\reg, #PRM_\name]
+    .endm
+
+/**
+ *  \brief Load the current value of a parameter using the values pointer (see PARAM_BASE).
+ *  \param reg Register for the value.
+ *  \param base Register holding the values pointer.
+ *  \param name Parameter name.
+ */
+    .macro  PARAM_LOAD_BASE reg, base, name
+    ldr     \reg, [\base, #PRM_\name]
+    .endm
+#endif
+/** \} */
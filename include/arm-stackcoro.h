@@ -0,0 +1,128 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   arm-stackcoro.h
+ *  \brief  Stackful coroutine definitions for Assembly Language Routines
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ *  \defgroup scoro Stackful Coroutines in ARM Assembly
+ *
+ *  Assembly Language wrappers for the Stackful Coroutines (see stackcoro.h).
+ *  The SCORO_XXX constants and routines are declared in ev3dev-arm-bbr.h.
+ *
+ *  Unlike the label-resume coroutines (arm-coroutine.h), a stackful coroutine routine is an
+ *  ordinary AAPCS routine running on its own stack. R4-R11 are preserved across SCORO_YIELD and
+ *  SCORO_WAIT, so local variables can be kept in registers instead of CORO_LOCAL variables.
+ *
+ *  \code
+ *      .data
+ *      .align 2
+ *  SCORO_CONTEXT A
+ *
+ *      .text
+ *  routine_A:                          // void routine_A(void *arg)
+ *      push    {r4, lr}
+ *      mov     r4, #0                  // Local variable, kept across yields
+ *  1:  add     r4, r4, #1
+ *      SCORO_YIELD
+ *      SCORO_WAIT cont_subroutine
+ *      b       1b
+ *
+ *  main:
+ *      SCORO_CREATE A, routine_A, NULL, SCORO_DEFAULT_STACK
+ *  loop:
+ *      SCORO_RESUME A
+ *      // exit condition test
+ *      bne loop
+ *  \endcode
+ *
+ *  \{
+ */
+
+#pragma once
+
+#ifdef __ASSEMBLY__
+
+#include "arm-stddef.h"
+
+/**
+ *  \brief Define the coroutine handle (SCORO pointer) and initialize it to NULL.
+ *  \param name Coroutine name.
+ */
+    .macro  SCORO_CONTEXT name
+    .data
+    .align 2
+sco_\name:  .word   NULL
+    .endm
+
+/**
+ *  \brief Create the coroutine.
+ *  \param name Coroutine name.
+ *  \param routine Coroutine routine.
+ *  \param arg Coroutine routine argument (constant).
+ *  \param stack_size Stack size (bytes).
+ *  \return R0: Coroutine handle (NULL if the stack could not be allocated)
+ *
+ *  R0-R3 are modified in this macro (not preserved per AAPCS)
+ */
+    .macro  SCORO_CREATE name, routine, arg, stack_size
+    ldr     r0, =\routine
+    ldr     r1, =\arg
+    ldr     r2, =\stack_size
+    bl      scoro_create
+    ldr     r1, =sco_\name
+    str     r0, [r1]
+    .endm
+
+/**
+ *  \brief Resume the coroutine.
+ *  \param name Coroutine name.
+ *  \return R0: coroutine status (SCORO_YIELD, SCORO_WAIT or SCORO_END)
+ *
+ *  R0-R3 are modified in this macro (not preserved per AAPCS)
+ */
+    .macro  SCORO_RESUME name
+    ldr     r0, =sco_\name
+    ldr     r0, [r0]
+    bl      scoro_resume
+    .endm
+
+/**
+ *  \brief Switching back to the resumer.
+ *
+ *  R0-R3 are modified in this macro (not preserved per AAPCS)
+ */
+    .macro  SCORO_YIELD
+    bl      scoro_yield
+    .endm
+
+/**
+ *  \brief Waiting for the condition is true.
+ *  \param cont_eval_function Continue evaluation function
+ *         (returns non-zero/TRUE to continue, or FALSE to wait).
+ *
+ *  R0-R3 are modified in this macro (not preserved per AAPCS)
+ */
+    .macro  SCORO_WAIT cont_eval_function
+    ldr     r0, =\cont_eval_function
+    bl      scoro_wait
+    .endm
+
+/**
+ *  \brief Free the coroutine and its stack.
+ *  \param name Coroutine name.
+ *
+ *  R0-R3 are modified in this macro (not preserved per AAPCS)
+ */
+    .macro  SCORO_DESTROY name
+    ldr     r1, =sco_\name
+    ldr     r0, [r1]
+    mov     r2, #NULL
+    str     r2, [r1]
+    bl      scoro_destroy
+    .endm
+#endif
+/** \} */
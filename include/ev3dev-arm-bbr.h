@@ -44,6 +44,9 @@
 /* common/include/scaffolding.h */
 	.extern	prog_init
 	.extern	prog_exit
+	.extern	prog_init_rt
+	.extern	prog_exit_rt
+	.extern	prog_init_fast
 	.extern prog_title
 	.extern prog_content1
 	.extern prog_content2
@@ -66,6 +69,49 @@
 	.extern dvcs_search_sensor_type_for_port
 	.extern dvcs_search_servo_type_for_port
 	.extern dvcs_search_tacho_type_for_port
+	.extern dvcs_discover
+	.extern dvcs_mux_channel_mode_inx
+
+/* common/include/budget.h */
+	.equiv	BDGT_CRITICAL, 0
+	.equiv	BDGT_NORMAL, 1
+	.equiv	BDGT_BEST_EFFORT, 2
+	.equiv	BDGT_NUM_CLASSES, 3
+	.equiv	BDGT_MAX_TASKS, 16
+
+	.extern bdgt_register
+	.extern bdgt_begin_tick
+	.extern bdgt_admit
+	.extern bdgt_done
+	.extern bdgt_end_tick
+	.extern bdgt_remaining
+	.extern bdgt_get_cost
+	.extern bdgt_get_stats
+	.extern bdgt_get_tick_stats
+	.extern bdgt_report
+
+/* common/include/fastattr.h */
+	.extern fattr_open_sensor_value
+	.extern fattr_open_tacho
+	.extern fattr_open
+	.extern fattr_read_int
+	.extern fattr_write_int
+	.extern fattr_read_str
+	.extern fattr_write_str
+	.extern fattr_close
+
+/* common/include/smux.h */
+	.equiv	SMUX_MAX_CHANNELS, 8
+	.equiv	SMUX_MAX_VALUES, 4
+	.equiv	SMUX_MODE_DEFAULT, -1
+
+	.extern smux_add_channel
+	.extern smux_set_mode
+	.extern smux_poll
+	.extern smux_start
+	.extern smux_stop
+	.extern smux_get_value
+	.extern smux_get_stats
 
 /* Systick constants */
 	.equiv	TICKS_PER_SECOND,  1000000
@@ -76,5 +122,328 @@
 	.extern tick_init
 	.extern tick_systick
 
+/* common/include/pipeline.h */
+	.equiv	PPLN_STAGE_SENSE, 0
+	.equiv	PPLN_STAGE_DECIDE, 1
+	.equiv	PPLN_STAGE_ACT, 2
+	.equiv	PPLN_NUM_STAGES, 3
+
+	.extern ppln_tb_init
+	.extern ppln_tb_publish
+	.extern ppln_tb_read
+	.extern ppln_tb_free
+	.extern ppln_init
+	.extern ppln_set_stage
+	.extern ppln_start
+	.extern ppln_stop
+	.extern ppln_is_running
+	.extern ppln_get_stats
+	.extern ppln_report
+	.extern ppln_exit
+
+/* common/include/prng.h */
+	.extern prng_init
+	.extern prng_seed
+	.extern prng_get_seed
+	.extern prng_next
+	.extern prng_range
+	.extern prng_choose_weighted
+
+/* common/include/i2cdev.h */
+	.equiv	I2CD_MAX_DEVICES, 8
+	.equiv	I2CD_MAX_TRANSFER, 32
+
+	.extern i2cd_find_desc
+	.extern i2cd_claim_port
+	.extern i2cd_open
+	.extern i2cd_identify
+	.extern i2cd_read
+	.extern i2cd_write
+	.extern i2cd_read_data
+	.extern i2cd_close
+
+/* common/include/sensormgr.h */
+	.equiv	SNSR_MAX_REQUESTS, 8
+	.equiv	SNSR_MAX_VALUES, 4
+	.equiv	SNSR_MODE_UNKNOWN, -1
+
+	.extern snsr_set_mode
+	.extern snsr_get_mode
+	.extern snsr_invalidate
+	.extern snsr_set_settle
+	.extern snsr_request
+	.extern snsr_poll
+	.extern snsr_get_value
+	.extern snsr_get_stats
+
+/* common/include/channel.h (CHAN_XXX offsets and macros are in arm-coroutine.h) */
+	.extern chan_init
+	.extern chan_free
+	.extern chan_reserve
+	.extern chan_commit
+	.extern chan_peek
+	.extern chan_release
+	.extern chan_count
+	.extern chan_send
+	.extern chan_recv
+
+/* common/include/motorprofile.h */
+	.equiv	MOTOR_MAX_PROFILES, 16
+	.equiv	MOTOR_PROF_RAMP_UP, 0x01
+	.equiv	MOTOR_PROF_RAMP_DOWN, 0x02
+	.equiv	MOTOR_PROF_STOP_ACTION, 0x04
+	.equiv	MOTOR_PROF_SPEED, 0x08
+	.equiv	MOTOR_PROF_POSITION, 0x10
+	.equiv	MOTOR_PROF_ALL, 0x1F
+
+	/* MOTOR_PROFILE structure offsets */
+	.equiv	MOTOR_PROFILE_NAME, 0
+	.equiv	MOTOR_PROFILE_FIELDS, 4
+	.equiv	MOTOR_PROFILE_RAMP_UP_SP, 8
+	.equiv	MOTOR_PROFILE_RAMP_DOWN_SP, 12
+	.equiv	MOTOR_PROFILE_STOP_ACTION, 16
+	.equiv	MOTOR_PROFILE_SPEED_SP, 20
+	.equiv	MOTOR_PROFILE_POSITION_SP, 24
+	.equiv	MOTOR_PROFILE_SIZE, 28
+
+	.extern motor_register_profile
+	.extern motor_find_profile
+	.extern motor_apply_profile
+	.extern motor_apply_profile_vec
+	.extern motor_invalidate
+	.extern motor_current_profile
+	.extern motor_get_profile_stats
+
+/* common/include/stalldet.h */
+	.equiv	STALL_MAX_MOTORS, 4
+	.equiv	STALL_PERIOD_US, 2000
+	.equiv	STALL_USE_STATE, 0x01
+	.equiv	STALL_STOP_MOTOR, 0x02
+
+	.extern stall_add_motor
+	.extern stall_arm
+	.extern stall_disarm
+	.extern stall_detected
+	.extern stall_get_position
+	.extern stall_poll
+	.extern stall_start
+	.extern stall_stop
+	.extern stall_get_stats
+
+/* common/include/power.h */
+	.equiv	PWR_MAX_ACCOUNTS, 16
+	.equiv	PWR_PERIOD_US, 100000
+	.equiv	PWR_NOMINAL_MV, 7500
+	.equiv	PWR_MAX_GAIN_PCT, 150
+	.equiv	PWR_IDLE_ACCOUNT, 0
+
+	.extern pwr_init
+	.extern pwr_add_behavior
+	.extern pwr_add_actuator
+	.extern pwr_set_behavior
+	.extern pwr_poll
+	.extern pwr_start
+	.extern pwr_stop
+	.extern pwr_get_voltage
+	.extern pwr_get_current
+	.extern pwr_compensate
+	.extern pwr_get_energy
+	.extern pwr_get_total_energy
+	.extern pwr_report
+
+/* common/include/colorlut.h */
+	.equiv	CLUT_BITS, 4
+	.equiv	CLUT_LEVELS, (1 << CLUT_BITS)
+	.equiv	CLUT_CELLS, (CLUT_LEVELS * CLUT_LEVELS * CLUT_LEVELS)
+	.equiv	CLUT_MAX_CLASSES, 15
+	.equiv	CLUT_UNKNOWN, 0x0F
+	.equiv	CLUT_MAX_CONF, 15
+
+	/* CLUT structure offsets */
+	.equiv	CLUT_SCALE, 0
+	.equiv	CLUT_RANGE, 12
+	.equiv	CLUT_NUM_CLASSES, 24
+	.equiv	CLUT_CELLS_OFFSET, 28
+	.equiv	CLUT_SIZE, (CLUT_CELLS_OFFSET + CLUT_CELLS)
+
+	.extern clut_cal_init
+	.extern clut_cal_add
+	.extern clut_bake
+	.extern clut_lookup
+	.extern clut_classify
+	.extern clut_classify_batch
+	.extern clut_save
+	.extern clut_load
+
+/* common/include/occgrid.h */
+	.equiv	OGRID_TILE, 8
+	.equiv	OGRID_ANGLES, 256
+	.equiv	OGRID_MAX_RAY_CELLS, 128
+	.equiv	OGRID_LOGODDS_MAX, 100
+	.equiv	OGRID_OCC_THRESHOLD, 20
+
+	/* OGRID_POSE structure offsets */
+	.equiv	OGRID_POSE_X, 0
+	.equiv	OGRID_POSE_Y, 4
+	.equiv	OGRID_POSE_HEADING, 8
+	.equiv	OGRID_POSE_SIZE, 12
+
+	/* OGRID structure size */
+	.equiv	OGRID_SIZE, 24
+
+	.extern ogrid_init
+	.extern ogrid_free
+	.extern ogrid_clear
+	.extern ogrid_update
+	.extern ogrid_get
+	.extern ogrid_freest_direction
+	.extern ogrid_cos_sin
+	.extern ogrid_dump
+
+/* common/include/params.h */
+	.equiv	PRM_MAX_PARAMS, 64
+	.equiv	PRM_NAME_SIZE, 24
+	.equiv	PRM_S32, 0
+	.equiv	PRM_U32, 1
+	.equiv	PRM_BOOL, 2
+
+	/* PRM_DEF structure offsets */
+	.equiv	PRM_DEF_NAME, 0
+	.equiv	PRM_DEF_TYPE, 4
+	.equiv	PRM_DEF_DEFAULT, 8
+	.equiv	PRM_DEF_MIN, 12
+	.equiv	PRM_DEF_MAX, 16
+	.equiv	PRM_DEF_SIZE, 20
+
+	.extern prm_values
+	.extern prm_open
+	.extern prm_close
+	.extern prm_is_shared
+	.extern prm_count
+	.extern prm_find
+	.extern prm_get
+	.extern prm_set
+	.extern prm_generation
+	.extern prm_changed
+	.extern prm_snapshot
+
+/* common/include/bridge.h */
+	.equiv	BRG_MAX_SENSORS, 8
+	.equiv	BRG_MAX_TACHOS, 4
+	.equiv	BRG_CMD_ARGS, 4
+	.equiv	BRG_CMD_SLOTS, 16
+	.equiv	BRG_CMD_NONE, 0
+	.equiv	BRG_CMD_VELOCITY, 1
+	.equiv	BRG_CMD_BEHAVIOR, 2
+	.equiv	BRG_CMD_STOP, 3
+	.equiv	BRG_CMD_USER, 16
+
+	/* BRG_CMD structure offsets */
+	.equiv	BRG_CMD_TYPE, 0
+	.equiv	BRG_CMD_SEQNO, 4
+	.equiv	BRG_CMD_ARG, 8
+	.equiv	BRG_CMD_SIZE, 24
+
+	.extern brg_open
+	.extern brg_close
+	.extern brg_set_sensor
+	.extern brg_set_tacho
+	.extern brg_set_state
+	.extern brg_publish
+	.extern brg_receive
+	.extern brg_peer_alive
+
+/* common/include/heading.h */
+	.equiv	HDG_PERIOD_US, 2000
+	.equiv	HDG_ODO_WEIGHT, 16
+	.equiv	HDG_GYRO_INVERT, 0x01
+	.equiv	HDG_TURN_STOP, 0x01
+
+	.extern hdg_set_gyro
+	.extern hdg_set_odometry
+	.extern hdg_set_odometry_weight
+	.extern hdg_calibrate
+	.extern hdg_reset
+	.extern hdg_poll
+	.extern hdg_start
+	.extern hdg_stop
+	.extern hdg_get_heading
+	.extern hdg_get_rate
+	.extern hdg_get_bias
+	.extern hdg_get_sources
+	.extern hdg_turn_start
+	.extern hdg_turn_done
+	.extern hdg_turn_remaining
+
+/* common/include/dcmotor.h */
+	.equiv	DCM_MAX_MOTORS, 4
+	.equiv	DCM_DEFAULT_PERIOD_US, 10000
+	.equiv	DCM_DUTY_MAX, 100
+	.equiv	DCM_INVERT, 0x01
+	.equiv	DCM_FB_SENSOR, 0x00
+	.equiv	DCM_FB_TACHO, 0x01
+	.equiv	DCM_FB_INVERT, 0x02
+
+	.extern dcm_add_dc
+	.extern dcm_add_servo
+	.extern dcm_set_period
+	.extern dcm_set_ramp
+	.extern dcm_set_feedback
+	.extern dcm_set_gains
+	.extern dcm_set_duty
+	.extern dcm_set_speed
+	.extern dcm_halt
+	.extern dcm_get_duty
+	.extern dcm_get_speed
+	.extern dcm_poll
+	.extern dcm_start
+	.extern dcm_stop
+	.extern dcm_release
+
+/* common/include/numfmt.h */
+	.equiv	NFMT_BUF_SIZE, 36
+	.equiv	NFMT_SIGNED, 0x01
+	.equiv	NFMT_PLUS, 0x02
+	.equiv	NFMT_PREFIX, 0x04
+
+	.extern nfmt_udec
+	.extern nfmt_udec_ref
+	.extern nfmt_dec
+	.extern nfmt_hex
+	.extern nfmt_bin
+
+/* common/include/stackcoro.h */
+	.equiv	SCORO_DEFAULT_STACK, 4096
+	.equiv	SCORO_MIN_STACK, 1024
+	.equiv	SCORO_READY, 0
+	.equiv	SCORO_WAIT, 1
+	.equiv	SCORO_YIELD, 2
+	.equiv	SCORO_END, 3
+
+	.extern scoro_create
+	.extern scoro_resume
+	.extern scoro_yield
+	.extern scoro_wait
+	.extern scoro_restart
+	.extern scoro_alive
+	.extern scoro_current
+	.extern scoro_stack_used
+	.extern scoro_destroy
+
+/* common/include/startup.h */
+	.extern stup_mark
+	.extern stup_report
+
+/* common/include/telemetry.h */
+	.equiv	TLM_MAX_FIELDS, 16
+	.equiv	TLM_DEFAULT_PORT, 5555
+
+	.extern tlm_init
+	.extern tlm_set
+	.extern tlm_commit
+	.extern tlm_submit
+	.extern tlm_dropped
+	.extern tlm_exit
+
 
 #endif
@@ -0,0 +1,573 @@
+#!/usr/bin/env python3
+#
+# ARM-BBR state machine compiler
+#
+# Compiles a declarative state machine (or behavior) description into table-driven ARM Assembly and/or C,
+# and a Graphviz graph for review.
+#
+# Usage: bbrfsm.py escape.fsm [--asm escape-fsm.h] [--c escape] [--dot escape.dot] [--strict]
+#
+# Description format (one declaration per line, # starts a comment):
+#
+#        machine escape                                   state machine name (lower case)
+#        behavior [run=ROUTINE]                           also define the escape BBR behavior (Assembly only)
+#        state IDLE do=escape_check_sting                 the first state is the initial state (or mark it initial)
+#        state RAISE_HEAD active do=escape_check_head enter=escape_raise_head
+#        state ESCAPING active do=escape_check_moved enter=escape_start_moving
+#        event STING
+#        event HEAD_UP
+#        event MOVED
+#        IDLE STING -> RAISE_HEAD
+#        RAISE_HEAD HEAD_UP -> ESCAPING
+#        ESCAPING MOVED -> IDLE / escape_done              / ACTION: routine called on the transition
+#        * ABORT -> IDLE                                   * : from every state without its own ABORT transition
+#
+# Each step (escape_step) calls the do routine of the current state, which returns an event (ESCAPE_EV_XXX)
+# or ESCAPE_EV_NONE in r0. If the current state has a transition for the event, the state changes (escape_state),
+# then the transition action and the enter routine of the new state are called. escape_step returns the state in r0.
+#
+# The do, enter and action routine of each state and transition are looked up in dense tables indexed by
+# state * ESCAPE_NUM_EVENTS + event, so each step takes the same time whatever the number of states.
+# The state and event numbers are .equiv constants (#define in C), resolved when the tables are assembled.
+#
+# The Assembly output is a header to include in the robot program after DEFINE_BHVR_SUPPRESS. With behavior,
+# trigger_escape runs escape_step, and the behavior is triggered while the machine is in an active state,
+# so CALL_BEHAVIOR escape in the event loop runs the machine and suppresses lower priority behaviors as usual.
+# The C output (PREFIX.h and PREFIX.c) has the same tables and escape_step()/escape_reset() routines.
+
+import argparse
+import os
+import re
+import sys
+
+FSM_MAX_STATES = 255                    # 0xFF marks no transition
+FSM_MAX_EVENTS = 255                    # 0xFF is EV_NONE
+FSM_NO_TRANSITION = 0xFF
+FSM_EV_NONE = 0xFF
+
+IDENT = re.compile(r'^[A-Za-z_][A-Za-z0-9_]*$')
+
+
+class FsmError(Exception):
+    pass
+
+
+class State(object):
+    def __init__(self, name, line):
+        self.name = name
+        self.line = line
+        self.do = None
+        self.enter = None
+        self.active = False
+        self.initial = False
+
+
+class Machine(object):
+    def __init__(self):
+        self.name = None
+        self.source = None
+        self.behavior = False
+        self.run = None
+        self.states = []
+        self.events = []
+        self.transitions = {}           # (state index, event index) -> (next state index, action)
+        self.wildcards = []             # (event index, next state index, action, line)
+
+    @property
+    def prefix(self):
+        return self.name.upper()
+
+    def state_index(self, name, where):
+        for i, s in enumerate(self.states):
+            if s.name == name:
+                return i
+        raise FsmError('%s: unknown state %s' % (where, name))
+
+    def event_index(self, name, where):
+        if name in self.events:
+            return self.events.index(name)
+        raise FsmError('%s: unknown event %s' % (where, name))
+
+    @property
+    def initial(self):
+        marked = [i for i, s in enumerate(self.states) if s.initial]
+        return marked[0] if marked else 0
+
+    def actions(self):
+        """Distinct transition actions, in order of first use (index 0 is no action)"""
+        actions = [None]
+        for key in sorted(self.transitions):
+            action = self.transitions[key][1]
+            if action not in actions:
+                actions.append(action)
+        return actions
+
+    def routines(self):
+        """External routines as (name, kind)"""
+        seen = {}
+        for s in self.states:
+            for r, kind in ((s.do, 'do'), (s.enter, 'enter')):
+                if r:
+                    seen.setdefault(r, kind)
+        for a in self.actions()[1:]:
+            seen.setdefault(a, 'action')
+        if self.run:
+            seen.setdefault(self.run, 'run')
+        return sorted(seen.items())
+
+
+def _check_ident(name, where):
+    if not IDENT.match(name):
+        raise FsmError('%s: invalid name %s' % (where, name))
+    return name
+
+
+def parse(path):
+    m = Machine()
+    m.source = os.path.basename(path)
+    pending = []                        # Transitions are resolved once all states and events are known
+
+    with open(path) as f:
+        for lineno, raw in enumerate(f, 1):
+            where = '%s:%d' % (path, lineno)
+            line = raw.split('#', 1)[0].strip()
+            if not line:
+                continue
+            words = line.split()
+            keyword = words[0]
+
+            if keyword == 'machine':
+                if m.name or len(words) != 2:
+                    raise FsmError('%s: expected one machine NAME' % where)
+                m.name = _check_ident(words[1], where).lower()
+            elif keyword == 'behavior':
+                m.behavior = True
+                for opt in words[1:]:
+                    if not opt.startswith('run='):
+                        raise FsmError('%s: unknown behavior option %s' % (where, opt))
+                    m.run = _check_ident(opt[4:], where)
+            elif keyword == 'state':
+                if len(words) < 2:
+                    raise FsmError('%s: expected state NAME [options]' % where)
+                name = _check_ident(words[1], where).upper()
+                if any(s.name == name for s in m.states):
+                    raise FsmError('%s: duplicate state %s' % (where, name))
+                s = State(name, lineno)
+                for opt in words[2:]:
+                    if opt == 'active':
+                        s.active = True
+                    elif opt == 'initial':
+                        s.initial = True
+                    elif opt.startswith('do='):
+                        s.do = _check_ident(opt[3:], where)
+                    elif opt.startswith('enter='):
+                        s.enter = _check_ident(opt[6:], where)
+                    else:
+                        raise FsmError('%s: unknown state option %s' % (where, opt))
+                m.states.append(s)
+            elif keyword == 'event':
+                for name in words[1:]:
+                    name = _check_ident(name, where).upper()
+                    if name in m.events:
+                        raise FsmError('%s: duplicate event %s' % (where, name))
+                    m.events.append(name)
+            else:
+                # FROM EVENT -> TO [/ ACTION]
+                if (len(words) not in (4, 6)) or (words[2] != '->') or ((len(words) == 6) and (words[4] != '/')):
+                    raise FsmError('%s: expected FROM EVENT -> TO [/ ACTION]' % where)
+                action = _check_ident(words[5], where) if len(words) == 6 else None
+                pending.append((where, words[0].upper(), words[1].upper(), words[3].upper(), action))
+
+    if not m.name:
+        raise FsmError('%s: no machine declaration' % path)
+    if not m.states:
+        raise FsmError('%s: no states' % path)
+    if not m.events:
+        raise FsmError('%s: no events' % path)
+    if len(m.states) > FSM_MAX_STATES or len(m.events) > FSM_MAX_EVENTS:
+        raise FsmError('%s: at most %d states and %d events' % (path, FSM_MAX_STATES, FSM_MAX_EVENTS))
+    if sum(1 for s in m.states if s.initial) > 1:
+        raise FsmError('%s: more than one initial state' % path)
+
+    for where, src, event, dst, action in pending:
+        e = m.event_index(event, where)
+        d = m.state_index(dst, where)
+        if src == '*':
+            m.wildcards.append((e, d, action, where))
+            continue
+        key = (m.state_index(src, where), e)
+        if key in m.transitions:
+            raise FsmError('%s: duplicate transition %s %s' % (where, src, event))
+        m.transitions[key] = (d, action)
+
+    for e, d, action, where in m.wildcards:
+        for i in range(len(m.states)):
+            m.transitions.setdefault((i, e), (d, action))      # Explicit transitions take precedence
+    return m
+
+
+def warnings(m):
+    """Unreachable states, and states which can never leave"""
+    result = []
+    reached = {m.initial}
+    todo = [m.initial]
+    while todo:
+        i = todo.pop()
+        for (src, _), (dst, _) in m.transitions.items():
+            if src == i and dst not in reached:
+                reached.add(dst)
+                todo.append(dst)
+    for i, s in enumerate(m.states):
+        if i not in reached:
+            result.append('state %s is unreachable' % s.name)
+        outgoing = any(src == i for (src, _) in m.transitions)
+        if outgoing and not s.do:
+            result.append('state %s has transitions but no do routine to raise events' % s.name)
+    for e, name in enumerate(m.events):
+        if not any(ev == e for (_, ev) in m.transitions):
+            result.append('event %s is never used' % name)
+    return result
+
+
+def tables(m):
+    """Dense next state and action index tables, one row of events per state"""
+    actions = m.actions()
+    nxt = []
+    act = []
+    for i in range(len(m.states)):
+        row_next = []
+        row_act = []
+        for e in range(len(m.events)):
+            if (i, e) in m.transitions:
+                d, action = m.transitions[(i, e)]
+                row_next.append(d)
+                row_act.append(actions.index(action))
+            else:
+                row_next.append(FSM_NO_TRANSITION)
+                row_act.append(0)
+        nxt.append(row_next)
+        act.append(row_act)
+    return nxt, act, actions
+
+
+def _bytes(values):
+    return ', '.join('0x%02X' % v for v in values)
+
+
+def write_asm(m, path):
+    n, P = m.name, m.prefix
+    nxt, act, actions = tables(m)
+    out = []
+    w = out.append
+
+    w('/* %s state machine (generated by scripts/bbrfsm.py from %s, do not edit) */' % (n, m.source))
+    w('')
+    w('#pragma once')
+    w('')
+    w('#ifdef __ASSEMBLY__')
+    w('')
+    for i, s in enumerate(m.states):
+        w('\t.equiv\t%s_ST_%s, %d' % (P, s.name, i))
+    w('\t.equiv\t%s_NUM_STATES, %d' % (P, len(m.states)))
+    w('')
+    for e, name in enumerate(m.events):
+        w('\t.equiv\t%s_EV_%s, %d' % (P, name, e))
+    w('\t.equiv\t%s_NUM_EVENTS, %d' % (P, len(m.events)))
+    w('\t.equiv\t%s_EV_NONE, 0x%02X' % (P, FSM_EV_NONE))
+    w('\t.equiv\t%s_NO_TRANSITION, 0x%02X' % (P, FSM_NO_TRANSITION))
+    w('')
+    w('\t.data')
+    w('\t.align')
+    w('\t.global %s_state' % n)
+    w('%s_state:\t.byte\t%s_ST_%s' % (n, P, m.states[m.initial].name))
+    w('')
+    w('\t.section .rodata')
+    w('\t.align 2')
+    w('%s_fsm_do:\t\t\t\t\t\t\t// Per state: returns an event in r0' % n)
+    for s in m.states:
+        w('\t.word\t%s\t\t\t\t// %s' % (s.do or '%s_fsm_no_event' % n, s.name))
+    w('%s_fsm_enter:\t\t\t\t\t\t// Per state: called on entry' % n)
+    for s in m.states:
+        w('\t.word\t%s\t\t\t\t// %s' % (s.enter or '%s_fsm_nop' % n, s.name))
+    w('%s_fsm_actions:\t\t\t\t\t\t// Transition actions (0: none)' % n)
+    for a in actions:
+        w('\t.word\t%s' % (a or '%s_fsm_nop' % n))
+    w('%s_fsm_next:\t\t\t\t\t\t\t// [state][event]: next state' % n)
+    for s, row in zip(m.states, nxt):
+        w('\t.byte\t%s\t\t// %s' % (_bytes(row), s.name))
+    w('%s_fsm_action:\t\t\t\t\t\t// [state][event]: action index' % n)
+    for s, row in zip(m.states, act):
+        w('\t.byte\t%s\t\t// %s' % (_bytes(row), s.name))
+    w('%s_fsm_active:\t\t\t\t\t\t// Per state: behavior active' % n)
+    w('\t.byte\t%s' % ', '.join('TRUE' if s.active else 'FALSE' for s in m.states))
+    w('')
+    w('\t.text')
+    w('\t.align')
+    w('')
+    w('%s_fsm_nop:' % n)
+    w('\tbx\t\tlr')
+    w('')
+    w('%s_fsm_no_event:' % n)
+    w('\tmov\t\tr0, #%s_EV_NONE' % P)
+    w('\tbx\t\tlr')
+    w('')
+    w('/** %s_step' % n)
+    w(' *')
+    w(' *    Run the do routine of the current state, and take the transition for the event it returns')
+    w(' *')
+    w(' * Parameters:')
+    w(' *   None')
+    w(' * Returns:')
+    w(' *   r0: Current state')
+    w(' *')
+    w(' * r4: %s_state address' % n)
+    w(' * r5: state, then next state')
+    w(' * r6: transition index (state * %s_NUM_EVENTS + event)' % P)
+    w(' *')
+    w(' **/')
+    w('\t.global %s_step' % n)
+    w('\t.type\t%s_step, %%function' % n)
+    w('%s_step:' % n)
+    w('\tpush\t{r4, r5, r6, lr}')
+    w('\tldr\t\tr4, =%s_state' % n)
+    w('\tldrb\tr5, [r4]')
+    w('\tldr\t\tr1, =%s_fsm_do' % n)
+    w('\tldr\t\tr1, [r1, r5, lsl #2]')
+    w('\tblx\t\tr1\t\t\t\t\t\t\t// r0: event')
+    w('\tcmp\t\tr0, #%s_NUM_EVENTS' % P)
+    w('\tbhs\t\t%s_step_exit\t\t\t\t// No event' % n)
+    w('\tmov\t\tr1, #%s_NUM_EVENTS' % P)
+    w('\tmla\t\tr6, r5, r1, r0')
+    w('\tldr\t\tr1, =%s_fsm_next' % n)
+    w('\tldrb\tr5, [r1, r6]')
+    w('\tcmp\t\tr5, #%s_NO_TRANSITION' % P)
+    w('\tbeq\t\t%s_step_exit\t\t\t\t// Event ignored in this state' % n)
+    w('\tstrb\tr5, [r4]\t\t\t\t\t// Change state')
+    w('\tldr\t\tr1, =%s_fsm_action' % n)
+    w('\tldrb\tr1, [r1, r6]')
+    w('\tldr\t\tr2, =%s_fsm_actions' % n)
+    w('\tldr\t\tr1, [r2, r1, lsl #2]')
+    w('\tblx\t\tr1\t\t\t\t\t\t\t// Transition action')
+    w('\tldr\t\tr1, =%s_fsm_enter' % n)
+    w('\tldr\t\tr1, [r1, r5, lsl #2]')
+    w('\tblx\t\tr1\t\t\t\t\t\t\t// Enter the next state')
+    w('%s_step_exit:' % n)
+    w('\tldrb\tr0, [r4]')
+    w('\tpop\t\t{r4, r5, r6, pc}')
+    w('')
+    w('/** %s_reset' % n)
+    w(' *')
+    w(' *    Set the initial state (the enter routine is not called)')
+    w(' *')
+    w(' **/')
+    w('\t.global %s_reset' % n)
+    w('\t.type\t%s_reset, %%function' % n)
+    w('%s_reset:' % n)
+    w('\tldr\t\tr1, =%s_state' % n)
+    w('\tmov\t\tr0, #%s_ST_%s' % (P, m.states[m.initial].name))
+    w('\tstrb\tr0, [r1]')
+    w('\tbx\t\tlr')
+    w('')
+    if m.behavior:
+        w('/** Trigger for %s' % n)
+        w(' *')
+        w(' *    Runs %s_step, the behavior is triggered in the active states' % n)
+        w(' *')
+        w(' **/')
+        w('\tBEHAVIOR_TRIGGER %s' % n)
+        w('\tpush\t{r4, lr}')
+        w('\tbl\t\t%s_step' % n)
+        w('\tldr\t\tr1, =%s_fsm_active' % n)
+        w('\tldrb\tr0, [r1, r0]')
+        w('\tpop\t\t{r4, pc}')
+        w('')
+        w('\tBEHAVIOR_PROLOGUE %s' % n)
+        if m.run:
+            w('\tbl\t\t%s' % m.run)
+        w('\tBEHAVIOR_EPILOGUE %s' % n)
+        w('')
+    w('\t.ltorg')
+    w('#endif')
+    with open(path, 'w') as f:
+        f.write('\n'.join(out) + '\n')
+
+
+def write_c(m, prefix):
+    n, P = m.name, m.prefix
+    nxt, act, actions = tables(m)
+    base = os.path.basename(prefix)
+
+    h = []
+    w = h.append
+    w('/* %s state machine (generated by scripts/bbrfsm.py from %s, do not edit) */' % (n, m.source))
+    w('')
+    w('#pragma once')
+    w('')
+    w('#include "ev3dev-arm-ctypes.h"')
+    w('#include <stdbool.h>')
+    w('')
+    for i, s in enumerate(m.states):
+        w('#define %-32s %d' % ('%s_ST_%s' % (P, s.name), i))
+    w('#define %-32s %d' % ('%s_NUM_STATES' % P, len(m.states)))
+    w('')
+    for e, name in enumerate(m.events):
+        w('#define %-32s %d' % ('%s_EV_%s' % (P, name), e))
+    w('#define %-32s %d' % ('%s_NUM_EVENTS' % P, len(m.events)))
+    w('#define %-32s 0x%02X' % ('%s_EV_NONE' % P, FSM_EV_NONE))
+    w('')
+    w('extern U8 %s_state;' % n)
+    w('')
+    w('/* Routines provided by the program */')
+    for r, kind in m.routines():
+        if kind == 'do':
+            w('U32 %s(void);' % r)
+        else:
+            w('void %s(void);' % r)
+    w('')
+    w('U32 %s_step(void);' % n)
+    w('void %s_reset(void);' % n)
+    w('bool %s_is_active(void);' % n)
+
+    c = []
+    w = c.append
+    w('/* %s state machine (generated by scripts/bbrfsm.py from %s, do not edit) */' % (n, m.source))
+    w('')
+    w('#include "%s.h"' % base)
+    w('')
+    w('#define %s_NO_TRANSITION 0x%02X' % (P, FSM_NO_TRANSITION))
+    w('')
+    w('U8 %s_state = %s_ST_%s;' % (n, P, m.states[m.initial].name))
+    w('')
+    if not all(s.do for s in m.states):
+        w('static U32 %s_fsm_no_event(void) { return %s_EV_NONE; }' % (n, P))
+    w('static void %s_fsm_nop(void) { }' % n)
+    w('')
+    w('static U32 (* const %s_fsm_do[%s_NUM_STATES])(void) = {' % (n, P))
+    for s in m.states:
+        w('\t[%s_ST_%s] = %s,' % (P, s.name, s.do or '%s_fsm_no_event' % n))
+    w('};')
+    w('')
+    w('static void (* const %s_fsm_enter[%s_NUM_STATES])(void) = {' % (n, P))
+    for s in m.states:
+        w('\t[%s_ST_%s] = %s,' % (P, s.name, s.enter or '%s_fsm_nop' % n))
+    w('};')
+    w('')
+    w('static void (* const %s_fsm_actions[%d])(void) = {' % (n, len(actions)))
+    for a in actions:
+        w('\t%s,' % (a or '%s_fsm_nop' % n))
+    w('};')
+    w('')
+    w('static const U8 %s_fsm_next[%s_NUM_STATES][%s_NUM_EVENTS] = {' % (n, P, P))
+    for s, row in zip(m.states, nxt):
+        w('\t[%s_ST_%s] = { %s },' % (P, s.name, _bytes(row)))
+    w('};')
+    w('')
+    w('static const U8 %s_fsm_action[%s_NUM_STATES][%s_NUM_EVENTS] = {' % (n, P, P))
+    for s, row in zip(m.states, act):
+        w('\t[%s_ST_%s] = { %s },' % (P, s.name, _bytes(row)))
+    w('};')
+    w('')
+    w('static const bool %s_fsm_active[%s_NUM_STATES] = {' % (n, P))
+    w('\t%s' % ', '.join('true' if s.active else 'false' for s in m.states))
+    w('};')
+    w('')
+    w('U32 %s_step(void)' % n)
+    w('{')
+    w('\tU32 state = %s_state;' % n)
+    w('\tU32 event = %s_fsm_do[state]();' % n)
+    w('\tU32 next;')
+    w('')
+    w('\tif (event >= %s_NUM_EVENTS)' % P)
+    w('\t\treturn state;')
+    w('\tnext = %s_fsm_next[state][event];' % n)
+    w('\tif (next == %s_NO_TRANSITION)' % P)
+    w('\t\treturn state;')
+    w('\t%s_state = next;' % n)
+    w('\t%s_fsm_actions[%s_fsm_action[state][event]]();' % (n, n))
+    w('\t%s_fsm_enter[next]();' % n)
+    w('\treturn %s_state;' % n)
+    w('}')
+    w('')
+    w('void %s_reset(void)' % n)
+    w('{')
+    w('\t%s_state = %s_ST_%s;' % (n, P, m.states[m.initial].name))
+    w('}')
+    w('')
+    w('bool %s_is_active(void)' % n)
+    w('{')
+    w('\treturn %s_fsm_active[%s_state];' % (n, n))
+    w('}')
+
+    with open(prefix + '.h', 'w') as f:
+        f.write('\n'.join(h) + '\n')
+    with open(prefix + '.c', 'w') as f:
+        f.write('\n'.join(c) + '\n')
+
+
+def write_dot(m, path):
+    out = []
+    w = out.append
+    w('// %s state machine (generated by scripts/bbrfsm.py from %s)' % (m.name, m.source))
+    w('digraph %s {' % m.name)
+    w('\trankdir=LR;')
+    w('\tnode [shape=box, style=rounded];')
+    w('\t__start [shape=point];')
+    w('\t__start -> %s;' % m.states[m.initial].name)
+    for s in m.states:
+        label = s.name
+        if s.do:
+            label += '\\ndo: %s' % s.do
+        if s.enter:
+            label += '\\nenter: %s' % s.enter
+        style = ', style="rounded,bold"' if s.active else ''
+        w('\t%s [label="%s"%s];' % (s.name, label, style))
+    # One edge per (state, next state, action), listing its events
+    edges = {}
+    for (i, e), (d, action) in sorted(m.transitions.items()):
+        edges.setdefault((i, d, action), []).append(m.events[e])
+    for (i, d, action), events in sorted(edges.items(), key=lambda x: (x[0][0], x[0][1], x[0][2] or '')):
+        label = ', '.join(events) + ((' / %s' % action) if action else '')
+        w('\t%s -> %s [label="%s"];' % (m.states[i].name, m.states[d].name, label))
+    w('}')
+    with open(path, 'w') as f:
+        f.write('\n'.join(out) + '\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='ARM-BBR state machine compiler')
+    parser.add_argument('description', help='state machine description (.fsm)')
+    parser.add_argument('--asm', help='write the Assembly Language header to this file')
+    parser.add_argument('--c', help='write the C header and source to PREFIX.h and PREFIX.c')
+    parser.add_argument('--dot', help='write the Graphviz graph to this file')
+    parser.add_argument('--strict', action='store_true', help='fail on warnings')
+    args = parser.parse_args()
+
+    try:
+        m = parse(args.description)
+    except (FsmError, IOError) as e:
+        sys.exit('bbrfsm: %s' % e)
+
+    if args.asm and args.c and os.path.abspath(args.asm) == os.path.abspath(args.c + '.h'):
+        sys.exit('bbrfsm: the Assembly header and the C header have the same name')
+
+    problems = warnings(m)
+    for p in problems:
+        sys.stderr.write('bbrfsm: warning: %s\n' % p)
+    if problems and args.strict:
+        return 1
+
+    if args.asm:
+        write_asm(m, args.asm)
+    if args.c:
+        write_c(m, args.c)
+    if args.dot:
+        write_dot(m, args.dot)
+
+    print('%s: %d states, %d events, %d transitions, %d bytes of tables' % (
+        m.name, len(m.states), len(m.events), len(m.transitions),
+        2 * len(m.states) * len(m.events) + 9 * len(m.states) + 4 * len(m.actions())))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,172 @@
+#!/usr/bin/env python3
+#
+# ARM-BBR parameter store tool
+#
+# Lists and changes the parameters of a running robot program (common/include/params.h), e.g. on the EV3:
+#
+# Usage: bbrparam.py [-f FILE] list
+#        bbrparam.py [-f FILE] get NAME [NAME ...]
+#        bbrparam.py [-f FILE] set NAME=VALUE [NAME=VALUE ...]
+#        bbrparam.py [-f FILE] reset [NAME ...]
+#
+# The default file is the prm_open() default (/dev/shm/bbr.params). From a PC, run it over ssh:
+#
+#        ssh robot@ev3dev.local bbrparam.py set tacho_max_speed=300
+#
+# Each value is written with the same sequence lock protocol as prm_set(): the sequence is made odd, the value
+# is written, the generation is incremented and the sequence is made even again, so the robot never sees a torn update.
+# Values are checked against the parameter limits stored in the file. The values are kept in the file, so they are
+# used again by the next run of the same program (until the parameter table changes or the EV3 is rebooted).
+
+import argparse
+import mmap
+import struct
+import sys
+
+PRM_DEFAULT_PATH = '/dev/shm/bbr.params'
+PRM_NAME_SIZE = 24
+PRM_FILE_MAGIC = 0x50524242
+PRM_FILE_VERSION = 1
+PRM_HDR_MAGIC, PRM_HDR_VERSION, PRM_HDR_SCHEMA, PRM_HDR_COUNT, PRM_HDR_SEQ, PRM_HDR_GENERATION = range(6)
+PRM_HDR_WORDS = 8
+PRM_ENTRY = struct.Struct('<%dsIiii' % PRM_NAME_SIZE)
+PRM_TYPES = {0: 's32', 1: 'u32', 2: 'bool'}
+PRM_U32 = 1
+PRM_BOOL = 2
+BOOL_VALUES = {'true': 1, 'on': 1, 'yes': 1, 'false': 0, 'off': 0, 'no': 0}
+
+
+class Param(object):
+    def __init__(self, index, name, ptype, default, vmin, vmax):
+        self.index = index
+        self.name = name
+        self.type = ptype
+        self.default = default
+        self.min = vmin
+        self.max = vmax
+
+    def convert(self, value):
+        """Raw (signed) word of a value, as stored by prm_set()."""
+        return value - (1 << 32) if (self.type == PRM_U32 and value >= (1 << 31)) else value
+
+    def display(self, raw):
+        return raw & 0xFFFFFFFF if self.type == PRM_U32 else raw
+
+    def parse(self, text):
+        text = text.strip().lower()
+        if self.type == PRM_BOOL and text in BOOL_VALUES:
+            return BOOL_VALUES[text]
+        try:
+            value = int(text, 0)
+        except ValueError:
+            sys.exit('bbrparam: %s: invalid value %r' % (self.name, text))
+        low, high = self.display(self.min), self.display(self.max)
+        if not low <= value <= high:
+            sys.exit('bbrparam: %s: %d out of range [%d..%d]' % (self.name, value, low, high))
+        return self.convert(value)
+
+
+class Store(object):
+    def __init__(self, path):
+        try:
+            self.file = open(path, 'r+b')
+            self.map = mmap.mmap(self.file.fileno(), 0)
+        except (OSError, ValueError) as e:
+            sys.exit('bbrparam: %s: %s (is the robot program running?)' % (path, e))
+        magic, version, self.schema, count = struct.unpack_from('<4I', self.map, 0)
+        if magic != PRM_FILE_MAGIC or version != PRM_FILE_VERSION:
+            sys.exit('bbrparam: %s is not a parameter store' % path)
+        self.params = []
+        base = (PRM_HDR_WORDS + count) * 4
+        for i in range(count):
+            name, ptype, default, vmin, vmax = PRM_ENTRY.unpack_from(self.map, base + i * PRM_ENTRY.size)
+            name = name.split(b'\0')[0].decode('ascii')
+            self.params.append(Param(i, name, ptype, default, vmin, vmax))
+
+    def word(self, index):
+        return struct.unpack_from('<I', self.map, index * 4)[0]
+
+    def set_word(self, index, value, fmt='<I'):
+        struct.pack_into(fmt, self.map, index * 4, value)
+
+    def find(self, name):
+        for p in self.params:
+            if p.name == name:
+                return p
+        sys.exit('bbrparam: unknown parameter %s' % name)
+
+    def get(self, param):
+        while True:
+            seq = self.word(PRM_HDR_SEQ)
+            value = struct.unpack_from('<i', self.map, (PRM_HDR_WORDS + param.index) * 4)[0]
+            if not seq & 1 and seq == self.word(PRM_HDR_SEQ):
+                return value
+
+    def set(self, updates):
+        """Same sequence lock protocol as prm_set(), one update at a time."""
+        for param, value in updates:
+            seq = self.word(PRM_HDR_SEQ)
+            self.set_word(PRM_HDR_SEQ, (seq + 1) & 0xFFFFFFFF)
+            self.set_word(PRM_HDR_WORDS + param.index, value, '<i')
+            self.set_word(PRM_HDR_GENERATION, (self.word(PRM_HDR_GENERATION) + 1) & 0xFFFFFFFF)
+            self.set_word(PRM_HDR_SEQ, (seq + 2) & 0xFFFFFFFF)
+        self.map.flush()
+
+
+def cmd_list(store, args):
+    width = max([len(p.name) for p in store.params] + [4])
+    print('%-*s %-4s %11s %11s %11s %11s' % (width, 'name', 'type', 'value', 'default', 'min', 'max'))
+    for p in store.params:
+        print('%-*s %-4s %11d %11d %11d %11d' % (width, p.name, PRM_TYPES.get(p.type, '?'), p.display(store.get(p)),
+                                                  p.display(p.default), p.display(p.min), p.display(p.max)))
+    print('generation %d, schema %08x' % (store.word(PRM_HDR_GENERATION), store.schema))
+    return 0
+
+
+def cmd_get(store, args):
+    for name in args.names:
+        p = store.find(name)
+        print('%s=%d' % (name, p.display(store.get(p))))
+    return 0
+
+
+def cmd_set(store, args):
+    updates = []
+    for assignment in args.assignments:
+        name, sep, text = assignment.partition('=')
+        if not sep:
+            sys.exit('bbrparam: expected NAME=VALUE, got %r' % assignment)
+        p = store.find(name.strip())
+        updates.append((p, p.parse(text)))           # Check all values before writing any
+    store.set(updates)
+    return 0
+
+
+def cmd_reset(store, args):
+    params = [store.find(name) for name in args.names] if args.names else store.params
+    store.set([(p, p.default) for p in params])
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description='ARM-BBR parameter store tool')
+    parser.add_argument('-f', '--file', default=PRM_DEFAULT_PATH, help='parameter file (default %(default)s)')
+    sub = parser.add_subparsers(dest='command')
+    sub.add_parser('list', help='list the parameters')
+    p = sub.add_parser('get', help='get parameter values')
+    p.add_argument('names', nargs='+')
+    p = sub.add_parser('set', help='set parameter values')
+    p.add_argument('assignments', nargs='+', metavar='NAME=VALUE')
+    p = sub.add_parser('reset', help='reset parameters (all by default) to their default values')
+    p.add_argument('names', nargs='*')
+
+    args = parser.parse_args()
+    commands = {'list': cmd_list, 'get': cmd_get, 'set': cmd_set, 'reset': cmd_reset}
+    if args.command not in commands:
+        parser.print_help()
+        return 1
+    return commands[args.command](Store(args.file), args)
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,239 @@
+#!/usr/bin/env python3
+#
+# ARM-BBR color classifier calibration tool
+#
+# Bakes the color classifier lookup table (common/include/colorlut.h) on a PC from labelled
+# RGB-RAW traces, and measures the classification accuracy of a table against labelled test traces.
+#
+# Usage: colorcal.py bake train.csv [train2.csv ...] -o colors.lut [--names-header colors.h]
+#        colorcal.py test colors.lut test.csv [test2.csv ...] [--min-conf N] [--min-accuracy PERCENT]
+#
+# Traces are CSV files with one reading per line: label,r,g,b (lines starting with # are ignored).
+# Labels are class names, numbered in order of first appearance, or class numbers.
+#
+# The table is baked using the same integer arithmetic as clut_bake(), so a table baked here is
+# identical to one baked on the EV3 from the same samples. The file format is the clut_save() format
+# (magic "CLUT", then version, num_classes and the R, G, B ranges as little-endian 32-bit words, then the cells),
+# followed by the class names (one per line), which clut_load() ignores.
+#
+# test exits with status 1 when the accuracy is below --min-accuracy, so it can be used as a regression check
+# whenever the traces or the classifier change.
+
+import argparse
+import csv
+import struct
+import sys
+
+CLUT_BITS = 4
+CLUT_LEVELS = 1 << CLUT_BITS
+CLUT_CELLS = CLUT_LEVELS ** 3
+CLUT_MAX_CLASSES = 15
+CLUT_UNKNOWN = 0x0F
+CLUT_MAX_CONF = 15
+CLUT_REJECT_K = 3
+CLUT_REJECT_MIN = 20
+CLUT_FILE_MAGIC = b'CLUT'
+CLUT_FILE_VERSION = 1
+
+
+def load_traces(paths, names=None):
+    """Readings as (class, r, g, b) tuples; names are assigned class numbers in order of first appearance."""
+    names = list(names or [])
+    samples = []
+    for path in paths:
+        with open(path, newline='') as f:
+            for row in csv.reader(f):
+                if not row or row[0].startswith('#'):
+                    continue
+                label = row[0].strip()
+                try:
+                    r, g, b = (max(0, int(v)) for v in row[1:4])
+                except ValueError:
+                    continue                        # Header line
+                if label.isdigit():
+                    color = int(label)
+                    while len(names) <= color:
+                        names.append(str(len(names)))
+                else:
+                    if label not in names:
+                        names.append(label)
+                    color = names.index(label)
+                if color >= CLUT_MAX_CLASSES:
+                    sys.exit('colorcal: too many classes (max %d)' % CLUT_MAX_CLASSES)
+                samples.append((color, r, g, b))
+    return samples, names
+
+
+class Lut(object):
+    def __init__(self, num_classes, ranges, cells):
+        self.num_classes = num_classes
+        self.ranges = ranges
+        self.scales = [(CLUT_LEVELS << 16) // rng for rng in ranges]
+        self.cells = cells
+
+    def quantize(self, channel, value):
+        value = max(0, value)
+        if value >= self.ranges[channel]:
+            return CLUT_LEVELS - 1
+        return min((value * self.scales[channel]) >> 16, CLUT_LEVELS - 1)
+
+    def lookup(self, r, g, b):
+        return self.cells[(self.quantize(0, r) << (2 * CLUT_BITS)) | (self.quantize(1, g) << CLUT_BITS)
+                          | self.quantize(2, b)]
+
+    def classify(self, r, g, b, min_conf):
+        cell = self.lookup(r, g, b)
+        return (cell & 0x0F) if (cell >> 4) >= min_conf else CLUT_UNKNOWN
+
+
+def bake(samples):
+    """Same algorithm and integer arithmetic as clut_bake()."""
+    num_classes = max(s[0] for s in samples) + 1
+    count = [0] * num_classes
+    sums = [[0, 0, 0] for _ in range(num_classes)]
+    sumsq = [0] * num_classes
+    maxima = [0, 0, 0]
+    for color, r, g, b in samples:
+        count[color] += 1
+        for i, v in enumerate((r, g, b)):
+            sums[color][i] += v
+            sumsq[color] += v * v
+            maxima[i] = max(maxima[i], v)
+
+    means, spread2 = [], []
+    for c in range(num_classes):
+        if count[c] == 0:
+            sys.exit('colorcal: no samples for class %d' % c)
+        mean = [sums[c][i] // count[c] for i in range(3)]
+        means.append(mean)
+        spread2.append(max(0, sumsq[c] // count[c] - sum(m * m for m in mean)))
+
+    ranges = [m + m // 4 + 1 for m in maxima]
+    cells = bytearray(CLUT_CELLS)
+    centers = [[((2 * q + 1) * rng) // (2 * CLUT_LEVELS) for q in range(CLUT_LEVELS)] for rng in ranges]
+    index = 0
+    for cr in centers[0]:
+        for cg in centers[1]:
+            for cb in centers[2]:
+                dists = sorted(((cr - m[0]) ** 2 + (cg - m[1]) ** 2 + (cb - m[2]) ** 2, c)
+                               for c, m in enumerate(means))
+                d1, nearest = dists[0]
+                if d1 > CLUT_REJECT_K * CLUT_REJECT_K * spread2[nearest] + CLUT_REJECT_MIN * CLUT_REJECT_MIN:
+                    cells[index] = CLUT_UNKNOWN
+                else:
+                    if num_classes == 1:
+                        conf = CLUT_MAX_CONF
+                    else:
+                        d2 = dists[1][0]
+                        conf = (CLUT_MAX_CONF * (d2 - d1)) // d2 if d2 else 0
+                    cells[index] = (conf << 4) | nearest
+                index += 1
+    return Lut(num_classes, ranges, cells), means
+
+
+def save(lut, names, path):
+    with open(path, 'wb') as f:
+        f.write(CLUT_FILE_MAGIC)
+        f.write(struct.pack('<5I', CLUT_FILE_VERSION, lut.num_classes, *lut.ranges))
+        f.write(bytes(lut.cells))
+        f.write('\n'.join(names).encode('utf-8'))
+
+
+def load(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:4] != CLUT_FILE_MAGIC:
+        sys.exit('colorcal: %s is not a color lookup table' % path)
+    version, num_classes, r, g, b = struct.unpack('<5I', data[4:24])
+    if version != CLUT_FILE_VERSION:
+        sys.exit('colorcal: %s: unsupported version %d' % (path, version))
+    cells = bytearray(data[24:24 + CLUT_CELLS])
+    trailer = data[24 + CLUT_CELLS:].decode('utf-8')
+    names = trailer.split('\n') if trailer else [str(c) for c in range(num_classes)]
+    return Lut(num_classes, [r, g, b], cells), names
+
+
+def write_names_header(names, path):
+    with open(path, 'w') as f:
+        f.write('/* Color classes (generated by scripts/colorcal.py) */\n\n#pragma once\n\n')
+        for c, name in enumerate(names):
+            f.write('#define COLOR_%-16s %d\n' % (''.join(ch if ch.isalnum() else '_' for ch in name).upper(), c))
+
+
+def cmd_bake(args):
+    samples, names = load_traces(args.traces)
+    if not samples:
+        sys.exit('colorcal: no samples')
+    lut, means = bake(samples)
+    save(lut, names, args.output)
+    if args.names_header:
+        write_names_header(names, args.names_header)
+
+    unknown = sum(1 for cell in lut.cells if cell == CLUT_UNKNOWN)
+    print('%d samples, %d classes, ranges R %d G %d B %d' % ((len(samples), lut.num_classes) + tuple(lut.ranges)))
+    for c, name in enumerate(names):
+        print('  %2d %-16s mean %4d %4d %4d' % ((c, name) + tuple(means[c])))
+    print('%d of %d cells unknown' % (unknown, CLUT_CELLS))
+    return 0
+
+
+def cmd_test(args):
+    lut, names = load(args.lut)
+    samples, names = load_traces(args.traces, names)
+    if not samples:
+        sys.exit('colorcal: no samples')
+
+    width = max(len(n) for n in names + ['unknown'])
+    confusion = [[0] * (len(names) + 1) for _ in names]
+    correct = unknown = 0
+    for color, r, g, b in samples:
+        result = lut.classify(r, g, b, args.min_conf)
+        if result == CLUT_UNKNOWN:
+            unknown += 1
+            confusion[color][len(names)] += 1
+        else:
+            correct += (result == color)
+            if result < len(names):
+                confusion[color][result] += 1
+
+    print('%*s  %s' % (width, 'actual', ' '.join('%*s' % (width, n) for n in names + ['unknown'])))
+    for c, row in enumerate(confusion):
+        print('%*s  %s' % (width, names[c], ' '.join('%*d' % (width, n) for n in row)))
+
+    known = len(samples) - unknown
+    accuracy = 100.0 * correct / len(samples)
+    print('accuracy %.1f%% (%d of %d), %.1f%% of the classified readings, %.1f%% unknown'
+          % (accuracy, correct, len(samples), 100.0 * correct / known if known else 0.0,
+             100.0 * unknown / len(samples)))
+    if accuracy < args.min_accuracy:
+        print('FAIL: accuracy below %.1f%%' % args.min_accuracy)
+        return 1
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description='ARM-BBR color classifier calibration tool')
+    sub = parser.add_subparsers(dest='command')
+
+    p = sub.add_parser('bake', help='bake a lookup table from labelled traces')
+    p.add_argument('traces', nargs='+')
+    p.add_argument('-o', '--output', required=True, help='lookup table file')
+    p.add_argument('--names-header', help='write the class numbers as COLOR_XXX defines to this header')
+
+    p = sub.add_parser('test', help='classify labelled traces and report the accuracy')
+    p.add_argument('lut')
+    p.add_argument('traces', nargs='+')
+    p.add_argument('--min-conf', type=int, default=0, help='minimum confidence [0..15]')
+    p.add_argument('--min-accuracy', type=float, default=0.0, help='fail below this accuracy (percent)')
+
+    args = parser.parse_args()
+    if args.command == 'bake':
+        return cmd_bake(args)
+    if args.command == 'test':
+        return cmd_test(args)
+    parser.print_help()
+    return 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
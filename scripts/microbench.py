@@ -0,0 +1,146 @@
+#!/usr/bin/env python3
+#
+# ARM-BBR microbenchmark runner and comparator
+#
+# Runs source/benchmarks/microbench (on the EV3, or under qemu-arm user mode on a PC) and writes its
+# CSV results, then optionally compares them with a previous results file to catch regressions.
+#
+# Usage: microbench.py run [-b binary] [--qemu "qemu-arm -L <sysroot>"] [--insn-plugin libinsn.so]
+#                          [-o results.csv] [--baseline old.csv] [-- microbench args]
+#        microbench.py compare baseline.csv current.csv [-t percent]
+#
+# The EV3 has no hardware instruction counter. With --insn-plugin (the qemu "insn" TCG plugin),
+# each benchmark is run twice more with 1x and 2x iterations, and the instructions per operation are
+# the difference of the two instruction counts divided by the extra iterations, so that program
+# startup and harness overhead cancel out.
+#
+# compare reports a regression when the median time grows by more than the threshold and the
+# interquartile ranges do not overlap, or when the instructions per operation grow.
+
+import argparse
+import csv
+import io
+import re
+import shlex
+import subprocess
+import sys
+
+DEFAULT_BINARY = 'source/benchmarks/microbench/Debug/microbench'
+DEFAULT_THRESHOLD = 10.0                    # percent
+INSN_TOLERANCE = 0.5                        # instructions per op
+
+
+def run_cmd(cmd):
+    return subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                          universal_newlines=True, check=True)
+
+
+def count_insns(prefix, binary, name, scale):
+    """Total guest instructions for one run of a single benchmark (qemu insn plugin)."""
+    result = run_cmd(prefix + [binary, '-b', name, '-r', '1', '-w', '0', '-n', str(scale)])
+    match = re.search(r'insns:\s*(\d+)', result.stderr)
+    if not match:
+        raise RuntimeError('no instruction count from the qemu plugin (is -d plugin supported?)')
+    return int(match.group(1))
+
+
+def iteration_counts(prefix, binary, scale):
+    result = run_cmd(prefix + [binary, '-l', '-n', str(scale)])
+    return dict((name, int(count)) for name, count in (line.split() for line in result.stdout.splitlines()))
+
+
+def run(args):
+    prefix = shlex.split(args.qemu) if args.qemu else []
+    result = subprocess.run(prefix + [args.binary] + args.extra, stdout=subprocess.PIPE,
+                            universal_newlines=True, check=True)
+    rows = list(csv.DictReader(io.StringIO(result.stdout)))
+
+    if args.insn_plugin:
+        if not prefix:
+            sys.exit('microbench: --insn-plugin requires --qemu')
+        plugin = prefix + ['-plugin', args.insn_plugin, '-d', 'plugin']
+        single = iteration_counts(prefix, args.binary, 100)
+        double = iteration_counts(prefix, args.binary, 200)
+        for row in rows:
+            name = row['benchmark']
+            extra = double[name] - single[name]
+            insns = count_insns(plugin, args.binary, name, 200) - count_insns(plugin, args.binary, name, 100)
+            row['insn_per_op'] = '%.2f' % (float(insns) / extra)
+            sys.stderr.write('microbench: %-30s %s insn/op\n' % (name, row['insn_per_op']))
+
+    out = open(args.output, 'w', newline='') if args.output else sys.stdout
+    writer = csv.DictWriter(out, fieldnames=list(rows[0].keys()) if rows else [])
+    writer.writeheader()
+    writer.writerows(rows)
+    if args.output:
+        out.close()
+
+    if args.baseline:
+        return compare_files(args.baseline, args.output, args.threshold) if args.output else 0
+    return 0
+
+
+def load(path):
+    with open(path, newline='') as f:
+        return dict((row['benchmark'], row) for row in csv.DictReader(f))
+
+
+def compare_files(baseline_path, current_path, threshold):
+    baseline = load(baseline_path)
+    current = load(current_path)
+    regressions = 0
+
+    print('%-30s %12s %12s %8s  %s' % ('benchmark', 'base ns/op', 'ns/op', 'change', 'insn/op'))
+    for name, cur in current.items():
+        base = baseline.get(name)
+        if base is None:
+            print('%-30s %12s %12s %8s' % (name, '-', cur['ns_median'], 'new'))
+            continue
+        base_median, cur_median = float(base['ns_median']), float(cur['ns_median'])
+        change = (cur_median - base_median) * 100.0 / base_median if base_median else 0.0
+        slower = (change > threshold) and (float(cur['ns_q1']) > float(base['ns_q3']))
+
+        insn = ''
+        more_insns = False
+        if base['insn_per_op'] != 'NA' and cur['insn_per_op'] != 'NA':
+            base_insn, cur_insn = float(base['insn_per_op']), float(cur['insn_per_op'])
+            insn = '%s -> %s' % (base['insn_per_op'], cur['insn_per_op'])
+            more_insns = cur_insn > base_insn + INSN_TOLERANCE
+
+        flag = '  REGRESSION' if (slower or more_insns) else ''
+        regressions += 1 if flag else 0
+        print('%-30s %12s %12s %+7.1f%%  %s%s' % (name, base['ns_median'], cur['ns_median'], change, insn, flag))
+
+    print('%d regression(s)' % regressions)
+    return 1 if regressions else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description='ARM-BBR microbenchmark runner and comparator')
+    sub = parser.add_subparsers(dest='command')
+
+    p = sub.add_parser('run', help='run the benchmarks')
+    p.add_argument('-b', '--binary', default=DEFAULT_BINARY)
+    p.add_argument('--qemu', help='qemu-arm command prefix, e.g. "qemu-arm -L /usr/arm-linux-gnueabi"')
+    p.add_argument('--insn-plugin', help='path to the qemu insn plugin (libinsn.so)')
+    p.add_argument('-o', '--output', help='results CSV file (default: stdout)')
+    p.add_argument('--baseline', help='compare the results with this CSV file')
+    p.add_argument('-t', '--threshold', type=float, default=DEFAULT_THRESHOLD)
+    p.add_argument('extra', nargs='*', help='microbench arguments (after --)')
+
+    p = sub.add_parser('compare', help='compare two results files')
+    p.add_argument('baseline')
+    p.add_argument('current')
+    p.add_argument('-t', '--threshold', type=float, default=DEFAULT_THRESHOLD)
+
+    args = parser.parse_args()
+    if args.command == 'run':
+        return run(args)
+    if args.command == 'compare':
+        return compare_files(args.baseline, args.current, args.threshold)
+    parser.print_help()
+    return 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
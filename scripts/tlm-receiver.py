@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+#
+# ARM-BBR UDP telemetry receiver
+#
+# Listens for datagrams sent by common/src/telemetry.c and prints one CSV line per frame:
+#   seqno,systick,field0,field1,...
+#
+# Frame and datagram losses (sequence number gaps) and the robot's own dropped frame count
+# are reported to stderr.
+#
+# Usage: tlm-receiver.py [-p port] [-n name,name,...] [--plot [fields]]
+#
+# On the host, run the receiver, then start the robot program with
+#   BBR_TELEMETRY_HOST=<host IPv4 address>
+# Use 127.0.0.1 (the default) to test on a single machine.
+
+import argparse
+import collections
+import socket
+import struct
+import sys
+
+TLM_MAGIC = 0x4D4C
+TLM_VERSION = 1
+TLM_DEFAULT_PORT = 5555
+HEADER = struct.Struct('<HBBHHI')           # TLM_HEADER
+
+
+def decode(data):
+    """Return (header dict, list of (seqno, systick, fields)) or None if invalid."""
+    if len(data) < HEADER.size:
+        return None
+    magic, version, num_fields, num_frames, dgram_seqno, dropped = HEADER.unpack_from(data)
+    if magic != TLM_MAGIC or version != TLM_VERSION:
+        return None
+    frame = struct.Struct('<II%di' % num_fields)
+    if len(data) < HEADER.size + num_frames * frame.size:
+        return None
+    frames = []
+    for i in range(num_frames):
+        values = frame.unpack_from(data, HEADER.size + i * frame.size)
+        frames.append((values[0], values[1], values[2:]))
+    return {'num_fields': num_fields, 'seqno': dgram_seqno, 'dropped': dropped}, frames
+
+
+def main():
+    parser = argparse.ArgumentParser(description='ARM-BBR UDP telemetry receiver')
+    parser.add_argument('-p', '--port', type=int, default=TLM_DEFAULT_PORT)
+    parser.add_argument('-b', '--bind', default='0.0.0.0', help='local address to listen on')
+    parser.add_argument('-n', '--names', help='comma separated field names for the CSV header')
+    parser.add_argument('--plot', nargs='?', const='all', metavar='FIELDS',
+                        help='live plot (requires matplotlib); optional comma separated field indices')
+    parser.add_argument('--history', type=int, default=500, help='frames shown in the live plot')
+    args = parser.parse_args()
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind((args.bind, args.port))
+
+    names = args.names.split(',') if args.names else None
+    header_printed = False
+    last_frame = None
+    last_dgram = None
+    last_dropped = 0
+    history = None
+
+    plt = None
+    if args.plot:
+        import matplotlib.pyplot as plt
+        plt.ion()
+        sock.settimeout(0.1)
+
+    sys.stderr.write('tlm-receiver: listening on %s:%d\n' % (args.bind, args.port))
+    try:
+        while True:
+            try:
+                data, _ = sock.recvfrom(65536)
+            except socket.timeout:
+                if plt:
+                    plt.pause(0.01)
+                continue
+
+            decoded = decode(data)
+            if decoded is None:
+                sys.stderr.write('tlm-receiver: invalid datagram (%d bytes)\n' % len(data))
+                continue
+            hdr, frames = decoded
+
+            if last_dgram is not None and hdr['seqno'] != (last_dgram + 1) & 0xFFFF:
+                sys.stderr.write('tlm-receiver: datagram gap %d -> %d\n' % (last_dgram, hdr['seqno']))
+            last_dgram = hdr['seqno']
+            if hdr['dropped'] != last_dropped:
+                sys.stderr.write('tlm-receiver: robot dropped %d frames total\n' % hdr['dropped'])
+                last_dropped = hdr['dropped']
+
+            if not header_printed:
+                cols = names if names else ['field%d' % i for i in range(hdr['num_fields'])]
+                print('seqno,systick,' + ','.join(cols[:hdr['num_fields']]))
+                header_printed = True
+                if plt:
+                    fields = range(hdr['num_fields']) if args.plot == 'all' \
+                        else [int(f) for f in args.plot.split(',')]
+                    history = {f: collections.deque(maxlen=args.history) for f in fields}
+                    ticks = collections.deque(maxlen=args.history)
+                    fig, ax = plt.subplots()
+                    lines = {f: ax.plot([], [], label=cols[f] if f < len(cols) else str(f))[0]
+                             for f in fields}
+                    ax.set_xlabel('systick (s)')
+                    ax.legend(loc='upper left')
+
+            for seqno, systick, values in frames:
+                if last_frame is not None and seqno != (last_frame + 1) & 0xFFFFFFFF:
+                    sys.stderr.write('tlm-receiver: frame gap %d -> %d\n' % (last_frame, seqno))
+                last_frame = seqno
+                print('%d,%d,%s' % (seqno, systick, ','.join(str(v) for v in values)))
+                if history is not None:
+                    ticks.append(systick / 1e6)
+                    for f in history:
+                        history[f].append(values[f])
+            sys.stdout.flush()
+
+            if history is not None:
+                for f, line in lines.items():
+                    line.set_data(ticks, history[f])
+                ax.relim()
+                ax.autoscale_view()
+                plt.pause(0.001)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == '__main__':
+    main()
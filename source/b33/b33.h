@@ -40,6 +40,9 @@
 #define HEAD_STOP_MODE      TACHO_BRAKE
 #define HEAD_RUN_MODE       TACHO_RUN_FOREVER
 #define HEAD_STOPPED_SLACK  1						// Change in readings to indicate that head has stopped
+#define HEAD_STALL_MIN_SPEED    30					// Head has stopped below this speed (tacho counts/s, USE_STALL_DETECT)
+#define HEAD_STALL_DEBOUNCE_US  30000				// Time below HEAD_STALL_MIN_SPEED to indicate that head has stopped
+#define HEAD_STALL_GRACE_US     20000				// Head speed is not checked while starting up
 
 #define COLOR_READ_INTERVAL (3 * TICKS_PER_MSEC)		// 3 ms
 
@@ -54,11 +57,6 @@
     ENUM_N		ROBOT_FOLLOW_PATH
     ENUM_N		ROBOT_ESCAPE
 
-    // Escape State Enums
-    ENUM_0		ESCAPE_IDLE
-    ENUM_N		ESCAPE_ESCAPING
-    ENUM_N		ESCAPE_DONE
-
     // Movement Enums
     ENUM_0		MOVE_STOP
     ENUM_N		MOVE_FORWARD
@@ -170,6 +168,77 @@
 	bl		prog_display_integer_aligned
 	.endm
 
+/** STARTUP_MARK
+ *
+ *    Macro to record the end of a startup phase (see common/include/startup.h)
+ *
+ * Parameters:
+ *   phase_str: Address of phase name string
+ * Returns:
+ *   None
+ *
+ * Registers r0-r3 are modified
+ *
+ **/
+	.macro	STARTUP_MARK	phase_str
+	ldr		r0, =\phase_str
+	bl		stup_mark
+	.endm
+
+/** BUDGET_CALL
+ *
+ *    Macro to call a routine if the per-tick budget allows it (see common/include/budget.h)
+ *    The routine is deferred to the next tick otherwise.
+ *
+ * Parameters:
+ *   task_var: Address of the task number (from bdgt_register())
+ *   routine: Routine to call
+ * Returns:
+ *   None
+ *
+ * Registers r0-r3 are modified
+ *
+ **/
+	.macro	BUDGET_CALL	task_var, routine
+	ldr		r0, =\task_var
+	ldr		r0, [r0]
+	bl		bdgt_admit
+	cmp		r0, #FALSE
+	beq		budget_skip_\routine
+	bl		\routine
+	ldr		r0, =\task_var
+	ldr		r0, [r0]
+	bl		bdgt_done
+budget_skip_\routine:
+	.endm
+
+/** BUDGET_CORO_CALL
+ *
+ *    Macro to call a coroutine if the per-tick budget allows it (see common/include/budget.h)
+ *    The coroutine is deferred to the next tick otherwise.
+ *
+ * Parameters:
+ *   task_var: Address of the task number (from bdgt_register())
+ *   name: Coroutine name
+ * Returns:
+ *   None
+ *
+ * Registers r0-r3 are modified
+ *
+ **/
+	.macro	BUDGET_CORO_CALL	task_var, name
+	ldr		r0, =\task_var
+	ldr		r0, [r0]
+	bl		bdgt_admit
+	cmp		r0, #FALSE
+	beq		budget_skip_\name
+	CORO_CALL	\name
+	ldr		r0, =\task_var
+	ldr		r0, [r0]
+	bl		bdgt_done
+budget_skip_\name:
+	.endm
+
 /** record_systick
  *
  *    Macro to store current systick to systick_var
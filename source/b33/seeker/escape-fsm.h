@@ -0,0 +1,126 @@
+/* escape state machine (generated by scripts/bbrfsm.py from escape.fsm, do not edit) */
+
+#pragma once
+
+#ifdef __ASSEMBLY__
+
+	.equiv	ESCAPE_ST_IDLE, 0
+	.equiv	ESCAPE_ST_ESCAPING, 1
+	.equiv	ESCAPE_NUM_STATES, 2
+
+	.equiv	ESCAPE_EV_STING, 0
+	.equiv	ESCAPE_EV_DONE, 1
+	.equiv	ESCAPE_NUM_EVENTS, 2
+	.equiv	ESCAPE_EV_NONE, 0xFF
+	.equiv	ESCAPE_NO_TRANSITION, 0xFF
+
+	.data
+	.align
+	.global escape_state
+escape_state:	.byte	ESCAPE_ST_IDLE
+
+	.section .rodata
+	.align 2
+escape_fsm_do:							// Per state: returns an event in r0
+	.word	escape_check_sting				// IDLE
+	.word	escape_check_done				// ESCAPING
+escape_fsm_enter:						// Per state: called on entry
+	.word	escape_fsm_nop				// IDLE
+	.word	escape_start_moving				// ESCAPING
+escape_fsm_actions:						// Transition actions (0: none)
+	.word	escape_fsm_nop
+	.word	escape_done
+escape_fsm_next:							// [state][event]: next state
+	.byte	0x01, 0xFF		// IDLE
+	.byte	0xFF, 0x00		// ESCAPING
+escape_fsm_action:						// [state][event]: action index
+	.byte	0x00, 0x00		// IDLE
+	.byte	0x00, 0x01		// ESCAPING
+escape_fsm_active:						// Per state: behavior active
+	.byte	FALSE, TRUE
+
+	.text
+	.align
+
+escape_fsm_nop:
+	bx		lr
+
+escape_fsm_no_event:
+	mov		r0, #ESCAPE_EV_NONE
+	bx		lr
+
+/** escape_step
+ *
+ *    Run the do routine of the current state, and take the transition for the event it returns
+ *
+ * Parameters:
+ *   None
+ * Returns:
+ *   r0: Current state
+ *
+ * r4: escape_state address
+ * r5: state, then next state
+ * r6: transition index (state * ESCAPE_NUM_EVENTS + event)
+ *
+ **/
+	.global escape_step
+	.type	escape_step, %function
+escape_step:
+	push	{r4, r5, r6, lr}
+	ldr		r4, =escape_state
+	ldrb	r5, [r4]
+	ldr		r1, =escape_fsm_do
+	ldr		r1, [r1, r5, lsl #2]
+	blx		r1							// r0: event
+	cmp		r0, #ESCAPE_NUM_EVENTS
+	bhs		escape_step_exit				// No event
+	mov		r1, #ESCAPE_NUM_EVENTS
+	mla		r6, r5, r1, r0
+	ldr		r1, =escape_fsm_next
+	ldrb	r5, [r1, r6]
+	cmp		r5, #ESCAPE_NO_TRANSITION
+	beq		escape_step_exit				// Event ignored in this state
+	strb	r5, [r4]					// Change state
+	ldr		r1, =escape_fsm_action
+	ldrb	r1, [r1, r6]
+	ldr		r2, =escape_fsm_actions
+	ldr		r1, [r2, r1, lsl #2]
+	blx		r1							// Transition action
+	ldr		r1, =escape_fsm_enter
+	ldr		r1, [r1, r5, lsl #2]
+	blx		r1							// Enter the next state
+escape_step_exit:
+	ldrb	r0, [r4]
+	pop		{r4, r5, r6, pc}
+
+/** escape_reset
+ *
+ *    Set the initial state (the enter routine is not called)
+ *
+ **/
+	.global escape_reset
+	.type	escape_reset, %function
+escape_reset:
+	ldr		r1, =escape_state
+	mov		r0, #ESCAPE_ST_IDLE
+	strb	r0, [r1]
+	bx		lr
+
+/** Trigger for escape
+ *
+ *    Runs escape_step, the behavior is triggered in the active states
+ *
+ **/
+	BEHAVIOR_TRIGGER escape
+	push	{r4, lr}
+	bl		escape_step
+	ldr		r1, =escape_fsm_active
+	ldrb	r0, [r1, r0]
+	pop		{r4, pc}
+
+	BEHAVIOR_PROLOGUE escape
+	bl		escape_run
+	BEHAVIOR_EPILOGUE escape
+
+	.ltorg
+#endif
@@ -0,0 +1,145 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file  corobench.c
+ *  \brief  Coroutine switch cost benchmark.
+ *
+ *  Compares the cost of one coroutine round trip (resume and yield) for:
+ *     empty      a call to an empty routine (baseline)
+ *     label      the label-resume coroutines (CORO_CALL / CORO_YIELD in arm-coroutine.h)
+ *     stackful   the stackful coroutines (scoro_resume / SCORO_YIELD in stackcoro.h)
+ *     stackful-c the stackful coroutines with the coroutine routine written in C
+ *
+ *  Each test is run several times and the fastest run is reported, to filter out preemption.
+ *  The stack high-water mark of the stackful coroutines is reported as well.
+ *
+ *  Usage: corobench [-n iterations] [-r runs]
+ *
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#include "ev3dev-arm-ctypes.h"
+#include "stackcoro.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+
+#define DEFAULT_ITERATIONS	200000
+#define DEFAULT_RUNS		5
+#define BENCH_STACK			SCORO_MIN_STACK
+
+/* corobench.S */
+extern U32 label_counter;
+void label_bench(U32 iterations);
+void stackful_counter(void *counter);
+void stackful_bench(SCORO *co, U32 iterations);
+void empty_bench(U32 iterations);
+
+static SCORO *bench_co;
+static U32 iterations = DEFAULT_ITERATIONS;
+
+static void stackful_c_counter(void *arg)
+{
+	U32 *counter = (U32 *) arg;
+
+	for (;;) {
+		(*counter)++;
+		scoro_yield();
+	}
+}
+
+static void run_empty(void) { empty_bench(iterations); }
+static void run_label(void) { label_bench(iterations); }
+static void run_stackful(void) { stackful_bench(bench_co, iterations); }
+
+static unsigned long long now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Fastest run, in ns per iteration (x100 for two decimal places) */
+static U32 measure(void (*run)(void), U32 runs)
+{
+	unsigned long long start, elapsed, best = ~0ULL;
+	U32 i;
+
+	run();											// Warm up the caches and fault in the stacks
+	for (i = 0; i < runs; i++) {
+		start = now_ns();
+		run();
+		elapsed = now_ns() - start;
+		if (elapsed < best)
+			best = elapsed;
+	}
+	return (U32) ((best * 100) / iterations);
+}
+
+static void report(const char *name, U32 ns100, U32 base100)
+{
+	U32 net = (ns100 > base100) ? ns100 - base100 : 0;
+
+	printf("corobench: %-10s %6lu.%02lu ns/round trip  (%lu.%02lu ns over call)\n",
+		   name, ns100 / 100, ns100 % 100, net / 100, net % 100);
+}
+
+int main(int argc, char *argv[])
+{
+	U32 runs = DEFAULT_RUNS;
+	U32 empty, label, stackful, stackful_c;
+	U32 counter = 0, c_counter = 0;
+	SCORO *co, *c_co;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "n:r:")) != -1) {
+		switch (opt) {
+		case 'n': iterations = strtoul(optarg, NULL, 0); break;
+		case 'r': runs = strtoul(optarg, NULL, 0); break;
+		default:
+			fprintf(stderr, "usage: %s [-n iterations] [-r runs]\n", argv[0]);
+			return 1;
+		}
+	}
+	if ((iterations == 0) || (runs == 0))
+		return 1;
+
+	co = scoro_create(stackful_counter, &counter, BENCH_STACK);
+	c_co = scoro_create(stackful_c_counter, &c_counter, BENCH_STACK);
+	if (!co || !c_co) {
+		fprintf(stderr, "corobench: cannot allocate coroutine stacks\n");
+		return 1;
+	}
+
+	empty = measure(run_empty, runs);
+	label = measure(run_label, runs);
+	bench_co = co;
+	stackful = measure(run_stackful, runs);
+	bench_co = c_co;
+	stackful_c = measure(run_stackful, runs);
+
+	// measure() runs each test runs + 1 times
+	if ((label_counter != counter) || (counter != c_counter) || (counter != iterations * (runs + 1))) {
+		fprintf(stderr, "corobench: counter mismatch (label %lu, stackful %lu, stackful-c %lu)\n",
+				label_counter, counter, c_counter);
+		return 1;
+	}
+
+	printf("corobench: %lu iterations, best of %lu runs\n", iterations, runs);
+	report("empty", empty, empty);
+	report("label", label, empty);
+	report("stackful", stackful, empty);
+	report("stackful-c", stackful_c, empty);
+	printf("corobench: stackful stack used %lu of %lu bytes (asm), %lu of %lu bytes (C)\n",
+		   scoro_stack_used(co), co->stack_size, scoro_stack_used(c_co), c_co->stack_size);
+
+	scoro_destroy(co);
+	scoro_destroy(c_co);
+	return 0;
+}
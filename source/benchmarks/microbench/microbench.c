@@ -0,0 +1,304 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file  microbench.c
+ *  \brief  Microbenchmarks for the coroutine and BBR runtime primitives.
+ *
+ *  Each benchmark runs its primitive a fixed number of times per repetition. After the warmup
+ *  repetitions, the time per operation of each repetition is recorded, and the median and the
+ *  interquartile range (IQR) are reported, so that outliers caused by preemption do not skew the results.
+ *
+ *  Instructions per operation are counted using the hardware instruction counter (perf_event_open)
+ *  where the kernel provides one. The EV3 (ARM926EJ-S) has none; under qemu-arm, scripts/microbench.py
+ *  derives them with the qemu instruction counting plugin instead (see its --insn-plugin option).
+ *
+ *  The results are written to stdout as CSV (one line per benchmark) and as a table to stderr.
+ *  Output of the prog_display_* routines is discarded while they are measured.
+ *
+ *  Usage: microbench [-n scale] [-r repetitions] [-w warmup] [-b benchmark] [-l]
+ *     -n  iteration count multiplier (percent, default 100)
+ *     -b  only run the named benchmark
+ *     -l  list the benchmarks and their iteration counts
+ *
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#include "ev3dev-arm-ctypes.h"
+#include "numfmt.h"
+#include "scaffolding.h"
+#include "systick.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#define DEFAULT_REPETITIONS	21
+#define DEFAULT_WARMUP		3
+#define MAX_REPETITIONS		101
+#define NUM_READINGS		5					// NUM_COLOR_READINGS in seeker
+
+/* microbench-kernels.S */
+void bench_call_overhead(U32 iterations);
+void bench_coro_roundtrip(U32 iterations);
+void bench_semaphore(U32 iterations);
+void bench_behavior_active(U32 iterations);
+void bench_behavior_idle(U32 iterations);
+void bench_behavior_suppressed(U32 iterations);
+void min_max_u32(U32 *readings, U32 count, U32 *min, U32 *max);
+
+typedef struct {
+	const char *name;
+	void (*run)(U32 iterations);
+	U32 iterations;								// Per repetition, before scaling
+	bool discard_output;						// Redirect stdout to /dev/null while running
+} BENCHMARK;
+
+static U32 readings[NUM_READINGS] = { 412, 37, 655, 230, 38 };
+static U32 reading_min, reading_max;
+static volatile U32 sink;
+static char fmt_buf[NFMT_BUF_SIZE];
+
+/* C wrappers for the routines called once per operation */
+
+static void bench_min_max(U32 n)
+{
+	while (n--)
+		min_max_u32(readings, NUM_READINGS, &reading_min, &reading_max);
+}
+
+static void bench_tick_systick(U32 n)
+{
+	while (n--)
+		sink = tick_systick();
+}
+
+static void bench_display_string(U32 n) { while (n--) prog_display_string("bench"); }
+static void bench_display_integer(U32 n) { while (n--) prog_display_integer(-12345); }
+static void bench_display_integer_aligned(U32 n) { while (n--) prog_display_integer_aligned(-12345, 8); }
+static void bench_display_signed_int(U32 n) { while (n--) prog_display_signed_int(-12345); }
+static void bench_display_signed_int_aligned(U32 n) { while (n--) prog_display_signed_int_aligned(-12345, 8); }
+static void bench_display_unsigned_int(U32 n) { while (n--) prog_display_unsigned_int(12345); }
+static void bench_display_unsigned_int_aligned(U32 n) { while (n--) prog_display_unsigned_int_aligned(12345, 8); }
+static void bench_display_bin8(U32 n) { while (n--) prog_display_bin8(0xA5); }
+static void bench_display_hex8(U32 n) { while (n--) prog_display_hex8(0xA5); }
+static void bench_display_hex32(U32 n) { while (n--) prog_display_hex32(0xDEADBEEF); }
+
+/* Integer formatting only (no output): stdio engine versus numfmt */
+static void bench_fmt_printf_dec(U32 n) { while (n--) sink = snprintf(fmt_buf, sizeof(fmt_buf), "%*ld", 8, (S32) -12345); }
+static void bench_fmt_nfmt_dec(U32 n) { while (n--) sink = nfmt_dec(fmt_buf, (U32) -12345, 8, NFMT_SIGNED); }
+static void bench_fmt_nfmt_udec(U32 n) { while (n--) sink = nfmt_udec(fmt_buf, 4000000000UL); }
+static void bench_fmt_nfmt_udec_ref(U32 n) { while (n--) sink = nfmt_udec_ref(fmt_buf, 4000000000UL); }
+static void bench_fmt_printf_hex32(U32 n) { while (n--) sink = snprintf(fmt_buf, sizeof(fmt_buf), "0x%08lX", 0xDEADBEEFUL); }
+static void bench_fmt_nfmt_hex32(U32 n) { while (n--) sink = nfmt_hex(fmt_buf, 0xDEADBEEF, 8, NFMT_PREFIX); }
+
+static const BENCHMARK benchmarks[] = {
+	{ "call_overhead",				bench_call_overhead,				200000,	FALSE },
+	{ "coro_roundtrip",				bench_coro_roundtrip,				200000,	FALSE },
+	{ "semaphore_acq_rel",			bench_semaphore,					100000,	FALSE },
+	{ "behavior_active",			bench_behavior_active,				100000,	FALSE },
+	{ "behavior_idle",				bench_behavior_idle,				100000,	FALSE },
+	{ "behavior_suppressed",		bench_behavior_suppressed,			200000,	FALSE },
+	{ "min_max_u32",				bench_min_max,						100000,	FALSE },
+	{ "tick_systick",				bench_tick_systick,					20000,	FALSE },
+	{ "display_string",				bench_display_string,				2000,	TRUE },
+	{ "display_integer",			bench_display_integer,				2000,	TRUE },
+	{ "display_integer_aligned",	bench_display_integer_aligned,		2000,	TRUE },
+	{ "display_signed_int",			bench_display_signed_int,			2000,	TRUE },
+	{ "display_signed_int_aligned",	bench_display_signed_int_aligned,	2000,	TRUE },
+	{ "display_unsigned_int",		bench_display_unsigned_int,			2000,	TRUE },
+	{ "display_unsigned_int_aligned", bench_display_unsigned_int_aligned, 2000, TRUE },
+	{ "display_bin8",				bench_display_bin8,					2000,	TRUE },
+	{ "display_hex8",				bench_display_hex8,					2000,	TRUE },
+	{ "display_hex32",				bench_display_hex32,				2000,	TRUE },
+	{ "fmt_printf_dec",				bench_fmt_printf_dec,				20000,	FALSE },
+	{ "fmt_nfmt_dec",				bench_fmt_nfmt_dec,					20000,	FALSE },
+	{ "fmt_nfmt_udec",				bench_fmt_nfmt_udec,				20000,	FALSE },
+	{ "fmt_nfmt_udec_ref",			bench_fmt_nfmt_udec_ref,			20000,	FALSE },
+	{ "fmt_printf_hex32",			bench_fmt_printf_hex32,				20000,	FALSE },
+	{ "fmt_nfmt_hex32",				bench_fmt_nfmt_hex32,				20000,	FALSE },
+};
+
+#define NUM_BENCHMARKS	(sizeof(benchmarks) / sizeof(benchmarks[0]))
+
+static int compare_u32(const void *a, const void *b)
+{
+	U32 x = *(const U32 *) a;
+	U32 y = *(const U32 *) b;
+	return (x > y) - (x < y);
+}
+
+static unsigned long long now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Hardware instruction counter for this thread, or -1 if not available */
+static int open_insn_counter(void)
+{
+	struct perf_event_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.size = sizeof(attr);
+	attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	return (int) syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static unsigned long long read_insn_counter(int fd)
+{
+	unsigned long long count = 0;
+
+	if (read(fd, &count, sizeof(count)) != sizeof(count))
+		count = 0;
+	return count;
+}
+
+/* Print a value in hundredths as a decimal number */
+static void print_fixed(FILE *f, U32 value100)
+{
+	fprintf(f, "%lu.%02lu", value100 / 100, value100 % 100);
+}
+
+static void run_benchmark(const BENCHMARK *b, U32 scale, U32 reps, U32 warmup, int insn_fd)
+{
+	U32 ns100[MAX_REPETITIONS];				// ns/op x 100
+	U32 iterations = (b->iterations * scale) / 100;
+	U32 i, median, q1, q3;
+	unsigned long long start, count, insn = 0;
+	int saved_stdout = -1, devnull;
+
+	if (iterations == 0)
+		iterations = 1;
+	if (b->discard_output) {
+		fflush(stdout);
+		devnull = open("/dev/null", O_WRONLY);
+		if (devnull >= 0) {
+			saved_stdout = dup(STDOUT_FILENO);
+			dup2(devnull, STDOUT_FILENO);
+			close(devnull);
+		}
+	}
+
+	for (i = 0; i < warmup; i++)
+		b->run(iterations);
+	for (i = 0; i < reps; i++) {
+		if (insn_fd >= 0) {
+			ioctl(insn_fd, PERF_EVENT_IOC_RESET, 0);
+			ioctl(insn_fd, PERF_EVENT_IOC_ENABLE, 0);
+		}
+		start = now_ns();
+		b->run(iterations);
+		ns100[i] = (U32) (((now_ns() - start) * 100) / iterations);
+		if (insn_fd >= 0) {
+			ioctl(insn_fd, PERF_EVENT_IOC_DISABLE, 0);
+			count = read_insn_counter(insn_fd);
+			if ((i == 0) || (count < insn))
+				insn = count;					// Least disturbed repetition
+		}
+	}
+
+	if (saved_stdout >= 0) {
+		fflush(stdout);
+		dup2(saved_stdout, STDOUT_FILENO);
+		close(saved_stdout);
+	}
+
+	qsort(ns100, reps, sizeof(U32), compare_u32);
+	median = ns100[reps / 2];
+	q1 = ns100[(reps - 1) / 4];
+	q3 = ns100[(3 * (reps - 1)) / 4];
+
+	// CSV: benchmark,iterations,repetitions,ns_median,ns_q1,ns_q3,ns_iqr,insn_per_op
+	printf("%s,%lu,%lu,", b->name, iterations, reps);
+	print_fixed(stdout, median);
+	putchar(',');
+	print_fixed(stdout, q1);
+	putchar(',');
+	print_fixed(stdout, q3);
+	putchar(',');
+	print_fixed(stdout, q3 - q1);
+	putchar(',');
+	if (insn_fd >= 0)
+		print_fixed(stdout, (U32) ((insn * 100) / iterations));
+	else
+		fputs("NA", stdout);
+	putchar('\n');
+	fflush(stdout);
+
+	fprintf(stderr, "microbench: %-30s ", b->name);
+	print_fixed(stderr, median);
+	fputs(" ns/op  iqr ", stderr);
+	print_fixed(stderr, q3 - q1);
+	if (insn_fd >= 0) {
+		fputs("  insn/op ", stderr);
+		print_fixed(stderr, (U32) ((insn * 100) / iterations));
+	}
+	fputc('\n', stderr);
+}
+
+int main(int argc, char *argv[])
+{
+	U32 scale = 100, reps = DEFAULT_REPETITIONS, warmup = DEFAULT_WARMUP;
+	const char *only = NULL;
+	bool list = FALSE;
+	U32 i, found = 0;
+	int insn_fd, opt;
+
+	while ((opt = getopt(argc, argv, "n:r:w:b:l")) != -1) {
+		switch (opt) {
+		case 'n': scale = strtoul(optarg, NULL, 0); break;
+		case 'r': reps = strtoul(optarg, NULL, 0); break;
+		case 'w': warmup = strtoul(optarg, NULL, 0); break;
+		case 'b': only = optarg; break;
+		case 'l': list = TRUE; break;
+		default:
+			fprintf(stderr, "usage: %s [-n scale] [-r repetitions] [-w warmup] [-b benchmark] [-l]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (list) {
+		for (i = 0; i < NUM_BENCHMARKS; i++)
+			printf("%s %lu\n", benchmarks[i].name, (benchmarks[i].iterations * scale) / 100);
+		return 0;
+	}
+	if ((reps == 0) || (reps > MAX_REPETITIONS) || (scale == 0)) {
+		fprintf(stderr, "microbench: repetitions must be 1..%d, scale > 0\n", MAX_REPETITIONS);
+		return 1;
+	}
+
+	tick_init();
+	insn_fd = open_insn_counter();
+	fprintf(stderr, "microbench: %lu repetitions, %lu warmup, scale %lu%%, instruction counter %s\n",
+			reps, warmup, scale, (insn_fd >= 0) ? "available" : "not available");
+
+	printf("benchmark,iterations,repetitions,ns_median,ns_q1,ns_q3,ns_iqr,insn_per_op\n");
+	for (i = 0; i < NUM_BENCHMARKS; i++) {
+		if (only && strcmp(only, benchmarks[i].name))
+			continue;
+		run_benchmark(&benchmarks[i], scale, reps, warmup, insn_fd);
+		found++;
+	}
+
+	if (insn_fd >= 0)
+		close(insn_fd);
+	if (found == 0) {
+		fprintf(stderr, "microbench: unknown benchmark %s\n", only);
+		return 1;
+	}
+	return 0;
+}
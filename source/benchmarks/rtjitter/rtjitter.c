@@ -0,0 +1,158 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file  rtjitter.c
+ *  \brief  Event loop period jitter benchmark.
+ *
+ *  Runs an event loop with the same usleep-based pacing as the b33 robots
+ *  (see update_systick_and_sleep) while background processes generate CPU and page fault load,
+ *  then reports the distribution of the measured loop periods.
+ *
+ *  Usage: rtjitter [-r] [-p priority] [-l num_load_procs] [-t period_us] [-n iterations]
+ *     -r  enable real-time mode using prog_init_rt()
+ *
+ *  Run it with and without -r to compare.
+ *
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#include "ev3dev-arm-ctypes.h"
+#include "scaffolding.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#define DEFAULT_PERIOD_US	10000
+#define DEFAULT_ITERATIONS	1000
+#define DEFAULT_LOAD_PROCS	2
+#define MAX_LOAD_PROCS		8
+#define LOAD_CHUNK_SIZE		(512 * 1024)
+#define WORK_ITERATIONS		2000				// Simulated per-tick work
+
+static int compare_u32(const void *a, const void *b)
+{
+	U32 x = *(const U32 *) a;
+	U32 y = *(const U32 *) b;
+	return (x > y) - (x < y);
+}
+
+/* Background load: spin on the CPU while repeatedly faulting in fresh pages */
+static void load_process(void)
+{
+	volatile U8 *chunk;
+	U32 i;
+
+	for (;;) {
+		chunk = malloc(LOAD_CHUNK_SIZE);
+		if (chunk) {
+			for (i = 0; i < LOAD_CHUNK_SIZE; i += 4096)
+				chunk[i] = (U8) i;
+			free((void *) chunk);
+		}
+	}
+}
+
+/* Monotonic time in microseconds (64-bit, never wraps during a run) */
+static unsigned long long now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long) ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static U32 percentile(const U32 *sorted, U32 count, U32 pct)
+{
+	return sorted[((count - 1) * pct) / 100];
+}
+
+int main(int argc, char *argv[])
+{
+	U32 period = DEFAULT_PERIOD_US;
+	U32 iterations = DEFAULT_ITERATIONS;
+	U32 num_load = DEFAULT_LOAD_PROCS;
+	U32 priority = 0;
+	bool use_rt = FALSE;
+	pid_t load_pids[MAX_LOAD_PROCS];
+	U32 *periods;
+	U32 i, caps = 0, exceeded = 0;
+	unsigned long long loop_start, now, next;
+	volatile U32 work = 0;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "rp:l:t:n:")) != -1) {
+		switch (opt) {
+		case 'r': use_rt = TRUE; break;
+		case 'p': priority = strtoul(optarg, NULL, 0); break;
+		case 'l': num_load = strtoul(optarg, NULL, 0); break;
+		case 't': period = strtoul(optarg, NULL, 0); break;
+		case 'n': iterations = strtoul(optarg, NULL, 0); break;
+		default:
+			fprintf(stderr, "usage: %s [-r] [-p priority] [-l num_load_procs] [-t period_us] [-n iterations]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (num_load > MAX_LOAD_PROCS)
+		num_load = MAX_LOAD_PROCS;
+	if ((iterations == 0) || (period == 0) || !(periods = malloc(iterations * sizeof(U32))))
+		return 1;
+
+	// Start load before real-time mode so that the load processes remain SCHED_OTHER
+	for (i = 0; i < num_load; i++) {
+		load_pids[i] = fork();
+		if (load_pids[i] == 0)
+			load_process();
+	}
+
+	if (use_rt)
+		caps = prog_init_rt(priority);
+
+	loop_start = now_us();
+	for (i = 0; i < iterations; i++) {
+		U32 w;
+
+		for (w = 0; w < WORK_ITERATIONS; w++)
+			work += w;
+
+		// Same pacing as update_systick_and_sleep
+		next = loop_start + period;
+		now = now_us();
+		if (now < next) {
+			usleep((useconds_t) (next - now));
+			now = now_us();
+		} else {
+			exceeded++;
+			next = now;
+		}
+		periods[i] = (U32) (now - loop_start);
+		loop_start = next;
+	}
+
+	for (i = 0; i < num_load; i++) {
+		if (load_pids[i] > 0) {
+			kill(load_pids[i], SIGKILL);
+			waitpid(load_pids[i], NULL, 0);
+		}
+	}
+	if (use_rt)
+		prog_exit_rt();
+
+	qsort(periods, iterations, sizeof(U32), compare_u32);
+	printf("rtjitter: period %lu us, %lu iterations, %lu load procs, rt caps 0x%02lX\n",
+		   period, iterations, num_load, caps);
+	printf("rtjitter: min %lu p50 %lu p90 %lu p99 %lu p99.9 %lu max %lu us\n",
+		   periods[0], percentile(periods, iterations, 50), percentile(periods, iterations, 90),
+		   percentile(periods, iterations, 99), periods[((iterations - 1) * 999) / 1000],
+		   periods[iterations - 1]);
+	printf("rtjitter: exceeded %lu\n", exceeded);
+	free(periods);
+	return 0;
+}
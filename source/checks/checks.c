@@ -0,0 +1,188 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   checks.c
+ *  \brief  ARM-BBR host check harness (simulated clock and mocked fast attributes)
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+#include "ev3dev-arm-ctypes.h"
+#include <stdbool.h>
+#include "fastattr.h"
+#include "systick.h"
+#include "checks.h"
+
+#define MOCK_FD_BASE 100						// Mock attribute ID + MOCK_FD_BASE
+
+typedef struct {
+	char name[MOCK_NAME_SIZE];					// <path_prefix><sn>/<attr>
+	S32 value;
+	char str[MOCK_STR_SIZE];
+	U32 writes;
+} MOCK_ATTR;
+
+static MOCK_ATTR attrs[MOCK_MAX_ATTRS];
+static U32 num_attrs;
+static U32 sim_ticks = CHECK_TICK_START;
+static U32 sim_start = CHECK_TICK_START;
+static U32 num_passed;
+static U32 num_failed;
+
+/* Internal Routines */
+
+static MOCK_ATTR *_attr(S32 fd) {
+	S32 id = fd - MOCK_FD_BASE;
+
+	return ((id >= 0) && ((U32) id < num_attrs)) ? &attrs[id] : NULL;
+}
+
+/* Public Routines */
+
+void check_result(bool ok, const char *file, int line, const char *fmt, ...) {
+	va_list ap;
+
+	if (ok) {
+		num_passed++;
+		return;
+	}
+	num_failed++;
+	fprintf(stderr, "%s:%d: check failed at %lu us: ", file, line, sim_elapsed());
+	va_start(ap, fmt);
+	vfprintf(stderr, fmt, ap);
+	va_end(ap);
+	fputc('\n', stderr);
+}
+
+int check_summary(const char *name) {
+	printf("%s: %lu passed, %lu failed\n", name, num_passed, num_failed);
+	return num_failed ? 1 : 0;
+}
+
+void sim_advance(U32 us) {
+	sim_ticks += us;
+}
+
+U32 sim_elapsed(void) {
+	return sim_ticks - sim_start;
+}
+
+S32 mock_attr(const char *path_prefix, U8 sn, const char *attr) {
+	char name[MOCK_NAME_SIZE];
+	U32 i;
+
+	snprintf(name, sizeof(name), "%s%u/%s", path_prefix, sn, attr);
+	for (i = 0; i < num_attrs; i++) {
+		if (strcmp(attrs[i].name, name) == 0)
+			return (S32) i;
+	}
+	if (num_attrs >= MOCK_MAX_ATTRS)
+		return -1;
+	strcpy(attrs[num_attrs].name, name);
+	return (S32) num_attrs++;
+}
+
+S32 mock_get_int(S32 id) {
+	return attrs[id].value;
+}
+
+void mock_set_int(S32 id, S32 value) {
+	attrs[id].value = value;
+}
+
+const char *mock_get_str(S32 id) {
+	return attrs[id].str;
+}
+
+void mock_set_str(S32 id, const char *str) {
+	snprintf(attrs[id].str, sizeof(attrs[id].str), "%s", str);
+}
+
+U32 mock_writes(S32 id) {
+	return attrs[id].writes;
+}
+
+/* Simulated systick.h */
+
+void tick_init(void) {
+	sim_start = sim_ticks;
+}
+
+U32 tick_systick(void) {
+	return sim_ticks;
+}
+
+int usleep(useconds_t usec) {
+	sim_advance(usec);
+	return 0;
+}
+
+/* Mocked fastattr.h */
+
+S32 fattr_open(const char *path_prefix, U8 sn, const char *attr, bool writable) {
+	S32 id = mock_attr(path_prefix, sn, attr);
+
+	(void) writable;
+	return (id < 0) ? -1 : id + MOCK_FD_BASE;
+}
+
+S32 fattr_open_tacho(U8 sn, const char *attr, bool writable) {
+	return fattr_open(FATTR_TACHO_PATH, sn, attr, writable);
+}
+
+S32 fattr_open_sensor_value(U8 sn, U8 inx) {
+	char attr[12];
+
+	snprintf(attr, sizeof(attr), "value%u", inx);
+	return fattr_open(FATTR_SENSOR_PATH, sn, attr, false);
+}
+
+bool fattr_read_int(S32 fd, S32 *value) {
+	MOCK_ATTR *a = _attr(fd);
+
+	if (!a)
+		return false;
+	*value = a->value;
+	return true;
+}
+
+bool fattr_write_int(S32 fd, S32 value) {
+	MOCK_ATTR *a = _attr(fd);
+
+	if (!a)
+		return false;
+	a->value = value;
+	a->writes++;
+	return true;
+}
+
+bool fattr_read_str(S32 fd, char *buf, U32 size) {
+	MOCK_ATTR *a = _attr(fd);
+
+	if (!a || (size == 0))
+		return false;
+	snprintf(buf, size, "%s", a->str);
+	return true;
+}
+
+bool fattr_write_str(S32 fd, const char *str) {
+	MOCK_ATTR *a = _attr(fd);
+
+	if (!a)
+		return false;
+	snprintf(a->str, sizeof(a->str), "%s", str);
+	a->writes++;
+	return true;
+}
+
+void fattr_close(S32 fd) {
+	(void) fd;
+}
@@ -0,0 +1,141 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file   checks.h
+ *  \brief  ARM-BBR host check harness (simulated clock and mocked fast attributes)
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#pragma once
+
+#include "ev3dev-arm-ctypes.h"
+#include <stdbool.h>
+#include "systick.h"
+
+/** @defgroup checks Host Checks
+ *
+ * The host checks run common library modules on a PC against a simulated clock and mocked fast attributes,
+ * so that their timing and control logic can be verified without an EV3.
+ *
+ * - tick_systick() returns the simulated clock, which only moves when sim_advance() (or usleep()) is called.
+ *   It starts at CHECK_TICK_START, shortly before the 32-bit tick count wraps, so that the scheduling is checked
+ *   across the wrap on 32-bit builds (e.g., built with the ARM cross compiler and run using qemu-arm).
+ * - The fattr_xxx() routines (fastattr.h) read and write mock attributes, identified by their path prefix,
+ *   sequence number and attribute name. The check program plays the role of the device by reading
+ *   the attributes written by the module, and setting the attributes read by the module.
+ *
+ * Only the polled mode of the modules is checked: the background threads share the mock attributes.
+ *
+ *     e.g.: duty = mock_attr(FATTR_DC_PATH, 1, "duty_cycle_sp");
+ *           ...
+ *           CHECK(mock_get_int(duty) == 80, "duty %ld", mock_get_int(duty));
+ *           return check_summary("dcmcheck");
+ */
+/*@{*/
+
+#define CHECK_TICK_START    (0xFFFFFFFFUL - 2 * TICKS_PER_SECOND + 1)	///< Simulated clock start (2 s before the wrap)
+#define MOCK_MAX_ATTRS      32				///< Maximum number of mock attributes
+#define MOCK_NAME_SIZE      64				///< Mock attribute name buffer size
+#define MOCK_STR_SIZE       32				///< Mock attribute string value buffer size
+
+/** Check a condition, and report it if it fails
+ *
+ * @param cond Condition.
+ * @param ... printf() format and arguments describing the failure.
+ *
+ */
+#define CHECK(cond, ...) check_result((cond), __FILE__, __LINE__, __VA_ARGS__)
+
+/** Record the result of a check (use CHECK())
+ *
+ * @param ok Flag - the check passed.
+ * @param file Source file.
+ * @param line Source line.
+ * @param fmt printf() format for the failure message, followed by its arguments.
+ * @return None
+ *
+ */
+void check_result(bool ok, const char *file, int line, const char *fmt, ...)
+	__attribute__((format(printf, 4, 5)));
+
+/** Report the number of passed and failed checks
+ *
+ * @param name Check program name.
+ * @return Exit status (0 if all the checks passed).
+ *
+ */
+int check_summary(const char *name);
+
+/** Advance the simulated clock
+ *
+ * @param us Microseconds.
+ * @return None
+ *
+ */
+void sim_advance(U32 us);
+
+/** Get the simulated time since the start of the check
+ *
+ * @param None
+ * @return Elapsed time (us).
+ *
+ */
+U32 sim_elapsed(void);
+
+/** Find or create a mock attribute
+ *
+ * @param path_prefix Attribute path prefix (FATTR_XXX_PATH).
+ * @param sn Device sequence number.
+ * @param attr Attribute name (e.g., "command").
+ * @return Mock attribute ID, or -1 if there are too many attributes.
+ *
+ */
+S32 mock_attr(const char *path_prefix, U8 sn, const char *attr);
+
+/** Get the last integer value of a mock attribute
+ *
+ * @param id Mock attribute ID.
+ * @return Value.
+ *
+ */
+S32 mock_get_int(S32 id);
+
+/** Set the integer value of a mock attribute (read by the module)
+ *
+ * @param id Mock attribute ID.
+ * @param value Value.
+ * @return None
+ *
+ */
+void mock_set_int(S32 id, S32 value);
+
+/** Get the last string value of a mock attribute
+ *
+ * @param id Mock attribute ID.
+ * @return String ("" if never written).
+ *
+ */
+const char *mock_get_str(S32 id);
+
+/** Set the string value of a mock attribute (read by the module)
+ *
+ * @param id Mock attribute ID.
+ * @param str String.
+ * @return None
+ *
+ */
+void mock_set_str(S32 id, const char *str);
+
+/** Get the number of writes to a mock attribute by the module
+ *
+ * @param id Mock attribute ID.
+ * @return Number of writes.
+ *
+ */
+U32 mock_writes(S32 id);
+
+/*@}*/
@@ -0,0 +1,146 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file  dcmcheck.c
+ *  \brief  DC Motor Driver host check.
+ *
+ *  Drives a simulated DC motor (speed proportional to the duty cycle, 50 ms time constant) with the DC Motor Driver
+ *  in polled mode, and checks the open-loop ramps, the output write suppression, dcm_halt(), and the closed-loop
+ *  speed regulation from a simulated rotation sensor as the motor gain (battery and load) changes.
+ *
+ *  Usage: dcmcheck (exits with 1 if a check fails)
+ *
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#include "ev3dev-arm-ctypes.h"
+#include <stdbool.h>
+#include <string.h>
+#include "dcmotor.h"
+#include "fastattr.h"
+#include "checks.h"
+
+#define MOTOR_SN        1
+#define SENSOR_SN       2
+#define MAX_SPEED       900					// Counts/s at full output
+#define GAIN_NOMINAL    9.0					// Simulated counts/s per duty %
+#define TIME_CONSTANT   0.05				// Simulated motor time constant (s)
+
+static S32 duty_attr, command_attr, position_attr;
+static double gain = GAIN_NOMINAL;
+static double velocity, position;
+
+static bool motor_running(void) {
+	return strcmp(mock_get_str(command_attr), "run-direct") == 0;
+}
+
+/* Run the simulated motor and the driver for a number of milliseconds */
+static void simulate(U32 ms) {
+	double drive;
+
+	while (ms--) {
+		drive = motor_running() ? mock_get_int(duty_attr) * gain : 0.0;
+		velocity += (drive - velocity) * (0.001 / TIME_CONSTANT);
+		position += velocity * 0.001;
+		mock_set_int(position_attr, (S32) position);
+		sim_advance(1000);
+		dcm_poll();
+	}
+}
+
+static S32 measured_speed(S32 id) {
+	S32 speed = 0;
+
+	dcm_get_speed(id, &speed, NULL);
+	return speed;
+}
+
+static bool within(S32 value, S32 expected, S32 tolerance) {
+	return (value >= expected - tolerance) && (value <= expected + tolerance);
+}
+
+static void check_open_loop(S32 id) {
+	U32 writes;
+
+	dcm_set_ramp(id, 500, 200);						// 0 to 100% in 500 ms, 100% to 0 in 200 ms
+	dcm_set_duty(id, 80);
+	simulate(100);
+	CHECK(within(dcm_get_duty(id), 20, 2), "ramp up: duty %ld after 100 ms", dcm_get_duty(id));
+	CHECK(motor_running(), "ramp up: command '%s'", mock_get_str(command_attr));
+	simulate(400);
+	CHECK(dcm_get_duty(id) == 80, "ramp up: duty %ld after 500 ms", dcm_get_duty(id));
+	CHECK(mock_get_int(duty_attr) == 80, "ramp up: duty_cycle_sp %ld", mock_get_int(duty_attr));
+
+	writes = mock_writes(duty_attr);
+	simulate(200);
+	CHECK(mock_writes(duty_attr) == writes, "steady output rewritten %lu times", mock_writes(duty_attr) - writes);
+
+	dcm_set_duty(id, -50);							// 160 ms down to 0, then 250 ms up to -50
+	simulate(100);
+	CHECK(within(dcm_get_duty(id), 30, 2), "ramp down: duty %ld after 100 ms", dcm_get_duty(id));
+	simulate(400);
+	CHECK(dcm_get_duty(id) == -50, "reverse: duty %ld after 500 ms", dcm_get_duty(id));
+
+	dcm_halt(id);									// No poll: the motor stops immediately
+	CHECK(dcm_get_duty(id) == 0, "halt: duty %ld", dcm_get_duty(id));
+	CHECK(strcmp(mock_get_str(command_attr), "stop") == 0, "halt: command '%s'", mock_get_str(command_attr));
+	simulate(300);
+}
+
+static void check_closed_loop(S32 id) {
+	S32 duty, start, end;
+
+	CHECK(!dcm_set_speed(id, 450), "speed target accepted without feedback");
+	CHECK(dcm_set_feedback(id, SENSOR_SN, 0, MAX_SPEED, DCM_FB_SENSOR), "dcm_set_feedback() failed");
+	CHECK(dcm_set_speed(id, 450), "dcm_set_speed() failed");
+
+	simulate(1500);
+	duty = dcm_get_duty(id);
+	CHECK(within(measured_speed(id), 450, 20), "nominal gain: speed %ld", measured_speed(id));
+
+	gain = GAIN_NOMINAL * 2 / 3;					// Low battery or higher load
+	simulate(1500);
+	CHECK(within(measured_speed(id), 450, 20), "low gain: speed %ld", measured_speed(id));
+	CHECK(dcm_get_duty(id) > duty, "low gain: duty %ld not above %ld", dcm_get_duty(id), duty);
+	dcm_get_speed(id, NULL, &start);
+	simulate(1000);
+	dcm_get_speed(id, NULL, &end);
+	CHECK(within(end - start, 450, 25), "low gain: %ld counts in 1 s", end - start);
+
+	gain = GAIN_NOMINAL / 3;						// Cannot reach the target
+	simulate(2000);
+	CHECK(dcm_get_duty(id) == DCM_DUTY_MAX, "saturated: duty %ld", dcm_get_duty(id));
+
+	gain = GAIN_NOMINAL;							// The integral must not have wound up
+	simulate(1000);
+	CHECK(within(measured_speed(id), 450, 20), "recovered: speed %ld", measured_speed(id));
+
+	dcm_set_speed(id, -300);
+	simulate(1500);
+	CHECK(within(measured_speed(id), -300, 20), "reverse: speed %ld", measured_speed(id));
+}
+
+int main(void) {
+	S32 id;
+
+	tick_init();
+	duty_attr = mock_attr(FATTR_DC_PATH, MOTOR_SN, "duty_cycle_sp");
+	command_attr = mock_attr(FATTR_DC_PATH, MOTOR_SN, "command");
+	position_attr = mock_attr(FATTR_SENSOR_PATH, SENSOR_SN, "value0");
+
+	id = dcm_add_dc(MOTOR_SN, 0);
+	CHECK(id >= 0, "dcm_add_dc() failed");
+	if (id < 0)
+		return check_summary("dcmcheck");
+
+	check_open_loop(id);
+	check_closed_loop(id);							// Runs past the wrap of the 32-bit tick count
+
+	dcm_release();
+	CHECK(strcmp(mock_get_str(command_attr), "stop") == 0, "release: command '%s'", mock_get_str(command_attr));
+	return check_summary("dcmcheck");
+}
@@ -0,0 +1,150 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file  hdgcheck.c
+ *  \brief  Heading Estimator host check.
+ *
+ *  Turns a simulated differential drive robot (56 mm wheels, 120 mm track, 5% wheel slip) with a biased, noisy gyro,
+ *  with the Heading Estimator in polled mode, and checks the gyro calibration, the turn-by-angle with HDG_TURN_STOP,
+ *  and the bias tracking while stationary. The calibration runs across the wrap of the 32-bit tick count.
+ *
+ *  Usage: hdgcheck (exits with 1 if a check fails)
+ *
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#include "ev3dev-arm-ctypes.h"
+#include <stdbool.h>
+#include <string.h>
+#include "devices.h"
+#include "heading.h"
+#include "fastattr.h"
+#include "sensormgr.h"
+#include "checks.h"
+
+#define GYRO_SN         1
+#define LEFT_SN         2
+#define RIGHT_SN        3
+#define WHEEL_MM        56
+#define TRACK_MM        120
+#define COUNT_PER_ROT   360
+#define SLIP            0.95				// Fraction of the wheel counts that turns the robot
+#define CAL_MS          2500
+#define TURN_TOLERANCE  1000				// Millidegrees
+
+static S32 gyro_attr, left_attr, right_attr, left_cmd_attr, right_cmd_attr;
+static double turn_dps, bias_dps = 1.0;
+static double left, right;
+static U32 noise;
+
+/* Mocked sensormgr.h (the gyro is always in GYRO-RATE mode) */
+
+bool snsr_set_mode(U8 sn, INX_T mode_inx) {
+	(void) sn;
+	(void) mode_inx;
+	return true;
+}
+
+static bool wheels_running(void) {
+	return (strcmp(mock_get_str(left_cmd_attr), "stop") != 0) || (strcmp(mock_get_str(right_cmd_attr), "stop") != 0);
+}
+
+static void start_turn(double dps) {
+	turn_dps = dps;
+	mock_set_str(left_cmd_attr, "run-forever");
+	mock_set_str(right_cmd_attr, "run-forever");
+}
+
+/* Set the gyro rate (degrees/s, clockwise positive, with the bias and +/-1 noise) for the robot turn rate */
+static void set_gyro(double ccw_dps) {
+	double raw = bias_dps - ccw_dps + (S32) (noise++ % 3) - 1;
+
+	mock_set_int(gyro_attr, (S32) ((raw >= 0) ? raw + 0.5 : raw - 0.5));
+}
+
+/* Run the simulated robot and the estimator for a number of milliseconds, or until the turn is done */
+static U32 simulate(U32 ms, bool until_done) {
+	U32 elapsed = 0;
+	double dps, counts;
+
+	while ((elapsed < ms) && !(until_done && hdg_turn_done())) {
+		dps = wheels_running() ? turn_dps : 0.0;
+		counts = dps * 0.001 * TRACK_MM / WHEEL_MM * SLIP;
+		left -= counts;
+		right += counts;
+		mock_set_int(left_attr, (S32) left);
+		mock_set_int(right_attr, (S32) right);
+		set_gyro(dps);
+		sim_advance(1000);
+		hdg_poll();
+		elapsed++;
+	}
+	return elapsed;
+}
+
+static bool within(S32 value, S32 expected, S32 tolerance) {
+	return (value >= expected - tolerance) && (value <= expected + tolerance);
+}
+
+static void check_turn(S32 angle, double dps) {
+	S32 start = hdg_get_heading(), expected_ms = (S32) (angle / dps);
+	S32 lead = (S32) (((dps < 0) ? -dps : dps) * HDG_TURN_LEAD_US / 1000);	// Stopped early by the motor latency
+	U32 elapsed;
+
+	start_turn(dps);
+	hdg_turn_start(angle, TURN_TOLERANCE, HDG_TURN_STOP);
+	elapsed = simulate(5000, true);
+	CHECK(hdg_turn_done(), "turn %ld: not done after %lu ms", angle, elapsed);
+	CHECK(!wheels_running(), "turn %ld: wheels not stopped", angle);
+	CHECK(within((S32) elapsed, expected_ms, 50), "turn %ld: done after %lu ms", angle, elapsed);
+	CHECK(within(hdg_get_heading() - start, angle, TURN_TOLERANCE + lead), "turn %ld: heading changed by %ld",
+		  angle, hdg_get_heading() - start);
+	simulate(500, false);
+}
+
+int main(void) {
+	U32 start;
+	S32 heading;
+
+	tick_init();
+	gyro_attr = mock_attr(FATTR_SENSOR_PATH, GYRO_SN, "value0");
+	left_attr = mock_attr(FATTR_TACHO_PATH, LEFT_SN, "position");
+	right_attr = mock_attr(FATTR_TACHO_PATH, RIGHT_SN, "position");
+	left_cmd_attr = mock_attr(FATTR_TACHO_PATH, LEFT_SN, "command");
+	right_cmd_attr = mock_attr(FATTR_TACHO_PATH, RIGHT_SN, "command");
+	mock_set_str(left_cmd_attr, "stop");
+	mock_set_str(right_cmd_attr, "stop");
+
+	CHECK(hdg_set_gyro(GYRO_SN, 0), "hdg_set_gyro() failed");
+	CHECK(hdg_set_odometry(LEFT_SN, RIGHT_SN, WHEEL_MM, TRACK_MM, COUNT_PER_ROT), "hdg_set_odometry() failed");
+
+	// The calibration ends after the wrap of the tick count
+	mock_set_int(gyro_attr, (S32) bias_dps);
+	start = sim_elapsed();
+	CHECK(hdg_calibrate(CAL_MS), "hdg_calibrate() failed");
+	CHECK(within((S32) (sim_elapsed() - start) / 1000, CAL_MS, 5), "calibration took %lu ms",
+		  (sim_elapsed() - start) / 1000);
+	CHECK(sim_elapsed() > 2 * TICKS_PER_SECOND, "calibration ended before the wrap");
+	CHECK(within(hdg_get_bias(), (S32) (-bias_dps * 1000), 100), "bias %ld", hdg_get_bias());
+
+	hdg_reset(0);
+	simulate(1000, false);
+	CHECK(within(hdg_get_heading(), 0, 100), "stationary: heading %ld after 1 s", hdg_get_heading());
+
+	check_turn(90000, 90.0);
+	check_turn(-30000, -45.0);
+
+	// The bias changes while stationary: it is tracked, and the heading does not drift
+	heading = hdg_get_heading();
+	bias_dps = 2.0;
+	simulate(10000, false);
+	CHECK(within(hdg_get_bias(), (S32) (-bias_dps * 1000), 200), "tracked bias %ld", hdg_get_bias());
+	CHECK(within(hdg_get_heading(), heading, 1000), "drift: heading %ld after 10 s, was %ld",
+		  hdg_get_heading(), heading);
+
+	return check_summary("hdgcheck");
+}
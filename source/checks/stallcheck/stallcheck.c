@@ -0,0 +1,122 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file  stallcheck.c
+ *  \brief  Motor Stall Detector host check.
+ *
+ *  Drives a simulated head motor against an end-stop, as the seeker head homing does, with the Stall Detector
+ *  in polled mode, and checks that the stall is detected within the debounce time and the motor is stopped,
+ *  including when the stall happens after the wrap of the 32-bit tick count.
+ *
+ *  Usage: stallcheck (exits with 1 if a check fails)
+ *
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#include "ev3dev-arm-ctypes.h"
+#include <stdbool.h>
+#include <string.h>
+#include "stalldet.h"
+#include "fastattr.h"
+#include "checks.h"
+
+#define HEAD_SN         1
+#define FLAG_SN         2
+#define HEAD_SPEED      100					// Simulated counts/s
+#define MIN_SPEED       30					// Counts/s
+#define DEBOUNCE_US     30000
+#define GRACE_US        20000
+#define ANCHOR_US       ((STALL_SLACK_COUNTS + 1) * TICKS_PER_SECOND / HEAD_SPEED)	// Anchor moves while running
+#define DETECT_MARGIN   (3 * STALL_PERIOD_US + (STALL_SLACK_COUNTS + 1) * TICKS_PER_SECOND / MIN_SPEED)
+
+static S32 position_attr, command_attr, state_attr;
+static double position;
+static S32 end_stop;
+
+static bool head_running(void) {
+	return strcmp(mock_get_str(command_attr), "stop") != 0;
+}
+
+/* Run the simulated head motor and the detector for a number of milliseconds, or until a stall is detected */
+static U32 simulate(S32 id, U32 ms) {
+	U32 elapsed = 0;
+
+	while ((elapsed < ms) && !stall_detected(id)) {
+		if (head_running() && (position < end_stop))
+			position += HEAD_SPEED * 0.001;
+		mock_set_int(position_attr, (S32) position);
+		sim_advance(1000);
+		stall_poll();
+		elapsed++;
+	}
+	return elapsed;
+}
+
+/* Move the head against the end-stop, and check when the stall is raised */
+static void check_homing(S32 id, S32 stop_at) {
+	U32 reach_ms = (U32) ((stop_at - position) * 1000 / HEAD_SPEED);
+	U32 elapsed, latency;
+	S32 stall_pos;
+
+	end_stop = stop_at;
+	mock_set_str(command_attr, "run-forever");
+	stall_arm(id);
+	CHECK(!stall_detected(id), "homing: stall raised when armed");
+
+	elapsed = simulate(id, reach_ms);
+	CHECK(!stall_detected(id), "homing: stall raised while moving, after %lu ms", elapsed);
+	elapsed = simulate(id, 1000);
+	CHECK(stall_detected(id), "homing: no stall 1 s after the end-stop");
+	CHECK((elapsed * 1000 >= DEBOUNCE_US - ANCHOR_US) && (elapsed * 1000 <= DEBOUNCE_US + DETECT_MARGIN),
+		  "homing: stall raised %lu ms after the end-stop", elapsed);
+	CHECK(!head_running(), "homing: command '%s'", mock_get_str(command_attr));
+	CHECK(stall_get_position(id, &stall_pos, &latency) && (stall_pos == stop_at),
+		  "homing: stall position %ld", stall_pos);
+}
+
+int main(void) {
+	S32 head, flag;
+	U32 elapsed;
+
+	tick_init();
+	position_attr = mock_attr(FATTR_TACHO_PATH, HEAD_SN, "position");
+	command_attr = mock_attr(FATTR_TACHO_PATH, HEAD_SN, "command");
+	state_attr = mock_attr(FATTR_TACHO_PATH, FLAG_SN, "state");
+
+	head = stall_add_motor(HEAD_SN, MIN_SPEED, DEBOUNCE_US, GRACE_US, STALL_STOP_MOTOR);
+	flag = stall_add_motor(FLAG_SN, MIN_SPEED, DEBOUNCE_US, 0, STALL_USE_STATE);
+	CHECK((head >= 0) && (flag >= 0), "stall_add_motor() failed");
+	if ((head < 0) || (flag < 0))
+		return check_summary("stallcheck");
+
+	check_homing(head, 50);
+
+	// Blocked from the start: raised after the grace and debounce times
+	mock_set_str(command_attr, "run-forever");
+	stall_arm(head);
+	elapsed = simulate(head, 1000);
+	CHECK((elapsed * 1000 >= GRACE_US + DEBOUNCE_US - STALL_PERIOD_US)
+		  && (elapsed * 1000 <= GRACE_US + DEBOUNCE_US + DETECT_MARGIN),
+		  "blocked: stall raised after %lu ms", elapsed);
+	stall_disarm(head);
+
+	// The tacho state flag raises the event without waiting for the debounce time
+	mock_set_str(state_attr, "running");
+	stall_arm(flag);
+	simulate(flag, 10);
+	CHECK(!stall_detected(flag), "state flag: stall raised while running");
+	mock_set_str(state_attr, "running stalled");
+	elapsed = simulate(flag, 100);
+	CHECK(elapsed * 1000 <= 2 * STALL_PERIOD_US, "state flag: stall raised after %lu ms", elapsed);
+	stall_disarm(flag);
+
+	// Long homing move, which reaches the end-stop after the wrap of the 32-bit tick count
+	CHECK(sim_elapsed() < 2 * TICKS_PER_SECOND, "homing started after the wrap");
+	check_homing(head, (S32) position + HEAD_SPEED * 2);
+
+	return check_summary("stallcheck");
+}
@@ -0,0 +1,111 @@
+/*
+     ____ __     ____   ___    ____ __         (((((()
+    | |_  \ \  /   ) ) | |  ) | |_  \ \  /  \(@)- /
+    |_|__  \_\/  __)_) |_|_/  |_|__  \_\/   /(@)- \
+                                               ((())))
+ *//**
+ *  \file  planner.c
+ *  \brief  Example external planner process for the Planner Bridge.
+ *
+ *  Connects to the bridge created by a robot program (e.g., seeker with USE_BRIDGE),
+ *  prints the robot state snapshot once per second, and sends commands through the mailbox.
+ *  The robot heartbeat is watched: if the robot stops publishing, the planner waits for it
+ *  to create the bridge again (e.g., after a restart) and reconnects.
+ *
+ *  Usage: planner [-b bridge_name] [-t period_ms] [-v speed] [-s seconds]
+ *     -v  send a BRG_CMD_VELOCITY command (both motors at speed) every period
+ *     -s  send BRG_CMD_STOP after the given number of seconds, then exit
+ *
+ *  \author  See AUTHORS for a full list of the developers
+ *  \copyright  See the LICENSE file.
+ */
+
+#include "ev3dev-arm-ctypes.h"
+#include "bridge.h"
+#include "systick.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define DEFAULT_PERIOD_MS	50
+#define ROBOT_STALE_MS		500
+#define RECONNECT_MS		500
+#define REPORT_TICKS		TICKS_PER_SECOND
+
+static void print_state(const BRG_STATE *state)
+{
+	U32 i;
+
+	printf("planner: systick %u state %u sensors", state->systick, state->robot_state);
+	for (i = 0; (i < state->num_sensors) && (i < BRG_MAX_SENSORS); i++)
+		printf(" %d", state->sensor[i]);
+	printf(" tachos");
+	for (i = 0; (i < state->num_tachos) && (i < BRG_MAX_TACHOS); i++)
+		printf(" %d@%d", state->tacho_pos[i], state->tacho_speed[i]);
+	printf("\n");
+}
+
+int main(int argc, char *argv[])
+{
+	const char *name = NULL;
+	U32 period_ms = DEFAULT_PERIOD_MS;
+	U32 stop_after = 0;
+	S32 args[BRG_CMD_ARGS] = { 0 };
+	bool send_velocity = FALSE;
+	bool connected = FALSE;
+	BRG_STATE state;
+	U32 start = 0, now, last_report, dropped = 0;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "b:t:v:s:")) != -1) {
+		switch (opt) {
+		case 'b': name = optarg; break;
+		case 't': period_ms = strtoul(optarg, NULL, 0); break;
+		case 'v': send_velocity = TRUE; args[0] = args[1] = strtol(optarg, NULL, 0); break;
+		case 's': stop_after = strtoul(optarg, NULL, 0); break;
+		default:
+			fprintf(stderr, "usage: %s [-b bridge_name] [-t period_ms] [-v speed] [-s seconds]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (period_ms == 0)
+		return 1;
+
+	tick_init();
+	last_report = tick_systick();
+	for (;;) {
+		now = tick_systick();
+		if (!connected) {
+			if (!brg_client_open(name)) {
+				usleep(RECONNECT_MS * 1000);		// Robot program not running (yet)
+				continue;
+			}
+			printf("planner: connected to %s\n", name ? name : BRG_DEFAULT_NAME);
+			connected = TRUE;
+			start = now;
+		}
+		if (!brg_client_robot_alive(ROBOT_STALE_MS) && ((now - start) >= ROBOT_STALE_MS * 1000)) {
+			printf("planner: robot stale, reconnecting\n");
+			brg_client_close();						// The robot may have restarted with a new bridge
+			connected = FALSE;
+			continue;
+		}
+
+		brg_client_heartbeat();
+		if (brg_client_read_state(&state) && ((now - last_report) >= REPORT_TICKS)) {
+			print_state(&state);
+			last_report = now;
+		}
+		if (send_velocity && !brg_client_send(BRG_CMD_VELOCITY, args))
+			dropped++;								// Mailbox full, the robot is not taking commands
+		if (stop_after && ((now - start) >= stop_after * TICKS_PER_SECOND)) {
+			brg_client_send(BRG_CMD_STOP, NULL);
+			break;
+		}
+		usleep(period_ms * 1000);
+	}
+
+	printf("planner: %lu commands dropped\n", dropped);
+	brg_client_close();
+	return 0;
+}